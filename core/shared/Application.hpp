@@ -2,14 +2,19 @@
 #define APPLICATION_HPP_DEFINED
 
 #include "BoundingBox.hpp"
+#include "CancellationToken.hpp"
 #include "QuadKey.hpp"
 #include "LodRange.hpp"
 #include "builders/BuilderContext.hpp"
 #include "builders/ExternalBuilder.hpp"
 #include "builders/QuadKeyBuilder.hpp"
+#include "builders/QuadKeyCache.hpp"
+#include "builders/QuadKeyPredictor.hpp"
+#include "builders/QuadKeyBuildQueue.hpp"
 #include "builders/buildings/BuildingBuilder.hpp"
 #include "builders/misc/BarrierBuilder.hpp"
 #include "builders/poi/TreeBuilder.hpp"
+#include "builders/terrain/FlatTerraBuilder.hpp"
 #include "builders/terrain/TerraBuilder.hpp"
 #include "heightmap/FlatElevationProvider.hpp"
 #include "heightmap/SrtmElevationProvider.hpp"
@@ -18,17 +23,27 @@
 #include "index/PersistentElementStore.hpp"
 #include "mapcss/MapCssParser.hpp"
 #include "mapcss/StyleSheet.hpp"
+#include "mapcss/StyleSheetCompiler.hpp"
+#include "mapcss/StyleSheetDiff.hpp"
 #include "meshing/MeshTypes.hpp"
 #include "utils/GeoUtils.hpp"
 
 #include "Callbacks.hpp"
 #include "ExportElementVisitor.hpp"
+#include "QuadKeyRecord.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <exception>
 #include <fstream>
+#include <functional>
+#include <limits>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 
@@ -36,6 +51,19 @@
 class Application
 {
     const int SrtmElevationLodStart = 42; // NOTE: disable for initial MVP
+    const std::string CompiledStyleExtension = ".bin";
+    // NOTE reported when build task throws not std::exception.
+    const char* const UnknownErrorMessage = "Unknown error";
+    const std::size_t MeshCacheMemoryCapacity = 64 * 1024 * 1024;
+    // NOTE should be changed when builders produce different output for the same input.
+    const int MeshCacheVersion = 1;
+    // NOTE prefetched quadkeys are built after any requested one.
+    const int PrefetchPriority = std::numeric_limits<int>::max() / 2;
+    // NOTE placeholders are built before any detailed output.
+    const int PlaceholderPriority = std::numeric_limits<int>::min();
+    // Generations of progressive loading output.
+    const int PlaceholderGeneration = 0;
+    const int DetailedGeneration = 1;
 
 public:
 
@@ -44,7 +72,8 @@ public:
                 const char* elePath, 
                 OnError* errorCallback) :
         stringTable_(stringPath), geoStore_(stringTable_), srtmEleProvider_(elePath),
-        flatEleProvider_(), quadKeyBuilder_(geoStore_, stringTable_)
+        flatEleProvider_(), quadKeyBuilder_(geoStore_, stringTable_), placeholderBuilder_(geoStore_, stringTable_), dataPath_(stringPath), elePath_(elePath),
+        meshCache_(std::make_shared<utymap::builders::QuadKeyCache>("", MeshCacheMemoryCapacity)), buildQueue_()
     {
         registerDefaultBuilders();
     }
@@ -55,19 +84,49 @@ public:
         getStyleProvider(path);
     }
 
+    // Reloads stylesheet and reports element types and levels of details which styles
+    // are changed, so only tiles which output can change should be rebuilt. Not thread safe.
+    void reloadStylesheet(const char* path, OnStyleChanged* styleChangedCallback, OnError* errorCallback)
+    {
+        safeExecute([&]() {
+            std::string filePath = path;
+            auto pair = styleSheets_.find(filePath);
+            if (pair == styleSheets_.end()) {
+                getStyleProvider(filePath);
+                return;
+            }
+
+            // NOTE new stylesheet is compiled before old one is replaced, so
+            // old provider is still in use if new one cannot be parsed.
+            std::uint64_t hash;
+            utymap::mapcss::CompiledStyleSheet compiled = compileStyleSheet(filePath, hash);
+            auto diff = utymap::mapcss::StyleSheetDiff::compare(pair->second, compiled.stylesheet);
+            setStyleProvider(filePath, std::move(compiled), hash);
+
+            for (const auto& affected : diff.affected) {
+                for (int lod = 0; lod <= utymap::mapcss::StyleSheetDiff::MaxLevelOfDetails; ++lod) {
+                    if (diff.isAffected(affected.first, lod))
+                        styleChangedCallback(affected.first.c_str(), lod);
+                }
+            }
+        }, errorCallback);
+    }
+
     void registerInMemoryStore(const char* key)
     {
         geoStore_.registerStore(key,
             std::make_shared<utymap::index::InMemoryElementStore>(stringTable_));
     }
 
-    void registerPersistentStore(const char* key, const char* dataPath)
+    // Registers persistent store. If sort buffer size is positive, data is imported using
+    // external sort and is visible only after import is finished.
+    void registerPersistentStore(const char* key, const char* dataPath, std::size_t sortBufferSize = 0)
     {
         geoStore_.registerStore(key,
-            std::make_shared<utymap::index::PersistentElementStore>(dataPath, stringTable_));
+            std::make_shared<utymap::index::PersistentElementStore>(dataPath, stringTable_, sortBufferSize));
     }
 
-    // Preload elevation data. Not thread safe.
+    // Preload elevation data. Can be called while quadkeys are being loaded.
     void preloadElevation(const utymap::QuadKey& quadKey)
     {
         getElevationProvider(quadKey).preload(utymap::utils::GeoUtils::quadKeyToBoundingBox(quadKey));
@@ -127,7 +186,7 @@ public:
         return geoStore_.hasData(quadKey);
     }
 
-    // Loads quadKey.
+    // Loads quadKey. Output is restored from cache if quadkey is already built.
     void loadQuadKey(const char* styleFile, 
                      const utymap::QuadKey& quadKey, 
                      OnMeshBuilt* meshCallback,
@@ -135,23 +194,241 @@ public:
                      OnError* errorCallback)
     {
         safeExecute([&]() {
+            cancelPrefetch();
+            auto styleProvider = getStyleProvider(styleFile);
+            QuadKeyRecord record;
+            loadRecord(quadKey, *styleProvider, getQuadKeyHash(quadKey, styleFile), *meshCache_, record);
+            record.replay(meshCallback, elementCallback);
+        }, errorCallback);
+    }
+
+    // Loads quadKey like loadQuadKey does, but delivers meshes in compact format.
+    void loadQuadKeyCompact(const char* styleFile,
+                            const utymap::QuadKey& quadKey,
+                            OnCompactMeshBuilt* meshCallback,
+                            OnElementLoaded* elementCallback,
+                            OnError* errorCallback)
+    {
+        safeExecute([&]() {
+            cancelPrefetch();
+            auto styleProvider = getStyleProvider(styleFile);
+            QuadKeyRecord record;
+            loadRecord(quadKey, *styleProvider, getQuadKeyHash(quadKey, styleFile), *meshCache_, record);
+            record.replayCompact(getOrigin(quadKey), meshCallback, elementCallback);
+        }, errorCallback);
+    }
+
+    // Loads quadKeys on worker threads: quadkeys with smaller priority value, e.g. distance
+    // to camera, are built first. Output of quadkey is delivered at once when it is built and
+    // followed by loaded callback. Callbacks are called on worker threads, but never concurrently.
+    // Nothing is delivered for cancelled quadkeys.
+    // NOTE elevation can be preloaded while quadkeys are being loaded, e.g. by prefetching on
+    // worker thread: elevation is read without locking and preloads are serialized.
+    void loadQuadKeysAsync(const char* styleFile,
+                           const std::vector<utymap::QuadKey>& quadKeys,
+                           const std::vector<int>& priorities,
+                           OnMeshBuilt* meshCallback,
+                           OnElementLoaded* elementCallback,
+                           OnQuadKeyLoaded* loadedCallback,
+                           OnError* errorCallback)
+    {
+        loadQuadKeysAsync(styleFile, quadKeys, priorities,
+            [=](const utymap::QuadKey&, const QuadKeyRecord& record) {
+                record.replay(meshCallback, elementCallback);
+            }, loadedCallback, errorCallback);
+    }
+
+    // Loads quadKeys like loadQuadKeysAsync does, but delivers meshes in compact format.
+    void loadQuadKeysCompactAsync(const char* styleFile,
+                                  const std::vector<utymap::QuadKey>& quadKeys,
+                                  const std::vector<int>& priorities,
+                                  OnCompactMeshBuilt* meshCallback,
+                                  OnElementLoaded* elementCallback,
+                                  OnQuadKeyLoaded* loadedCallback,
+                                  OnError* errorCallback)
+    {
+        loadQuadKeysAsync(styleFile, quadKeys, priorities,
+            [=](const utymap::QuadKey& quadKey, const QuadKeyRecord& record) {
+                record.replayCompact(getOrigin(quadKey), meshCallback, elementCallback);
+            }, loadedCallback, errorCallback);
+    }
+
+    // Loads quadKeys on worker threads like loadQuadKeysAsync, but delivers output in generations.
+    // At first, placeholder of each quadkey which is not cached: flat terrain and buildings without
+    // roofs. Then detailed output with elements which replaces placeholder. Placeholders are built
+    // before any detailed output. Each delivered generation is followed by generation loaded callback.
+    void loadQuadKeysProgressive(const char* styleFile,
+                                 const std::vector<utymap::QuadKey>& quadKeys,
+                                 const std::vector<int>& priorities,
+                                 OnMeshGenerationBuilt* meshCallback,
+                                 OnElementLoaded* elementCallback,
+                                 OnGenerationLoaded* loadedCallback,
+                                 OnError* errorCallback)
+    {
+        safeExecute([&]() {
+            cancelPrefetch();
             auto styleProvider = getStyleProvider(styleFile);
-            ExportElementVisitor elementVisitor(stringTable_, *styleProvider, quadKey.levelOfDetail, elementCallback);
-            quadKeyBuilder_.build(quadKey, *styleProvider, getElevationProvider(quadKey),
-                [&meshCallback](const utymap::meshing::Mesh& mesh) {
-                // NOTE do not notify if mesh is empty.
-                if (!mesh.vertices.empty()) {
-                    meshCallback(mesh.name.data(),
-                        mesh.vertices.data(), static_cast<int>(mesh.vertices.size()),
-                        mesh.triangles.data(), static_cast<int>(mesh.triangles.size()),
-                        mesh.colors.data(), static_cast<int>(mesh.colors.size()));
+            auto meshCache = meshCache_;
+            std::vector<utymap::builders::QuadKeyBuildQueue::Task> placeholderTasks;
+            for (std::size_t i = 0; i < quadKeys.size(); ++i) {
+                auto hash = getQuadKeyHash(quadKeys[i], styleFile);
+                auto cancelToken = std::make_shared<utymap::CancellationToken>();
+                {
+                    std::lock_guard<std::mutex> lock(loadingLock_);
+                    loading_.push_back(std::make_pair(quadKeys[i], cancelToken));
                 }
-            }, [&elementVisitor](const utymap::entities::Element& element) {
-                element.accept(elementVisitor);
-            });
+
+                // NOTE detailed output can be built faster than placeholder, so the latest
+                // delivered generation is kept. It is guarded by delivery lock.
+                auto lastGeneration = std::make_shared<int>(-1);
+                auto deliver = [=](const utymap::QuadKey& quadKey, int generation,
+                                   const QuadKeyRecord& record, const std::string& error) {
+                    std::lock_guard<std::mutex> lock(deliveryLock_);
+                    if (cancelToken->isCancelled() || *lastGeneration >= generation)
+                        return;
+                    *lastGeneration = generation;
+
+                    if (error.empty())
+                        record.replay([&](const char* name, const double* vertices, int vertexSize,
+                                          const int* triangles, int triSize, const int* colors, int colorSize) {
+                            meshCallback(quadKey.tileX, quadKey.tileY, quadKey.levelOfDetail, generation,
+                                name, vertices, vertexSize, triangles, triSize, colors, colorSize);
+                        }, elementCallback);
+                    else
+                        errorCallback(error.c_str());
+                    loadedCallback(quadKey.tileX, quadKey.tileY, quadKey.levelOfDetail, generation);
+                };
+
+                placeholderTasks.push_back([=](const utymap::QuadKey& quadKey) {
+                    std::string data;
+                    // NOTE cached output is restored quickly, so placeholder is not needed.
+                    if (cancelToken->isCancelled() || meshCache->get(quadKey, hash, data))
+                        return;
+
+                    QuadKeyRecord record;
+                    try {
+                        placeholderBuilder_.build(quadKey, *styleProvider, getElevationProvider(quadKey),
+                            [&record](const utymap::meshing::Mesh& mesh) { record.addMesh(mesh); },
+                            [](const utymap::entities::Element&) {}, *cancelToken);
+                    }
+                    catch (...) {
+                        // NOTE error is reported by detailed build.
+                        return;
+                    }
+                    deliver(quadKey, PlaceholderGeneration, record, "");
+                });
+
+                buildQueue_.enqueue(quadKeys[i], priorities[i], [=](const utymap::QuadKey& quadKey) {
+                    QuadKeyRecord record;
+                    std::string error;
+                    if (!cancelToken->isCancelled()) {
+                        try {
+                            loadRecord(quadKey, *styleProvider, hash, *meshCache, record, *cancelToken);
+                        }
+                        catch (std::exception& ex) {
+                            error = ex.what();
+                        }
+                        catch (...) {
+                            error = UnknownErrorMessage;
+                        }
+                    }
+
+                    finishLoading(cancelToken);
+                    deliver(quadKey, DetailedGeneration, record, error);
+                });
+            }
+
+            // NOTE placeholder of quadkey with smaller priority is built first.
+            std::vector<std::size_t> order(quadKeys.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(),
+                [&](std::size_t lhs, std::size_t rhs) { return priorities[lhs] < priorities[rhs]; });
+            for (std::size_t i : order)
+                buildQueue_.enqueue(quadKeys[i], PlaceholderPriority, placeholderTasks[i]);
         }, errorCallback);
     }
 
+    // Speculatively builds up to budget quadkeys which are likely to be visited next
+    // and puts them to mesh cache together with their elevation data. Prefetching runs
+    // only when there are no pending requests and is cancelled by next request or hint.
+    // Speed is given in degrees per second.
+    void prefetchQuadKeys(const char* styleFile,
+                          const utymap::GeoCoordinate& position,
+                          double latitudeSpeed,
+                          double longitudeSpeed,
+                          int levelOfDetail,
+                          std::size_t budget,
+                          OnError* errorCallback)
+    {
+        safeExecute([&]() {
+            cancelPrefetch();
+            auto styleProvider = getStyleProvider(styleFile);
+            auto meshCache = meshCache_;
+            auto quadKeys = utymap::builders::QuadKeyPredictor::predict(position,
+                latitudeSpeed, longitudeSpeed, levelOfDetail, budget);
+
+            for (std::size_t i = 0; i < quadKeys.size(); ++i) {
+                auto hash = getQuadKeyHash(quadKeys[i], styleFile);
+                auto cancelToken = std::make_shared<utymap::CancellationToken>();
+                {
+                    std::lock_guard<std::mutex> lock(loadingLock_);
+                    prefetching_.push_back(cancelToken);
+                }
+                int priority = PrefetchPriority + static_cast<int>(i);
+                buildQueue_.enqueue(quadKeys[i], priority, [=](const utymap::QuadKey& quadKey) {
+                    if (cancelToken->isCancelled())
+                        return;
+
+                    QuadKeyRecord record;
+                    try {
+                        getElevationProvider(quadKey).preload(utymap::utils::GeoUtils::quadKeyToBoundingBox(quadKey));
+                        loadRecord(quadKey, *styleProvider, hash, *meshCache, record, *cancelToken);
+                    }
+                    catch (...) {
+                        // NOTE error is reported when quadkey is really requested.
+                    }
+                });
+            }
+        }, errorCallback);
+    }
+
+    // Cancels asynchronous loading of quadkey if it is not yet delivered.
+    void cancelQuadKey(const utymap::QuadKey& quadKey)
+    {
+        std::lock_guard<std::mutex> lock(loadingLock_);
+        for (const auto& pair : loading_) {
+            if (pair.first == quadKey)
+                pair.second->cancel();
+        }
+    }
+
+    // Replaces mesh cache. Disk tier is used if data path is not empty and is not limited
+    // if disk capacity is zero. Should not be called while quadkeys are being loaded.
+    void configureMeshCache(const char* dataPath, std::size_t memoryCapacity, std::size_t diskCapacity = 0)
+    {
+        meshCache_ = std::make_shared<utymap::builders::QuadKeyCache>(dataPath, memoryCapacity, diskCapacity);
+    }
+
+    // Gets hash of everything quadkey output depends on: stylesheet, data in stores and elevation.
+    std::uint64_t getQuadKeyHash(const utymap::QuadKey& quadKey, const std::string& styleFile)
+    {
+        std::ostringstream stream;
+        stream << MeshCacheVersion << ";" << styleHashes_[styleFile] << ";" << geoStore_.getRevision(quadKey) << ";"
+               << (quadKey.levelOfDetail <= SrtmElevationLodStart ? "flat" : "srtm:" + elePath_);
+        return utymap::builders::QuadKeyCache::hash(stream.str());
+    }
+
+    // Gets path of compiled stylesheet inside data directory. Full path of mapcss file
+    // is hashed as different directories may have mapcss files with the same name.
+    // NOTE hash should be stable between builds as file is reused by next sessions.
+    std::string getCompiledStylePath(const std::string& filePath) const
+    {
+        std::stringstream stream;
+        stream << dataPath_ << filePath.substr(filePath.find_last_of("\\/") + 1) << "."
+               << std::hex << utymap::builders::QuadKeyCache::hash(filePath) << CompiledStyleExtension;
+        return stream.str();
+    }
+
     // Gets id for the string.
     inline std::uint32_t getStringId(const char* str)
     {
@@ -171,6 +448,131 @@ private:
         }
     }
 
+    // Delivers output of quadkey in specific format.
+    typedef std::function<void(const utymap::QuadKey&, const QuadKeyRecord&)> RecordCallback;
+
+    // Loads quadKeys on worker threads. See public overload.
+    void loadQuadKeysAsync(const char* styleFile,
+                           const std::vector<utymap::QuadKey>& quadKeys,
+                           const std::vector<int>& priorities,
+                           const RecordCallback& recordCallback,
+                           OnQuadKeyLoaded* loadedCallback,
+                           OnError* errorCallback)
+    {
+        safeExecute([&]() {
+            cancelPrefetch();
+            // NOTE style provider and cache are resolved on caller thread and kept alive by tasks.
+            auto styleProvider = getStyleProvider(styleFile);
+            auto meshCache = meshCache_;
+            for (std::size_t i = 0; i < quadKeys.size(); ++i) {
+                auto hash = getQuadKeyHash(quadKeys[i], styleFile);
+                auto cancelToken = std::make_shared<utymap::CancellationToken>();
+                {
+                    std::lock_guard<std::mutex> lock(loadingLock_);
+                    loading_.push_back(std::make_pair(quadKeys[i], cancelToken));
+                }
+                buildQueue_.enqueue(quadKeys[i], priorities[i], [=](const utymap::QuadKey& quadKey) {
+                    if (cancelToken->isCancelled()) {
+                        finishLoading(cancelToken);
+                        return;
+                    }
+
+                    QuadKeyRecord record;
+                    std::string error;
+                    try {
+                        loadRecord(quadKey, *styleProvider, hash, *meshCache, record, *cancelToken);
+                    }
+                    catch (std::exception& ex) {
+                        error = ex.what();
+                    }
+                    catch (...) {
+                        error = UnknownErrorMessage;
+                    }
+
+                    finishLoading(cancelToken);
+                    if (cancelToken->isCancelled())
+                        return;
+
+                    std::lock_guard<std::mutex> lock(deliveryLock_);
+                    if (error.empty())
+                        recordCallback(quadKey, record);
+                    else
+                        errorCallback(error.c_str());
+                    loadedCallback(quadKey.tileX, quadKey.tileY, quadKey.levelOfDetail);
+                });
+            }
+        }, errorCallback);
+    }
+
+    // Builds quadkey. Thread safe if style provider is already created.
+    void buildQuadKey(const utymap::QuadKey& quadKey,
+                      utymap::mapcss::StyleProvider& styleProvider,
+                      const utymap::builders::QuadKeyBuilder::MeshCallback& meshFunc,
+                      const std::function<OnElementLoaded>& elementCallback,
+                      const utymap::CancellationToken& cancelToken = utymap::CancellationToken::none())
+    {
+        ExportElementVisitor elementVisitor(stringTable_, styleProvider, quadKey.levelOfDetail, elementCallback);
+        quadKeyBuilder_.build(quadKey, styleProvider, getElevationProvider(quadKey), meshFunc,
+            [&elementVisitor](const utymap::entities::Element& element) {
+                element.accept(elementVisitor);
+            }, cancelToken);
+    }
+
+    // Restores quadkey output from cache or builds it and puts to cache.
+    // NOTE output of cancelled build is not cached.
+    void loadRecord(const utymap::QuadKey& quadKey,
+                    utymap::mapcss::StyleProvider& styleProvider,
+                    std::uint64_t hash,
+                    utymap::builders::QuadKeyCache& meshCache,
+                    QuadKeyRecord& record,
+                    const utymap::CancellationToken& cancelToken = utymap::CancellationToken::none())
+    {
+        std::string data;
+        if (meshCache.get(quadKey, hash, data)) {
+            std::istringstream stream(data);
+            if (record.read(stream))
+                return;
+            record = QuadKeyRecord();
+        }
+
+        buildQuadKey(quadKey, styleProvider,
+            [&record](const utymap::meshing::Mesh& mesh) { record.addMesh(mesh); },
+            [&record](std::uint64_t id, const char** tags, int tagsSize,
+                      const double* vertices, int vertexSize, const char** style, int styleSize) {
+                record.addElement(id, tags, tagsSize, vertices, vertexSize, style, styleSize);
+            }, cancelToken);
+
+        if (cancelToken.isCancelled())
+            return;
+
+        std::ostringstream stream;
+        record.write(stream);
+        meshCache.put(quadKey, hash, stream.str());
+    }
+
+    // Gets origin of compact mesh vertices.
+    static utymap::GeoCoordinate getOrigin(const utymap::QuadKey& quadKey)
+    {
+        return utymap::utils::GeoUtils::quadKeyToBoundingBox(quadKey).minPoint;
+    }
+
+    // Cancels all prefetching: it should not delay real requests.
+    void cancelPrefetch()
+    {
+        std::lock_guard<std::mutex> lock(loadingLock_);
+        for (const auto& cancelToken : prefetching_)
+            cancelToken->cancel();
+        prefetching_.clear();
+    }
+
+    // Forgets asynchronous loading which uses given token.
+    void finishLoading(const std::shared_ptr<utymap::CancellationToken>& cancelToken)
+    {
+        std::lock_guard<std::mutex> lock(loadingLock_);
+        loading_.erase(std::remove_if(loading_.begin(), loading_.end(),
+            [&](const LoadingQuadKey& pair) { return pair.second == cancelToken; }), loading_.end());
+    }
+
     utymap::heightmap::ElevationProvider& getElevationProvider(const utymap::QuadKey& quadKey)
     {
         return quadKey.levelOfDetail <= SrtmElevationLodStart
@@ -184,16 +586,48 @@ private:
         if (pair != styleProviders_.end())
             return pair->second;
 
+        std::uint64_t hash;
+        utymap::mapcss::CompiledStyleSheet compiled = compileStyleSheet(filePath, hash);
+        return setStyleProvider(filePath, std::move(compiled), hash);
+    }
+
+    // Reads compiled stylesheet or compiles it from mapcss file.
+    utymap::mapcss::CompiledStyleSheet compileStyleSheet(const std::string& filePath, std::uint64_t& hash) const
+    {
         std::ifstream styleFile(filePath);
         if (!styleFile.good())
             throw std::invalid_argument(std::string("Cannot read mapcss file:") + filePath);
 
         // NOTE not safe, but don't want to use boost filesystem only for this task.
         std::string dir = filePath.substr(0, filePath.find_last_of("\\/") + 1);
-        utymap::mapcss::MapCssParser parser(dir);
-        utymap::mapcss::StyleSheet stylesheet = parser.parse(styleFile);
-        styleProviders_[filePath] = std::make_shared<utymap::mapcss::StyleProvider>(stylesheet, stringTable_);
-        return styleProviders_[filePath];
+
+        // NOTE compiled stylesheet is stored in data directory and rebuilt when
+        // content of mapcss file or its imports is changed.
+        using utymap::mapcss::StyleSheetCompiler;
+        hash = StyleSheetCompiler::hash(filePath, dir);
+        std::string compiledPath = getCompiledStylePath(filePath);
+        utymap::mapcss::CompiledStyleSheet compiled;
+        std::ifstream compiledFile(compiledPath, std::ios::binary);
+        if (!compiledFile.good() || !StyleSheetCompiler::read(compiledFile, hash, compiled)) {
+            utymap::mapcss::MapCssParser parser(dir);
+            compiled = StyleSheetCompiler::compile(parser.parse(styleFile));
+            std::ofstream output(compiledPath, std::ios::binary | std::ios::trunc);
+            if (output.good())
+                StyleSheetCompiler::write(output, compiled, hash);
+        }
+        return compiled;
+    }
+
+    // Creates style provider for compiled stylesheet and replaces existing one.
+    std::shared_ptr<utymap::mapcss::StyleProvider> setStyleProvider(const std::string& filePath,
+                                                                    utymap::mapcss::CompiledStyleSheet&& compiled,
+                                                                    std::uint64_t hash)
+    {
+        auto styleProvider = std::make_shared<utymap::mapcss::StyleProvider>(compiled, stringTable_);
+        styleProviders_[filePath] = styleProvider;
+        styleSheets_[filePath] = std::move(compiled.stylesheet);
+        styleHashes_[filePath] = hash;
+        return styleProvider;
     }
 
     void registerDefaultBuilders()
@@ -213,6 +647,15 @@ private:
         quadKeyBuilder_.registerElementBuilder("barrier", [&](const utymap::builders::BuilderContext& context) {
             return std::make_shared<utymap::builders::BarrierBuilder>(context);
         });
+
+        // NOTE other builders are handled by external one, so they produce nothing for placeholder.
+        placeholderBuilder_.registerElementBuilder("terrain", [&](const utymap::builders::BuilderContext& context) {
+            return std::make_shared<utymap::builders::FlatTerraBuilder>(context);
+        });
+
+        placeholderBuilder_.registerElementBuilder("building", [&](const utymap::builders::BuilderContext& context) {
+            return std::make_shared<utymap::builders::BuildingBuilder>(context, true);
+        });
     }
 
     utymap::index::StringTable stringTable_;
@@ -221,7 +664,23 @@ private:
     utymap::heightmap::SrtmElevationProvider srtmEleProvider_;
 
     utymap::builders::QuadKeyBuilder quadKeyBuilder_;
+    utymap::builders::QuadKeyBuilder placeholderBuilder_;
     std::unordered_map<std::string, std::shared_ptr<utymap::mapcss::StyleProvider>> styleProviders_;
+    // NOTE stylesheets are kept to find changes on reload.
+    std::unordered_map<std::string, utymap::mapcss::StyleSheet> styleSheets_;
+    std::unordered_map<std::string, std::uint64_t> styleHashes_;
+    const std::string dataPath_;
+    const std::string elePath_;
+    std::shared_ptr<utymap::builders::QuadKeyCache> meshCache_;
+
+    // NOTE only few quadkeys are loaded at once, so linear search is fine.
+    typedef std::pair<utymap::QuadKey, std::shared_ptr<utymap::CancellationToken>> LoadingQuadKey;
+    std::vector<LoadingQuadKey> loading_;
+    std::vector<std::shared_ptr<utymap::CancellationToken>> prefetching_;
+    std::mutex loadingLock_;
+    std::mutex deliveryLock_;
+    // NOTE should be destroyed first as running tasks use other members.
+    utymap::builders::QuadKeyBuildQueue buildQueue_;
 };
 
 #endif // APPLICATION_HPP_DEFINED
@@ -9,11 +9,37 @@ typedef void OnMeshBuilt(const char* name,
                          const int* triangles, int triSize,
                          const int* colors, int colorSize);
 
+// Called when mesh is built in compact mode. Vertices are longitude, latitude and elevation
+// triples where longitude and latitude are relative to south west corner of quadkey. Triangle
+// indices are 16 bit if index size is 2, otherwise 32 bit. Each color is RGBA8: four bytes
+// in r, g, b, a order, color size is amount of colors.
+typedef void OnCompactMeshBuilt(const char* name,
+                                const float* vertices, int vertexSize,
+                                const void* triangles, int triSize, int indexSize,
+                                const std::uint8_t* colors, int colorSize);
+
 // Called when element is loaded.
 typedef void OnElementLoaded(std::uint64_t id, const char** tags, int tagsSize,
                              const double* vertices, int vertexSize,
                              const char** style, int styleSize);
 
+// Called when all meshes and elements of quadkey are delivered by asynchronous loading.
+typedef void OnQuadKeyLoaded(int tileX, int tileY, int levelOfDetail);
+
+// Called when mesh of quadkey is built by progressive loading. Meshes of newer generation
+// replace all meshes of older one.
+typedef void OnMeshGenerationBuilt(int tileX, int tileY, int levelOfDetail, int generation,
+                                   const char* name,
+                                   const double* vertices, int vertexSize,
+                                   const int* triangles, int triSize,
+                                   const int* colors, int colorSize);
+
+// Called when all meshes of quadkey generation are delivered by progressive loading.
+typedef void OnGenerationLoaded(int tileX, int tileY, int levelOfDetail, int generation);
+
+// Called for each element type and level of details which styles are changed by stylesheet reload.
+typedef void OnStyleChanged(const char* elementType, int levelOfDetail);
+
 // Called when operation is completed.
 typedef void OnError(const char* errorMessage);
 
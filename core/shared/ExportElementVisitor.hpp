@@ -12,6 +12,7 @@
 #include "entities/Relation.hpp"
 #include "mapcss/StyleProvider.hpp"
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -24,7 +25,7 @@ struct ExportElementVisitor : public utymap::entities::ElementVisitor
     ExportElementVisitor(utymap::index::StringTable& stringTable,
                         utymap::mapcss::StyleProvider& styleProvider,
                         int levelOfDetail,
-                        OnElementLoaded* elementCallback) :
+                        const std::function<OnElementLoaded>& elementCallback) :
     stringTable_(stringTable), styleProvider_(styleProvider), levelOfDetail_(levelOfDetail), elementCallback_(elementCallback)
     {
     }
@@ -74,9 +75,9 @@ private:
         // convert style
         utymap::mapcss::Style style = styleProvider_.forElement(element, levelOfDetail_);
         std::vector<const char*> cstyles;
-        styleStrings_.reserve(style.declarations.size() * 2);
-        cstyles.reserve(style.declarations.size());
-        for (const auto pair : style.declarations) {
+        styleStrings_.reserve(style.declarations().size() * 2);
+        cstyles.reserve(style.declarations().size());
+        for (const auto& pair : style.declarations()) {
             styleStrings_.push_back(stringTable_.getString(pair.first));
             styleStrings_.push_back(*pair.second->value());
             cstyles.push_back(styleStrings_[styleStrings_.size() - 2].c_str());
@@ -95,7 +96,7 @@ private:
     utymap::index::StringTable& stringTable_;
     utymap::mapcss::StyleProvider& styleProvider_;
     int levelOfDetail_;
-    OnElementLoaded* elementCallback_;
+    std::function<OnElementLoaded> elementCallback_;
     std::vector<std::string> tagStrings_;   // holds temporary tag strings
     std::vector<std::string> styleStrings_; // holds temporary style strings
 };
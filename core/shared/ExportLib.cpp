@@ -10,6 +10,28 @@
 
 static Application* applicationPtr = nullptr;
 
+namespace {
+    // Converts size passed through C ABI: negative values are clamped to zero.
+    std::size_t toSize(int value)
+    {
+        return value > 0 ? static_cast<std::size_t>(value) : 0;
+    }
+
+    // Converts tile x, tile y and level of detail triples to quadkeys. Reports error if count is negative.
+    bool toQuadKeys(const int* quadKeys, int count, std::vector<utymap::QuadKey>& result, OnError* errorCallback)
+    {
+        if (count < 0) {
+            errorCallback("Negative amount of quadkeys.");
+            return false;
+        }
+
+        result.reserve(count);
+        for (int i = 0; i < count; ++i)
+            result.push_back(utymap::QuadKey(quadKeys[i * 3 + 2], quadKeys[i * 3], quadKeys[i * 3 + 1]));
+        return true;
+    }
+}
+
 extern "C"
 {
     // Composes object graph.
@@ -26,12 +48,28 @@ extern "C"
         delete applicationPtr;
     }
 
+    // Configures cache of built quadkeys. Disk tier is disabled if data path is empty.
+    void EXPORT_API configureMeshCache(const char* dataPath, // path to cache directory
+                                       int memoryCapacity,   // max size of data kept in memory in bytes
+                                       int diskCapacity)     // max size of data kept on disk in bytes, zero disables limit
+    {
+        applicationPtr->configureMeshCache(dataPath, toSize(memoryCapacity), toSize(diskCapacity));
+    }
+
     // Register stylesheet.
     void EXPORT_API registerStylesheet(const char* path)
     {
         applicationPtr->registerStylesheet(path);
     }
 
+    // Reloads stylesheet and reports element types and levels of details affected by changes.
+    void EXPORT_API reloadStylesheet(const char* path,                  // path to stylesheet
+                                     OnStyleChanged* styleChangedCallback, // affected styles callback
+                                     OnError* errorCallback)            // error callback
+    {
+        applicationPtr->reloadStylesheet(path, styleChangedCallback, errorCallback);
+    }
+
     // Preloads elevation data.
     void EXPORT_API preloadElevation(int tileX,        // tile x
                                      int tileY,        // tile y
@@ -47,9 +85,11 @@ extern "C"
     }
 
     // Registers new persistent store.
-    void EXPORT_API registerPersistentStore(const char* key, const char* dataPath)
+    void EXPORT_API registerPersistentStore(const char* key,      // store key
+                                            const char* dataPath, // path to data directory
+                                            int sortBufferSize)   // size of external sort buffer in bytes, zero disables it
     {
-        applicationPtr->registerPersistentStore(key, dataPath);
+        applicationPtr->registerPersistentStore(key, dataPath, toSize(sortBufferSize));
     }
 
     // Adds data to store to specific level of details range.
@@ -156,6 +196,91 @@ extern "C"
         applicationPtr->loadQuadKey(styleFile, quadKey, meshCallback, elementCallback, errorCallback);
     }
 
+    // Loads quadkey with meshes in compact format.
+    void EXPORT_API loadQuadKeyCompact(const char* styleFile,                   // style file
+                                       int tileX, int tileY, int levelOfDetail, // quadkey info
+                                       OnCompactMeshBuilt* meshCallback,        // mesh callback
+                                       OnElementLoaded* elementCallback,        // element callback
+                                       OnError* errorCallback)                  // completion callback
+    {
+        utymap::QuadKey quadKey(levelOfDetail, tileX, tileY);
+        applicationPtr->loadQuadKeyCompact(styleFile, quadKey, meshCallback, elementCallback, errorCallback);
+    }
+
+    // Loads quadkeys asynchronously. Quadkeys with smaller priority are built first.
+    void EXPORT_API loadQuadKeysAsync(const char* styleFile,              // style file
+                                      const int* quadKeys,                // tile x, tile y and level of detail triples
+                                      const int* priorities,              // priority of each quadkey
+                                      int count,                          // amount of quadkeys
+                                      OnMeshBuilt* meshCallback,          // mesh callback
+                                      OnElementLoaded* elementCallback,   // element callback
+                                      OnQuadKeyLoaded* loadedCallback,    // quadkey completion callback
+                                      OnError* errorCallback)             // error callback
+    {
+        std::vector<utymap::QuadKey> requests;
+        if (!toQuadKeys(quadKeys, count, requests, errorCallback))
+            return;
+
+        applicationPtr->loadQuadKeysAsync(styleFile, requests, std::vector<int>(priorities, priorities + count),
+            meshCallback, elementCallback, loadedCallback, errorCallback);
+    }
+
+    // Loads quadkeys asynchronously with meshes in compact format.
+    void EXPORT_API loadQuadKeysCompactAsync(const char* styleFile,              // style file
+                                             const int* quadKeys,                // tile x, tile y and level of detail triples
+                                             const int* priorities,              // priority of each quadkey
+                                             int count,                          // amount of quadkeys
+                                             OnCompactMeshBuilt* meshCallback,   // mesh callback
+                                             OnElementLoaded* elementCallback,   // element callback
+                                             OnQuadKeyLoaded* loadedCallback,    // quadkey completion callback
+                                             OnError* errorCallback)             // error callback
+    {
+        std::vector<utymap::QuadKey> requests;
+        if (!toQuadKeys(quadKeys, count, requests, errorCallback))
+            return;
+
+        applicationPtr->loadQuadKeysCompactAsync(styleFile, requests, std::vector<int>(priorities, priorities + count),
+            meshCallback, elementCallback, loadedCallback, errorCallback);
+    }
+
+    // Loads quadkeys asynchronously: placeholders are delivered first, then replaced by detailed output.
+    void EXPORT_API loadQuadKeysProgressive(const char* styleFile,              // style file
+                                            const int* quadKeys,                // tile x, tile y and level of detail triples
+                                            const int* priorities,              // priority of each quadkey
+                                            int count,                          // amount of quadkeys
+                                            OnMeshGenerationBuilt* meshCallback, // mesh callback
+                                            OnElementLoaded* elementCallback,   // element callback
+                                            OnGenerationLoaded* loadedCallback, // generation completion callback
+                                            OnError* errorCallback)             // error callback
+    {
+        std::vector<utymap::QuadKey> requests;
+        if (!toQuadKeys(quadKeys, count, requests, errorCallback))
+            return;
+
+        applicationPtr->loadQuadKeysProgressive(styleFile, requests, std::vector<int>(priorities, priorities + count),
+            meshCallback, elementCallback, loadedCallback, errorCallback);
+    }
+
+    // Prefetches quadkeys which are likely to be visited next using movement hint.
+    void EXPORT_API prefetchQuadKeys(const char* styleFile,     // style file
+                                     double latitude,           // current latitude
+                                     double longitude,          // current longitude
+                                     double latitudeSpeed,      // latitude change in degrees per second
+                                     double longitudeSpeed,     // longitude change in degrees per second
+                                     int levelOfDetail,         // level of detail
+                                     int budget,                // max amount of quadkeys to prefetch
+                                     OnError* errorCallback)    // error callback
+    {
+        applicationPtr->prefetchQuadKeys(styleFile, utymap::GeoCoordinate(latitude, longitude),
+            latitudeSpeed, longitudeSpeed, levelOfDetail, toSize(budget), errorCallback);
+    }
+
+    // Cancels asynchronous loading of quadkey.
+    void EXPORT_API cancelQuadKey(int tileX, int tileY, int levelOfDetail) // quadkey info
+    {
+        applicationPtr->cancelQuadKey(utymap::QuadKey(levelOfDetail, tileX, tileY));
+    }
+
     // Checks whether there is data for given quadkey
     bool EXPORT_API hasData(int tileX, int tileY, int levelOfDetail) // quadkey info
     {
@@ -0,0 +1,244 @@
+#ifndef QUADKEYRECORD_HPP_DEFINED
+#define QUADKEYRECORD_HPP_DEFINED
+
+#include "Callbacks.hpp"
+#include "GeoCoordinate.hpp"
+#include "meshing/MeshTypes.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Holds output of built quadkey, so it can be delivered to external code later.
+struct QuadKeyRecord
+{
+    // Represents mesh in export format.
+    struct Mesh
+    {
+        std::string name;
+        std::vector<double> vertices;
+        std::vector<int> triangles;
+        std::vector<int> colors;
+    };
+
+    // Represents element in export format.
+    struct Element
+    {
+        std::uint64_t id;
+        std::vector<std::string> tags;
+        std::vector<double> vertices;
+        std::vector<std::string> style;
+    };
+
+    std::vector<Mesh> meshes;
+    std::vector<Element> elements;
+
+    void addMesh(const utymap::meshing::Mesh& mesh)
+    {
+        // NOTE do not record if mesh is empty.
+        if (!mesh.vertices.empty())
+            meshes.push_back(Mesh{ mesh.name, mesh.vertices, mesh.triangles, mesh.colors });
+    }
+
+    void addElement(std::uint64_t id, const char** tags, int tagsSize,
+                    const double* vertices, int vertexSize,
+                    const char** style, int styleSize)
+    {
+        elements.push_back(Element{ id,
+            std::vector<std::string>(tags, tags + tagsSize),
+            std::vector<double>(vertices, vertices + vertexSize),
+            std::vector<std::string>(style, style + styleSize) });
+    }
+
+    //                                      Record format
+    //------------------------------------------------------------------------------------------------------|
+    //   DESCRIPTION    |                       DETAILS                                                     |
+    //------------------------------------------------------------------------------------------------------|
+    //     Meshes       |  Mesh count (4b), each is name, vertices, triangles and colors                    |
+    //------------------------------------------------------------------------------------------------------|
+    //    Elements      |  Element count (4b), each is id (8b), tags, vertices and style                    |
+    //------------------------------------------------------------------------------------------------------|
+    //  Lists and strings are prefixed by size (4b).
+
+    // Writes record to stream.
+    void write(std::ostream& stream) const
+    {
+        writeValue(stream, static_cast<std::uint32_t>(meshes.size()));
+        for (const auto& mesh : meshes) {
+            writeString(stream, mesh.name);
+            writeList(stream, mesh.vertices);
+            writeList(stream, mesh.triangles);
+            writeList(stream, mesh.colors);
+        }
+
+        writeValue(stream, static_cast<std::uint32_t>(elements.size()));
+        for (const auto& element : elements) {
+            writeValue(stream, element.id);
+            writeValue(stream, static_cast<std::uint32_t>(element.tags.size()));
+            for (const auto& tag : element.tags)
+                writeString(stream, tag);
+            writeList(stream, element.vertices);
+            writeValue(stream, static_cast<std::uint32_t>(element.style.size()));
+            for (const auto& style : element.style)
+                writeString(stream, style);
+        }
+    }
+
+    // Reads record from stream. Returns false if data is malformed.
+    bool read(std::istream& stream)
+    {
+        std::uint32_t size;
+        if (!readValue(stream, size)) return false;
+        meshes.resize(size);
+        for (auto& mesh : meshes) {
+            if (!readString(stream, mesh.name) ||
+                !readList(stream, mesh.vertices) ||
+                !readList(stream, mesh.triangles) ||
+                !readList(stream, mesh.colors))
+                return false;
+        }
+
+        if (!readValue(stream, size)) return false;
+        elements.resize(size);
+        for (auto& element : elements) {
+            if (!readValue(stream, element.id) || !readValue(stream, size)) return false;
+            element.tags.resize(size);
+            for (auto& tag : element.tags)
+                if (!readString(stream, tag)) return false;
+            if (!readList(stream, element.vertices) || !readValue(stream, size)) return false;
+            element.style.resize(size);
+            for (auto& style : element.style)
+                if (!readString(stream, style)) return false;
+        }
+        return true;
+    }
+
+    // Calls callbacks for all recorded meshes and then for all recorded elements.
+    void replay(const std::function<OnMeshBuilt>& meshCallback,
+                const std::function<OnElementLoaded>& elementCallback) const
+    {
+        for (const auto& mesh : meshes) {
+            meshCallback(mesh.name.data(),
+                mesh.vertices.data(), static_cast<int>(mesh.vertices.size()),
+                mesh.triangles.data(), static_cast<int>(mesh.triangles.size()),
+                mesh.colors.data(), static_cast<int>(mesh.colors.size()));
+        }
+
+        replayElements(elementCallback);
+    }
+
+    // Calls callbacks for all recorded meshes in compact format and then for all recorded elements.
+    // Origin is south west corner of quadkey.
+    void replayCompact(const utymap::GeoCoordinate& origin,
+                       const std::function<OnCompactMeshBuilt>& meshCallback,
+                       const std::function<OnElementLoaded>& elementCallback) const
+    {
+        // NOTE buffers are reused between meshes.
+        std::vector<float> vertices;
+        std::vector<std::uint16_t> shortTriangles;
+        std::vector<std::uint8_t> colors;
+        for (const auto& mesh : meshes) {
+            vertices.resize(mesh.vertices.size());
+            for (std::size_t i = 0; i + 2 < mesh.vertices.size(); i += 3) {
+                vertices[i] = static_cast<float>(mesh.vertices[i] - origin.longitude);
+                vertices[i + 1] = static_cast<float>(mesh.vertices[i + 1] - origin.latitude);
+                vertices[i + 2] = static_cast<float>(mesh.vertices[i + 2]);
+            }
+
+            const void* triangles = mesh.triangles.data();
+            int indexSize = sizeof(int);
+            if (mesh.vertices.size() / 3 <= std::numeric_limits<std::uint16_t>::max() + 1) {
+                shortTriangles.assign(mesh.triangles.begin(), mesh.triangles.end());
+                triangles = shortTriangles.data();
+                indexSize = sizeof(std::uint16_t);
+            }
+
+            colors.resize(mesh.colors.size() * 4);
+            for (std::size_t i = 0; i < mesh.colors.size(); ++i) {
+                std::uint32_t rgba = static_cast<std::uint32_t>(mesh.colors[i]);
+                colors[i * 4] = static_cast<std::uint8_t>(rgba >> 24);
+                colors[i * 4 + 1] = static_cast<std::uint8_t>(rgba >> 16);
+                colors[i * 4 + 2] = static_cast<std::uint8_t>(rgba >> 8);
+                colors[i * 4 + 3] = static_cast<std::uint8_t>(rgba);
+            }
+
+            meshCallback(mesh.name.data(),
+                vertices.data(), static_cast<int>(vertices.size()),
+                triangles, static_cast<int>(mesh.triangles.size()), indexSize,
+                colors.data(), static_cast<int>(mesh.colors.size()));
+        }
+
+        replayElements(elementCallback);
+    }
+
+private:
+
+    void replayElements(const std::function<OnElementLoaded>& elementCallback) const
+    {
+        std::vector<const char*> ctags;
+        std::vector<const char*> cstyles;
+        for (const auto& element : elements) {
+            ctags.clear();
+            cstyles.clear();
+            for (const auto& tag : element.tags)
+                ctags.push_back(tag.c_str());
+            for (const auto& style : element.style)
+                cstyles.push_back(style.c_str());
+
+            elementCallback(element.id,
+                ctags.data(), static_cast<int>(ctags.size()),
+                element.vertices.data(), static_cast<int>(element.vertices.size()),
+                cstyles.data(), static_cast<int>(cstyles.size()));
+        }
+    }
+
+    template <typename T>
+    static void writeValue(std::ostream& stream, const T& value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    static void writeList(std::ostream& stream, const std::vector<T>& list)
+    {
+        writeValue(stream, static_cast<std::uint32_t>(list.size()));
+        stream.write(reinterpret_cast<const char*>(list.data()), list.size() * sizeof(T));
+    }
+
+    static void writeString(std::ostream& stream, const std::string& str)
+    {
+        writeValue(stream, static_cast<std::uint32_t>(str.size()));
+        stream.write(str.data(), str.size());
+    }
+
+    template <typename T>
+    static bool readValue(std::istream& stream, T& value)
+    {
+        return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    template <typename T>
+    static bool readList(std::istream& stream, std::vector<T>& list)
+    {
+        std::uint32_t size;
+        if (!readValue(stream, size))
+            return false;
+        list.resize(size);
+        return size == 0 || static_cast<bool>(stream.read(reinterpret_cast<char*>(list.data()), size * sizeof(T)));
+    }
+
+    static bool readString(std::istream& stream, std::string& str)
+    {
+        std::uint32_t size;
+        if (!readValue(stream, size))
+            return false;
+        str.resize(size);
+        return size == 0 || static_cast<bool>(stream.read(&str[0], size));
+    }
+};
+
+#endif // QUADKEYRECORD_HPP_DEFINED
@@ -0,0 +1,43 @@
+#ifndef CANCELLATIONTOKEN_HPP_DEFINED
+#define CANCELLATIONTOKEN_HPP_DEFINED
+
+#include <atomic>
+
+namespace utymap {
+
+// Allows to stop long running operation cooperatively: operation checks token
+// at safe points and stops work if it is cancelled.
+class CancellationToken
+{
+public:
+    CancellationToken() : isCancelled_(false)
+    {
+    }
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    // Returns token which is never cancelled.
+    static const CancellationToken& none()
+    {
+        static const CancellationToken token;
+        return token;
+    }
+
+    // Requests cancellation. Can be called from any thread.
+    void cancel()
+    {
+        isCancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    bool isCancelled() const
+    {
+        return isCancelled_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<bool> isCancelled_;
+};
+
+}
+#endif // CANCELLATIONTOKEN_HPP_DEFINED
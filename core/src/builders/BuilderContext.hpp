@@ -2,6 +2,7 @@
 #define BUILDERS_BUILDERCONTEXT_HPP_DEFINED
 
 #include "BoundingBox.hpp"
+#include "CancellationToken.hpp"
 #include "QuadKey.hpp"
 #include "heightmap/ElevationProvider.hpp"
 #include "mapcss/StyleProvider.hpp"
@@ -32,6 +33,8 @@ struct BuilderContext
     std::function<void(const utymap::meshing::Mesh&)> meshCallback;
     // Element callback is called to process original element by external logic.
     std::function<void(const utymap::entities::Element&)> elementCallback;
+    // Cancellation token: builders should stop work once it is cancelled.
+    const utymap::CancellationToken& cancelToken;
     // Mesh builder.
     const utymap::meshing::MeshBuilder meshBuilder;
 
@@ -40,13 +43,15 @@ struct BuilderContext
                    utymap::index::StringTable& stringTable,
                    const utymap::heightmap::ElevationProvider& eleProvider,
                    std::function<void(const utymap::meshing::Mesh&)> meshCallback,
-                   std::function<void(const utymap::entities::Element&)> elementCallback) :
+                   std::function<void(const utymap::entities::Element&)> elementCallback,
+                   const utymap::CancellationToken& cancelToken = utymap::CancellationToken::none()) :
         quadKey(quadKey),
         boundingBox(utymap::utils::GeoUtils::quadKeyToBoundingBox(quadKey)),
         styleProvider(styleProvider),
         stringTable(stringTable),
         eleProvider(eleProvider),
-        meshBuilder(eleProvider),
+        cancelToken(cancelToken),
+        meshBuilder(eleProvider, cancelToken),
         meshCallback(meshCallback),
         elementCallback(elementCallback)
     {
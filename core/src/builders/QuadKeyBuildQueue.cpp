@@ -0,0 +1,151 @@
+#include "builders/QuadKeyBuildQueue.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace utymap;
+using namespace utymap::builders;
+
+namespace {
+    // Represents scheduled quadkey.
+    struct Request
+    {
+        QuadKey quadKey;
+        int priority;
+        std::uint64_t sequence;
+        QuadKeyBuildQueue::Task task;
+    };
+
+    // Orders requests in priority queue: top is the one with smallest priority
+    // value, ties are resolved by order of enqueuing.
+    struct RequestOrder
+    {
+        bool operator()(const Request& lhs, const Request& rhs) const
+        {
+            return lhs.priority != rhs.priority
+                ? lhs.priority > rhs.priority
+                : lhs.sequence > rhs.sequence;
+        }
+    };
+}
+
+class QuadKeyBuildQueue::QuadKeyBuildQueueImpl
+{
+public:
+    QuadKeyBuildQueueImpl(std::size_t workerCount) :
+        workerCount_(workerCount > 0 ? workerCount : std::max(std::thread::hardware_concurrency(), 1u)),
+        requests_(), nextSequence_(0), running_(0), isStopped_(false), error_(nullptr), workers_()
+    {
+    }
+
+    ~QuadKeyBuildQueueImpl()
+    {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            isStopped_ = true;
+        }
+        inputCondition_.notify_all();
+        for (auto& worker : workers_) {
+            if (worker.joinable())
+                worker.join();
+        }
+    }
+
+    void enqueue(const QuadKey& quadKey, int priority, const Task& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            // NOTE workers are started lazily as most applications never use async loading.
+            if (workers_.empty()) {
+                for (std::size_t i = 0; i < workerCount_; ++i)
+                    workers_.push_back(std::thread(&QuadKeyBuildQueueImpl::run, this));
+            }
+            requests_.push(Request{ quadKey, priority, nextSequence_++, task });
+        }
+        inputCondition_.notify_one();
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        idleCondition_.wait(lock, [&]() { return requests_.empty() && running_ == 0; });
+
+        if (error_ != nullptr) {
+            std::exception_ptr error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+
+    void run()
+    {
+        while (true) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(lock_);
+                inputCondition_.wait(lock, [&]() { return isStopped_ || !requests_.empty(); });
+                if (isStopped_)
+                    return;
+                request = requests_.top();
+                requests_.pop();
+                ++running_;
+            }
+
+            std::exception_ptr error = nullptr;
+            try {
+                request.task(request.quadKey);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(lock_);
+                // NOTE keep the first error only, next tasks are still run.
+                if (error_ == nullptr)
+                    error_ = error;
+                --running_;
+            }
+            idleCondition_.notify_all();
+        }
+    }
+
+    const std::size_t workerCount_;
+
+    std::priority_queue<Request, std::vector<Request>, RequestOrder> requests_;
+    std::uint64_t nextSequence_;
+    std::size_t running_;
+    bool isStopped_;
+    std::exception_ptr error_;
+
+    std::mutex lock_;
+    std::condition_variable inputCondition_;
+    std::condition_variable idleCondition_;
+    std::vector<std::thread> workers_;
+};
+
+QuadKeyBuildQueue::QuadKeyBuildQueue(std::size_t workerCount) :
+    pimpl_(new QuadKeyBuildQueue::QuadKeyBuildQueueImpl(workerCount))
+{
+}
+
+QuadKeyBuildQueue::~QuadKeyBuildQueue()
+{
+}
+
+void QuadKeyBuildQueue::enqueue(const QuadKey& quadKey, int priority, const Task& task)
+{
+    pimpl_->enqueue(quadKey, priority, task);
+}
+
+void QuadKeyBuildQueue::wait()
+{
+    pimpl_->wait();
+}
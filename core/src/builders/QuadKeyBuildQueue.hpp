@@ -0,0 +1,41 @@
+#ifndef BUILDERS_QUADKEYBUILDQUEUE_HPP_DEFINED
+#define BUILDERS_QUADKEYBUILDQUEUE_HPP_DEFINED
+
+#include "QuadKey.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace utymap { namespace builders {
+
+// Builds quadkeys on worker threads in order of their priority: the smaller
+// priority value is, the earlier quadkey is built. Quadkeys with equal priority
+// are built in order of enqueuing. Each task owns its builder state.
+class QuadKeyBuildQueue
+{
+public:
+    // Defines function which builds quadkey. Should be thread safe.
+    typedef std::function<void(const utymap::QuadKey&)> Task;
+
+    // Creates queue. If worker count is zero, hardware concurrency is used.
+    // Workers are started on first enqueue.
+    explicit QuadKeyBuildQueue(std::size_t workerCount = 0);
+
+    // Stops queue without running pending tasks. Waits for running ones.
+    ~QuadKeyBuildQueue();
+
+    // Schedules building of quadkey with given priority.
+    void enqueue(const utymap::QuadKey& quadKey, int priority, const Task& task);
+
+    // Waits until all enqueued tasks are run. Rethrows task error if any.
+    void wait();
+
+private:
+    class QuadKeyBuildQueueImpl;
+    std::unique_ptr<QuadKeyBuildQueueImpl> pimpl_;
+};
+
+}}
+
+#endif // BUILDERS_QUADKEYBUILDQUEUE_HPP_DEFINED
@@ -9,6 +9,11 @@
 #include "entities/Relation.hpp"
 #include "utils/CoreUtils.hpp"
 
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 using namespace utymap;
 using namespace utymap::builders;
 using namespace utymap::entities;
@@ -23,7 +28,97 @@ class QuadKeyBuilder::QuadKeyBuilderImpl
 {
 private:
 
-    typedef std::unordered_map<std::string, ElementBuilderFactory> BuilderFactoryMap;
+// Resolves builder names used in builders declarations to indices once per declaration.
+class BuilderRegistry
+{
+    const std::size_t MinPruneSize = 1024;
+
+public:
+    typedef std::vector<std::size_t> Indices;
+
+    void add(const std::string& name, const ElementBuilderFactory& factory)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        factories_[getIndex(name)] = factory;
+    }
+
+    // Gets indices of builders listed in declaration value.
+    const Indices& resolve(const Style::value_type& declaration)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        // NOTE expired entry means that its address can be reused by another declaration.
+        auto pair = resolved_.find(declaration.get());
+        if (pair != resolved_.end() && !pair->second.declaration.expired())
+            return pair->second.indices;
+
+        if (resolved_.size() >= pruneSize_)
+            prune();
+
+        Resolved& resolved = resolved_[declaration.get()];
+        resolved.declaration = declaration;
+        resolved.indices.clear();
+        for (const auto& name : declaration->values())
+            resolved.indices.push_back(getIndex(name));
+
+        return resolved.indices;
+    }
+
+    // Creates builder with given index. Unknown names are handled by external builder.
+    std::shared_ptr<ElementBuilder> create(std::size_t index, const BuilderContext& context)
+    {
+        ElementBuilderFactory factory;
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            factory = factories_[index];
+        }
+        return factory
+            ? factory(context)
+            : std::make_shared<ExternalBuilder>(context);
+    }
+
+    std::size_t size()
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        return factories_.size();
+    }
+
+private:
+    // Declaration is not owned, so entries of reloaded stylesheets do not stay forever.
+    struct Resolved
+    {
+        std::weak_ptr<StyleDeclaration> declaration;
+        Indices indices;
+    };
+
+    // Removes entries of destroyed declarations. NOTE indices of alive declarations
+    // are referenced by running builds, so they are kept.
+    void prune()
+    {
+        for (auto it = resolved_.begin(); it != resolved_.end();) {
+            if (it->second.declaration.expired())
+                it = resolved_.erase(it);
+            else
+                ++it;
+        }
+        pruneSize_ = std::max(MinPruneSize, resolved_.size() * 2);
+    }
+
+    std::size_t getIndex(const std::string& name)
+    {
+        auto pair = indices_.find(name);
+        if (pair != indices_.end())
+            return pair->second;
+
+        factories_.push_back(nullptr);
+        return indices_[name] = factories_.size() - 1;
+    }
+
+    std::mutex lock_;
+    std::unordered_map<std::string, std::size_t> indices_;
+    std::vector<ElementBuilderFactory> factories_;
+    std::unordered_map<const StyleDeclaration*, Resolved> resolved_;
+    std::size_t pruneSize_ = MinPruneSize;
+};
 
 class AggregateElementVisitor : public ElementVisitor
 {
@@ -34,11 +129,13 @@ public:
                            const ElevationProvider& eleProvider,
                            const MeshCallback& meshFunc,
                            const ElementCallback& elementFunc,
-                           BuilderFactoryMap& builderFactoryMap,
-                           std::uint32_t builderKeyId) :
-        context_(quadKey, styleProvider, stringTable, eleProvider, meshFunc, elementFunc),
-        builderFactoryMap_(builderFactoryMap),
-        builderKeyId_(builderKeyId)
+                           BuilderRegistry& registry,
+                           std::uint32_t builderKeyId,
+                           const CancellationToken& cancelToken) :
+        context_(quadKey, styleProvider, stringTable, eleProvider, meshFunc, elementFunc, cancelToken),
+        registry_(registry),
+        builderKeyId_(builderKeyId),
+        builders_(registry.size())
     {
     }
 
@@ -52,8 +149,12 @@ public:
 
     void complete()
     {
-        for (const auto& builder : builders_)
-            builder.second->complete();
+        for (const auto& builder : builders_) {
+            if (context_.cancelToken.isCancelled())
+                return;
+            if (builder != nullptr)
+                builder->complete();
+        }
     }
 
 private:
@@ -61,44 +162,50 @@ private:
     // Calls appropriate visitor for given element
     void visitElement(const Element& element)
     {
+        // NOTE store still visits the rest of elements, but they are skipped cheaply.
+        if (context_.cancelToken.isCancelled())
+            return;
+
         Style style = context_.styleProvider.forElement(element, context_.quadKey.levelOfDetail);
 
         // We don't know how to build it. Skip.
         if (!style.has(builderKeyId_))
             return;
 
-        std::stringstream ss(*style.get(builderKeyId_)->value());
-        while (ss.good()) {
-            std::string name;
-            getline(ss, name, ',');
-            element.accept(getBuilder(name));
-        }
+        for (std::size_t index : getIndices(style.get(builderKeyId_)))
+            element.accept(getBuilder(index));
     }
 
-    ElementBuilder& getBuilder(const std::string& name)
+    // Gets builder indices using tile local cache to avoid locking registry for each element.
+    const BuilderRegistry::Indices& getIndices(const Style::value_type& declaration)
     {
-        auto builderPair = builders_.find(name);
-        if (builderPair != builders_.end()) {
-            return *builderPair->second;
-        }
+        auto pair = indices_.find(declaration.get());
+        if (pair != indices_.end())
+            return *pair->second;
 
-        auto factory = builderFactoryMap_.find(name);
-        if (factory == builderFactoryMap_.end()) {
-            // use external builder by default
-            auto externalBuilder = std::make_shared<ExternalBuilder>(context_);
-            builders_[name] = externalBuilder;
-            return *externalBuilder;
-        }
+        const auto& indices = registry_.resolve(declaration);
+        indices_[declaration.get()] = &indices;
+        return indices;
+    }
+
+    ElementBuilder& getBuilder(std::size_t index)
+    {
+        if (index >= builders_.size())
+            builders_.resize(index + 1);
+
+        auto& builder = builders_[index];
+        if (builder == nullptr)
+            builder = registry_.create(index, context_);
 
-        auto builder = factory->second(context_);
-        builders_[name] = builder;
         return *builder;
     }
 
     const BuilderContext context_;
-    BuilderFactoryMap& builderFactoryMap_;
+    BuilderRegistry& registry_;
     std::uint32_t builderKeyId_;
-    std::unordered_map<std::string, std::shared_ptr<ElementBuilder>> builders_;
+    // NOTE builders are completed in order of registration.
+    std::vector<std::shared_ptr<ElementBuilder>> builders_;
+    std::unordered_map<const StyleDeclaration*, const BuilderRegistry::Indices*> indices_;
 };
 
 public:
@@ -107,23 +214,24 @@ public:
         geoStore_(geoStore),
         stringTable_(stringTable),
         builderKeyId_(stringTable.getId(BuilderKeyName)),
-        builderFactory_()
+        registry_()
     {
     }
 
     void registerElementVisitor(const std::string& name, ElementBuilderFactory factory)
     {
-        builderFactory_[name] = factory;
+        registry_.add(name, factory);
     }
 
     void build(const QuadKey& quadKey,
                const StyleProvider& styleProvider,
                const ElevationProvider& eleProvider,
                const MeshCallback& meshFunc,
-               const ElementCallback& elementFunc)
+               const ElementCallback& elementFunc,
+               const CancellationToken& cancelToken)
     {
         AggregateElementVisitor elementVisitor(quadKey, styleProvider, stringTable_,
-            eleProvider, meshFunc, elementFunc, builderFactory_, builderKeyId_);
+            eleProvider, meshFunc, elementFunc, registry_, builderKeyId_, cancelToken);
 
         geoStore_.search(quadKey, styleProvider, elementVisitor);
         elementVisitor.complete();
@@ -133,7 +241,7 @@ private:
     GeoStore& geoStore_;
     StringTable& stringTable_;
     std::uint32_t builderKeyId_;
-    BuilderFactoryMap builderFactory_;
+    BuilderRegistry registry_;
 };
 
 void QuadKeyBuilder::registerElementBuilder(const std::string& name, ElementBuilderFactory factory)
@@ -142,9 +250,9 @@ void QuadKeyBuilder::registerElementBuilder(const std::string& name, ElementBuil
 }
 
 void QuadKeyBuilder::build(const QuadKey& quadKey, const StyleProvider& styleProvider, const ElevationProvider& eleProvider, 
-    MeshCallback meshFunc, ElementCallback elementFunc)
+    MeshCallback meshFunc, ElementCallback elementFunc, const CancellationToken& cancelToken)
 {
-    pimpl_->build(quadKey, styleProvider, eleProvider, meshFunc, elementFunc);
+    pimpl_->build(quadKey, styleProvider, eleProvider, meshFunc, elementFunc, cancelToken);
 }
 
 QuadKeyBuilder::QuadKeyBuilder(GeoStore& geoStore, StringTable& stringTable) :
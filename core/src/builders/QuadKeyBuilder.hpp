@@ -1,6 +1,7 @@
 #ifndef BUILDERS_QUADKEYBUILDER_HPP_DEFINED
 #define BUILDERS_QUADKEYBUILDER_HPP_DEFINED
 
+#include "CancellationToken.hpp"
 #include "QuadKey.hpp"
 #include "builders/BuilderContext.hpp"
 #include "builders/ElementBuilder.hpp"
@@ -34,12 +35,14 @@ public:
     // Registers factory method for element builder.
     void registerElementBuilder(const std::string& name, ElementBuilderFactory factory);
 
-    // Builds tile for given quadkey.
+    // Builds tile for given quadkey. Build stops shortly after token is cancelled:
+    // output produced so far is incomplete and should be discarded.
     void build(const utymap::QuadKey& quadKey,
                const utymap::mapcss::StyleProvider& styleProvider,
                const utymap::heightmap::ElevationProvider& eleProvider,
                MeshCallback meshFunc,
-               ElementCallback elementFunc);
+               ElementCallback elementFunc,
+               const utymap::CancellationToken& cancelToken = utymap::CancellationToken::none());
 
 private:
     class QuadKeyBuilderImpl;
@@ -0,0 +1,332 @@
+#include "builders/QuadKeyCache.hpp"
+#include "hashing/MurmurHash3.h"
+#include "utils/GeoUtils.hpp"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+using namespace utymap;
+using namespace utymap::builders;
+using namespace utymap::utils;
+
+namespace {
+    //                                      Cache file format
+    //------------------------------------------------------------------------------------------------------|
+    //   DESCRIPTION    |                       DETAILS                                                     |
+    //------------------------------------------------------------------------------------------------------|
+    //     Header       |  Magic (4b), format version (4b), hash of quadkey inputs (8b) and data size (4b)  |
+    //------------------------------------------------------------------------------------------------------|
+    //      Data        |  Quadkey data with size from header                                               |
+    //------------------------------------------------------------------------------------------------------|
+    const std::uint32_t Magic = 0x43514d55; // UMQC
+    const std::uint32_t Version = 1;
+    const std::size_t HeaderSize = 20;
+    const std::string CacheFileExtension = ".cache";
+    // NOTE files are locked by stripes, so distinct quadkeys are rarely serialized.
+    const std::size_t FileLockCount = 16;
+
+    // Represents cached quadkey in memory.
+    struct Entry
+    {
+        std::string key;
+        std::uint64_t hash;
+        std::string data;
+    };
+
+    // Represents cached quadkey on disk.
+    struct FileEntry
+    {
+        std::string path;
+        std::size_t size;
+    };
+}
+
+class QuadKeyCache::QuadKeyCacheImpl
+{
+    typedef std::list<Entry> Entries;
+    typedef std::list<FileEntry> FileEntries;
+
+public:
+    QuadKeyCacheImpl(const std::string& dataPath, std::size_t memoryCapacity, std::size_t diskCapacity) :
+        dataPath_(dataPath), memoryCapacity_(memoryCapacity), memorySize_(0), entries_(), index_(),
+        diskCapacity_(diskCapacity), diskSize_(0), files_(), fileIndex_()
+    {
+        if (!dataPath_.empty())
+            scanFiles();
+    }
+
+    bool get(const QuadKey& quadKey, std::uint64_t hash, std::string& data)
+    {
+        std::string key = GeoUtils::quadKeyToString(quadKey);
+        {
+            std::lock_guard<std::mutex> lock(memoryLock_);
+            auto pair = index_.find(key);
+            if (pair != index_.end() && pair->second->hash == hash) {
+                // NOTE most recently used entry is kept first.
+                entries_.splice(entries_.begin(), entries_, pair->second);
+                data = pair->second->data;
+                return true;
+            }
+        }
+
+        if (dataPath_.empty() || !read(getFilePath(quadKey), hash, data))
+            return false;
+
+        store(key, hash, data);
+        return true;
+    }
+
+    void put(const QuadKey& quadKey, std::uint64_t hash, const std::string& data)
+    {
+        store(GeoUtils::quadKeyToString(quadKey), hash, data);
+
+        if (!dataPath_.empty())
+            write(getFilePath(quadKey), hash, data);
+    }
+
+private:
+
+    // Stores entry in memory evicting least recently used ones.
+    void store(const std::string& key, std::uint64_t hash, const std::string& data)
+    {
+        std::lock_guard<std::mutex> lock(memoryLock_);
+        auto pair = index_.find(key);
+        if (pair != index_.end())
+            remove(pair->second);
+
+        // NOTE too big data is never kept in memory.
+        if (data.size() > memoryCapacity_)
+            return;
+
+        entries_.push_front(Entry{ key, hash, data });
+        index_[key] = entries_.begin();
+        memorySize_ += data.size();
+
+        while (memorySize_ > memoryCapacity_)
+            remove(std::prev(entries_.end()));
+    }
+
+    void remove(Entries::iterator entry)
+    {
+        memorySize_ -= entry->data.size();
+        index_.erase(entry->key);
+        entries_.erase(entry);
+    }
+
+    bool read(const std::string& path, std::uint64_t hash, std::string& data)
+    {
+        std::vector<std::string> evicted;
+        {
+            std::lock_guard<std::mutex> lock(getFileLock(path));
+            std::ifstream file(path, std::ios::in | std::ios::binary);
+
+            std::uint32_t magic, version, size;
+            std::uint64_t fileHash;
+            if (!readValue(file, magic) || magic != Magic ||
+                !readValue(file, version) || version != Version ||
+                !readValue(file, fileHash) || fileHash != hash ||
+                !readValue(file, size))
+                return false;
+
+            std::string content(size, '\0');
+            if (size > 0 && !file.read(&content[0], size))
+                return false;
+
+            data = std::move(content);
+            evicted = touchFile(path, HeaderSize + data.size());
+        }
+
+        for (const auto& evictedPath : evicted)
+            removeFile(evictedPath);
+        return true;
+    }
+
+    void write(const std::string& path, std::uint64_t hash, const std::string& data)
+    {
+        std::vector<std::string> evicted;
+        {
+            std::lock_guard<std::mutex> lock(getFileLock(path));
+            // NOTE too big data is never kept on disk.
+            if (diskCapacity_ > 0 && HeaderSize + data.size() > diskCapacity_) {
+                std::remove(path.c_str());
+                forgetFile(path);
+                return;
+            }
+
+            std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!file.good())
+                return;
+
+            writeValue(file, Magic);
+            writeValue(file, Version);
+            writeValue(file, hash);
+            writeValue(file, static_cast<std::uint32_t>(data.size()));
+            file.write(data.data(), data.size());
+            file.close();
+
+            evicted = touchFile(path, HeaderSize + data.size());
+        }
+
+        // NOTE evicted files are removed without holding lock of written one,
+        // so locks of two files are never held at the same time.
+        for (const auto& evictedPath : evicted)
+            removeFile(evictedPath);
+    }
+
+    // Registers existing cache files with most recently modified ones kept first.
+    void scanFiles()
+    {
+        namespace fs = boost::filesystem;
+        std::vector<std::tuple<std::time_t, std::string, std::size_t>> files;
+        boost::system::error_code ec;
+        for (fs::directory_iterator it(dataPath_, ec), end; !ec && it != end; it.increment(ec)) {
+            const fs::path& path = it->path();
+            if (path.extension().string() != CacheFileExtension || !fs::is_regular_file(path, ec))
+                continue;
+            files.push_back(std::make_tuple(fs::last_write_time(path, ec), getFilePath(path.filename().string()),
+                static_cast<std::size_t>(fs::file_size(path, ec))));
+        }
+        std::sort(files.begin(), files.end());
+
+        std::vector<std::string> evicted;
+        for (const auto& file : files) {
+            auto removed = touchFile(std::get<1>(file), std::get<2>(file));
+            evicted.insert(evicted.end(), removed.begin(), removed.end());
+        }
+        for (const auto& path : evicted)
+            removeFile(path);
+    }
+
+    // Marks file as most recently used and returns least recently used ones which exceed disk capacity.
+    std::vector<std::string> touchFile(const std::string& path, std::size_t size)
+    {
+        std::lock_guard<std::mutex> lock(diskLock_);
+        auto pair = fileIndex_.find(path);
+        if (pair != fileIndex_.end()) {
+            diskSize_ -= pair->second->size;
+            pair->second->size = size;
+            files_.splice(files_.begin(), files_, pair->second);
+        } else {
+            files_.push_front(FileEntry{ path, size });
+            fileIndex_[path] = files_.begin();
+        }
+        diskSize_ += size;
+
+        std::vector<std::string> evicted;
+        while (diskCapacity_ > 0 && diskSize_ > diskCapacity_) {
+            auto last = std::prev(files_.end());
+            evicted.push_back(last->path);
+            diskSize_ -= last->size;
+            fileIndex_.erase(last->path);
+            files_.erase(last);
+        }
+        return evicted;
+    }
+
+    void forgetFile(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(diskLock_);
+        auto pair = fileIndex_.find(path);
+        if (pair == fileIndex_.end())
+            return;
+
+        diskSize_ -= pair->second->size;
+        files_.erase(pair->second);
+        fileIndex_.erase(pair);
+    }
+
+    // Removes evicted file unless it was written again after eviction.
+    void removeFile(const std::string& path)
+    {
+        std::lock_guard<std::mutex> fileLock(getFileLock(path));
+        std::lock_guard<std::mutex> lock(diskLock_);
+        if (fileIndex_.find(path) == fileIndex_.end())
+            std::remove(path.c_str());
+    }
+
+    std::mutex& getFileLock(const std::string& path)
+    {
+        return fileLocks_[std::hash<std::string>()(path) % FileLockCount];
+    }
+
+    template <typename T>
+    static bool readValue(std::istream& stream, T& value)
+    {
+        return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    template <typename T>
+    static void writeValue(std::ostream& stream, const T& value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // Gets full file path for given quadkey. NOTE level of detail is needed for zero one.
+    std::string getFilePath(const QuadKey& quadKey) const
+    {
+        std::stringstream ss;
+        ss << quadKey.levelOfDetail << "-" << GeoUtils::quadKeyToString(quadKey) << CacheFileExtension;
+        return getFilePath(ss.str());
+    }
+
+    std::string getFilePath(const std::string& fileName) const
+    {
+        return dataPath_ + fileName;
+    }
+
+    const std::string dataPath_;
+    const std::size_t memoryCapacity_;
+    std::size_t memorySize_;
+
+    Entries entries_;
+    std::unordered_map<std::string, Entries::iterator> index_;
+    std::mutex memoryLock_;
+
+    const std::size_t diskCapacity_;
+    std::size_t diskSize_;
+
+    // NOTE file index is guarded by disk lock, file content by file locks.
+    FileEntries files_;
+    std::unordered_map<std::string, FileEntries::iterator> fileIndex_;
+    std::mutex diskLock_;
+    std::array<std::mutex, FileLockCount> fileLocks_;
+};
+
+QuadKeyCache::QuadKeyCache(const std::string& dataPath, std::size_t memoryCapacity, std::size_t diskCapacity) :
+    pimpl_(new QuadKeyCache::QuadKeyCacheImpl(dataPath, memoryCapacity, diskCapacity))
+{
+}
+
+QuadKeyCache::~QuadKeyCache()
+{
+}
+
+std::uint64_t QuadKeyCache::hash(const std::string& inputs)
+{
+    std::uint64_t hash[2];
+    MurmurHash3_x64_128(inputs.data(), static_cast<int>(inputs.size()), Version, hash);
+    return hash[0];
+}
+
+bool QuadKeyCache::get(const QuadKey& quadKey, std::uint64_t hash, std::string& data)
+{
+    return pimpl_->get(quadKey, hash, data);
+}
+
+void QuadKeyCache::put(const QuadKey& quadKey, std::uint64_t hash, const std::string& data)
+{
+    pimpl_->put(quadKey, hash, data);
+}
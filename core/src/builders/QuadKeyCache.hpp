@@ -0,0 +1,41 @@
+#ifndef BUILDERS_QUADKEYCACHE_HPP_DEFINED
+#define BUILDERS_QUADKEYCACHE_HPP_DEFINED
+
+#include "QuadKey.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace utymap { namespace builders {
+
+// Caches output of built quadkeys: recently used ones are kept in memory and,
+// if data path is set, on disk. Each quadkey has a single entry identified by
+// hash of everything its output depends on. Thread safe.
+class QuadKeyCache
+{
+public:
+    // Creates cache. Disk tier is disabled if data path is empty.
+    // Memory and disk capacities are max sizes of data kept in memory and on disk
+    // in bytes. Zero disk capacity means that disk size is not limited.
+    QuadKeyCache(const std::string& dataPath, std::size_t memoryCapacity, std::size_t diskCapacity = 0);
+
+    ~QuadKeyCache();
+
+    // Gets hash of text which describes everything quadkey output depends on.
+    static std::uint64_t hash(const std::string& inputs);
+
+    // Gets data of quadkey built with given hash. Returns false if there is no such data.
+    bool get(const utymap::QuadKey& quadKey, std::uint64_t hash, std::string& data);
+
+    // Stores data of quadkey built with given hash. Replaces entry with another hash.
+    void put(const utymap::QuadKey& quadKey, std::uint64_t hash, const std::string& data);
+
+private:
+    class QuadKeyCacheImpl;
+    std::unique_ptr<QuadKeyCacheImpl> pimpl_;
+};
+
+}}
+
+#endif // BUILDERS_QUADKEYCACHE_HPP_DEFINED
@@ -0,0 +1,87 @@
+#include "BoundingBox.hpp"
+#include "builders/QuadKeyPredictor.hpp"
+#include "utils/GeoUtils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+using namespace utymap;
+using namespace utymap::builders;
+using namespace utymap::utils;
+
+namespace {
+    // Amount of path samples per tile side, so path which crosses tile corner does not skip it.
+    const double SamplesPerTile = 4;
+    // Max amount of path samples, so very high speed does not make sampling endless.
+    const double MaxSamples = 1024;
+
+    bool contains(const std::vector<QuadKey>& quadKeys, const QuadKey& quadKey)
+    {
+        return std::find(quadKeys.begin(), quadKeys.end(), quadKey) != quadKeys.end();
+    }
+}
+
+const double QuadKeyPredictor::Horizon = 10;
+
+std::vector<QuadKey> QuadKeyPredictor::predict(const GeoCoordinate& position,
+                                               double latitudeSpeed,
+                                               double longitudeSpeed,
+                                               int levelOfDetail,
+                                               std::size_t budget)
+{
+    std::vector<QuadKey> quadKeys;
+    QuadKey current = GeoUtils::latLonToQuadKey(position, levelOfDetail);
+    BoundingBox bbox = GeoUtils::quadKeyToBoundingBox(current);
+    double width = bbox.maxPoint.longitude - bbox.minPoint.longitude;
+    double height = bbox.maxPoint.latitude - bbox.minPoint.latitude;
+
+    // NOTE non-finite speed is treated as no movement.
+    double speed = std::sqrt(latitudeSpeed * latitudeSpeed + longitudeSpeed * longitudeSpeed);
+    if (!std::isfinite(speed))
+        latitudeSpeed = longitudeSpeed = speed = 0;
+
+    // 1. extrapolate path.
+    if (speed > std::numeric_limits<double>::epsilon()) {
+        double step = std::min(width, height) / SamplesPerTile / speed;
+        int samples = static_cast<int>(std::min(Horizon / step, MaxSamples));
+        for (int i = 1; i <= samples && quadKeys.size() < budget; ++i) {
+            double time = step * i;
+            GeoCoordinate point(position.latitude + latitudeSpeed * time,
+                                position.longitude + longitudeSpeed * time);
+            QuadKey quadKey = GeoUtils::latLonToQuadKey(point, levelOfDetail);
+            if (!(quadKey == current) && !contains(quadKeys, quadKey))
+                quadKeys.push_back(quadKey);
+        }
+    }
+
+    // 2. add neighbours: the closer to movement direction, the earlier.
+    std::vector<std::pair<double, QuadKey>> neighbours;
+    int maxTile = (1 << levelOfDetail) - 1;
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            int tileX = current.tileX + dx;
+            int tileY = current.tileY + dy;
+            if ((dx == 0 && dy == 0) || tileX < 0 || tileY < 0 || tileX > maxTile || tileY > maxTile)
+                continue;
+
+            // NOTE tile y grows to south.
+            double alignment = dx * longitudeSpeed / width - dy * latitudeSpeed / height;
+            neighbours.push_back(std::make_pair(-alignment, QuadKey(levelOfDetail, tileX, tileY)));
+        }
+    }
+    std::stable_sort(neighbours.begin(), neighbours.end(),
+        [](const std::pair<double, QuadKey>& lhs, const std::pair<double, QuadKey>& rhs) {
+            return lhs.first < rhs.first;
+        });
+
+    for (const auto& neighbour : neighbours) {
+        if (quadKeys.size() >= budget)
+            break;
+        if (!contains(quadKeys, neighbour.second))
+            quadKeys.push_back(neighbour.second);
+    }
+
+    return quadKeys;
+}
@@ -0,0 +1,32 @@
+#ifndef BUILDERS_QUADKEYPREDICTOR_HPP_DEFINED
+#define BUILDERS_QUADKEYPREDICTOR_HPP_DEFINED
+
+#include "GeoCoordinate.hpp"
+#include "QuadKey.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace utymap { namespace builders {
+
+// Predicts quadkeys which are likely to be visited next by moving observer.
+class QuadKeyPredictor
+{
+public:
+    // Max time in seconds for which movement is extrapolated.
+    static const double Horizon;
+
+    // Returns up to budget quadkeys ordered by expected visit time: quadkeys on
+    // extrapolated path go first, then neighbours of current quadkey which are
+    // closer to movement direction. Current quadkey is never returned.
+    // Speed is given in degrees per second.
+    static std::vector<utymap::QuadKey> predict(const utymap::GeoCoordinate& position,
+                                                double latitudeSpeed,
+                                                double longitudeSpeed,
+                                                int levelOfDetail,
+                                                std::size_t budget);
+};
+
+}}
+
+#endif // BUILDERS_QUADKEYPREDICTOR_HPP_DEFINED
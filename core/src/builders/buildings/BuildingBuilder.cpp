@@ -42,6 +42,30 @@ namespace {
 
     const std::string MeshNamePrefix = "building:";
 
+    // Roof and facade types used to build footprint only.
+    const std::string FootprintRoofType = "none";
+    const std::string FootprintFacadeType = "flat";
+
+    // Ids of building tags and roof/facade style keys.
+    struct BuildingKeys
+    {
+        std::uint32_t building, multipolygon, roofType, roofHeight, roofColor,
+                      facadeType, facadeColor, height, minHeight;
+
+        BuildingKeys(StringTable& stringTable, const std::string& prefix) :
+            building(stringTable.getId(prefix + "building")),
+            multipolygon(stringTable.getId(prefix + "multipolygon")),
+            roofType(stringTable.getId(prefix + RoofTypeKey)),
+            roofHeight(stringTable.getId(prefix + RoofHeightKey)),
+            roofColor(stringTable.getId(prefix + RoofColorKey)),
+            facadeType(stringTable.getId(prefix + FacadeTypeKey)),
+            facadeColor(stringTable.getId(prefix + FacadeColorKey)),
+            height(stringTable.getId(prefix + HeightKey)),
+            minHeight(stringTable.getId(prefix + MinHeightKey))
+        {
+        }
+    };
+
     // Defines roof builder which does nothing.
     class EmptyRoofBuilder : public RoofBuilder {
     public:
@@ -156,8 +180,8 @@ namespace utymap { namespace builders {
 class BuildingBuilder::BuildingBuilderImpl : public ElementBuilder
 {
 public:
-    BuildingBuilderImpl(const utymap::builders::BuilderContext& context) :
-        ElementBuilder(context)
+    BuildingBuilderImpl(const utymap::builders::BuilderContext& context, bool footprintOnly) :
+        ElementBuilder(context), keys_(context.styleProvider.getKeys<BuildingKeys>()), footprintOnly_(footprintOnly)
     {
     }
 
@@ -234,12 +258,12 @@ private:
 
     inline bool isBuilding(const Style& style) const
     {
-        return *style.getString("building") == "true";
+        return *style.getString(keys_.building) == "true";
     }
 
     inline bool isMultipolygon(const Style& style) const
     {
-        return *style.getString("multipolygon") == "true";
+        return *style.getString(keys_.multipolygon) == "true";
     }
 
     void build(const Element& element, const Style& style)
@@ -248,31 +272,31 @@ private:
 
         auto geoCoordinate = GeoCoordinate(polygon_->points[1], polygon_->points[0]);
 
-        double height = style.getValue(HeightKey);
+        double height = style.getValue(keys_.height);
         // NOTE do not allow height to be zero. This might happen due to the issues in input osm data.
         if (height == 0)
             height = 10;
 
-        double minHeight = style.getValue(MinHeightKey);
+        double minHeight = style.getValue(keys_.minHeight);
 
         double elevation = context_.eleProvider.getElevation(geoCoordinate) + minHeight;
 
         height -= minHeight;
 
         // roof
-        auto roofType = style.getString(RoofTypeKey);
-        double roofHeight = style.getValue(RoofHeightKey);
-        auto roofGradient = GradientUtils::evaluateGradient(context_.styleProvider, meshContext.style, RoofColorKey);
-        auto roofBuilder = RoofBuilderFactoryMap.find(*roofType)->second(context_, meshContext);
+        std::string roofType = footprintOnly_ ? FootprintRoofType : *style.getString(keys_.roofType);
+        double roofHeight = style.getValue(keys_.roofHeight);
+        auto roofGradient = GradientUtils::evaluateGradient(context_.styleProvider, meshContext.style, keys_.roofColor);
+        auto roofBuilder = RoofBuilderFactoryMap.find(roofType)->second(context_, meshContext);
         roofBuilder->setHeight(roofHeight);
         roofBuilder->setMinHeight(elevation + height);
         roofBuilder->setColor(roofGradient, 0);
         roofBuilder->build(*polygon_);
 
         // facade
-        auto facadeType = style.getString(FacadeTypeKey);
-        auto facadeBuilder = FacadeBuilderFactoryMap.find(*facadeType)->second(context_, meshContext);
-        auto facadeGradient = GradientUtils::evaluateGradient(context_.styleProvider, meshContext.style, FacadeColorKey);
+        std::string facadeType = footprintOnly_ ? FootprintFacadeType : *style.getString(keys_.facadeType);
+        auto facadeBuilder = FacadeBuilderFactoryMap.find(facadeType)->second(context_, meshContext);
+        auto facadeGradient = GradientUtils::evaluateGradient(context_.styleProvider, meshContext.style, keys_.facadeColor);
         facadeBuilder->setHeight(height);
         facadeBuilder->setMinHeight(elevation);
         facadeBuilder->setColor(facadeGradient, 0);
@@ -281,12 +305,14 @@ private:
         polygon_.reset();
     }
 
+    const BuildingKeys& keys_;
+    const bool footprintOnly_;
     std::shared_ptr<Polygon> polygon_;
     std::shared_ptr<Mesh> mesh_;
 };
 
-BuildingBuilder::BuildingBuilder(const BuilderContext& context)
-    : ElementBuilder(context), pimpl_(new BuildingBuilder::BuildingBuilderImpl(context))
+BuildingBuilder::BuildingBuilder(const BuilderContext& context, bool footprintOnly)
+    : ElementBuilder(context), pimpl_(new BuildingBuilder::BuildingBuilderImpl(context, footprintOnly))
 {
 }
 
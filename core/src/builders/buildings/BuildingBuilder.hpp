@@ -12,7 +12,9 @@ namespace utymap { namespace builders {
 class BuildingBuilder : public utymap::builders::ElementBuilder
 {
 public:
-    BuildingBuilder(const utymap::builders::BuilderContext&);
+    // Creates builder. If footprint only is set, buildings are built as boxes with
+    // flat facades and without roofs, so they can be used as cheap placeholders.
+    BuildingBuilder(const utymap::builders::BuilderContext&, bool footprintOnly = false);
 
     ~BuildingBuilder();
 
@@ -23,6 +23,25 @@ namespace {
     const std::string MeshNamePrefix = "barrier:";
 }
 
+// Ids of barrier height, color and offset keys.
+struct BarrierBuilder::Keys
+{
+    std::uint32_t height, minHeight, color, offset;
+
+    Keys(utymap::index::StringTable& stringTable, const std::string& prefix) :
+        height(stringTable.getId(prefix + HeightKey)),
+        minHeight(stringTable.getId(prefix + MinHeightKey)),
+        color(stringTable.getId(prefix + ColorKey)),
+        offset(stringTable.getId(prefix + OffsetKey))
+    {
+    }
+};
+
+BarrierBuilder::BarrierBuilder(const BuilderContext& context) :
+    ElementBuilder(context), keys_(context.styleProvider.getKeys<Keys>())
+{
+}
+
 void BarrierBuilder::visitWay(const Way& way)
 {
     Style style = context_.styleProvider.forElement(way, context_.quadKey.levelOfDetail);
@@ -42,7 +61,7 @@ void BarrierBuilder::visitWay(const Way& way)
     offset.AddPath(path, JoinType::jtMiter, EndType::etOpenSquare);
 
     Paths solution;
-    double offsetInMeters = style.getValue(OffsetKey);
+    double offsetInMeters = style.getValue(keys_.offset);
     double offsetInGrads = GeoUtils::getOffset(way.coordinates[0], offsetInMeters);
     offset.Execute(solution, offsetInGrads * Scale);
     auto& shape = solution[0];
@@ -67,14 +86,14 @@ void BarrierBuilder::visitWay(const Way& way)
 
 void BarrierBuilder::buildFromPolygon(const Way& way, const Style& style, Polygon& polygon)
 {
-    double height = style.getValue(HeightKey);
-    double minHeight = style.getValue(MinHeightKey);
+    double height = style.getValue(keys_.height);
+    double minHeight = style.getValue(keys_.minHeight);
     double elevation = context_.eleProvider.getElevation(way.coordinates[0]) + minHeight;
 
     Mesh mesh(utymap::utils::getMeshName(MeshNamePrefix, way));
     MeshContext meshContext(mesh, style);
 
-    auto gradient = GradientUtils::evaluateGradient(context_.styleProvider, style, ColorKey);
+    auto gradient = GradientUtils::evaluateGradient(context_.styleProvider, style, keys_.color);
 
     // NOTE: Reuse building builders.
 
@@ -12,10 +12,7 @@ class BarrierBuilder : public ElementBuilder
 {
 
 public:
-    BarrierBuilder(const utymap::builders::BuilderContext& context)
-        : ElementBuilder(context)
-    {
-    }
+    BarrierBuilder(const utymap::builders::BuilderContext& context);
 
     void visitNode(const utymap::entities::Node& node) { }
 
@@ -28,9 +25,13 @@ public:
     void complete() { }
    
 private:
+    struct Keys;
+
     void buildFromPolygon(const utymap::entities::Way& way, 
                           const utymap::mapcss::Style& style,
                           utymap::meshing::Polygon& polygon);
+
+    const Keys& keys_;
 };
 
 }}
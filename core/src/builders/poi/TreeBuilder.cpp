@@ -25,13 +25,34 @@ namespace {
     const std::string TrunkHeight = "trunk-height";
 }
 
+// Ids of tree step and tree geometry keys.
+struct TreeBuilder::Keys
+{
+    std::uint32_t treeStep, foliageColor, trunkColor, foliageRadius, trunkRadius, trunkHeight;
+
+    Keys(utymap::index::StringTable& stringTable, const std::string& prefix) :
+        treeStep(stringTable.getId(prefix + TreeStepKey)),
+        foliageColor(stringTable.getId(prefix + FoliageColorKey)),
+        trunkColor(stringTable.getId(prefix + TrunkColorKey)),
+        foliageRadius(stringTable.getId(prefix + FoliageRadius)),
+        trunkRadius(stringTable.getId(prefix + TrunkRadius)),
+        trunkHeight(stringTable.getId(prefix + TrunkHeight))
+    {
+    }
+};
+
+TreeBuilder::TreeBuilder(const BuilderContext& context) :
+    ElementBuilder(context), keys_(context.styleProvider.getKeys<Keys>())
+{
+}
+
 void TreeBuilder::visitNode(const utymap::entities::Node& node)
 {
     Mesh mesh(utymap::utils::getMeshName(NodeMeshNamePrefix, node));
     Style style = context_.styleProvider.forElement(node, context_.quadKey.levelOfDetail);
     MeshContext meshContext(mesh, style);
 
-    TreeGenerator generator = createGenerator(context_, meshContext);
+    TreeGenerator generator = createGenerator(context_, meshContext, keys_);
 
     double elevation = context_.eleProvider.getElevation(node.coordinate);
     generator
@@ -48,11 +69,11 @@ void TreeBuilder::visitWay(const utymap::entities::Way& way)
     Style style = context_.styleProvider.forElement(way, context_.quadKey.levelOfDetail);
     MeshContext meshContext(treeMesh, style);
 
-    TreeBuilder::createGenerator(context_, meshContext)
+    createGenerator(context_, meshContext, keys_)
         .setPosition(Vector3(0, 0, 0)) // NOTE we will override coordinates later
         .generate();
 
-    double treeStepInMeters = style.getValue(TreeStepKey);
+    double treeStepInMeters = style.getValue(keys_.treeStep);
 
     for (std::size_t i = 0; i < way.coordinates.size() - 1; ++i) {
         const auto& p1 = way.coordinates[i];
@@ -80,20 +101,25 @@ void TreeBuilder::visitRelation(const utymap::entities::Relation& relation)
 }
 
 TreeGenerator TreeBuilder::createGenerator(const BuilderContext& builderContext, MeshContext& meshContext)
+{
+    return createGenerator(builderContext, meshContext, builderContext.styleProvider.getKeys<Keys>());
+}
+
+TreeGenerator TreeBuilder::createGenerator(const BuilderContext& builderContext, MeshContext& meshContext, const Keys& keys)
 {
     double relativeSize = builderContext.boundingBox.maxPoint.latitude - builderContext.boundingBox.minPoint.latitude;
     GeoCoordinate relativeCoordinate = builderContext.boundingBox.center();
 
-    double foliageRadiusInDegrees = meshContext.style.getValue(FoliageRadius, relativeSize, relativeCoordinate);
-    double foliageRadiusInMeters = meshContext.style.getValue(FoliageRadius, relativeSize);
+    double foliageRadiusInDegrees = meshContext.style.getValue(keys.foliageRadius, relativeSize, relativeCoordinate);
+    double foliageRadiusInMeters = meshContext.style.getValue(keys.foliageRadius, relativeSize);
 
-    auto foliageGradient = GradientUtils::evaluateGradient(builderContext.styleProvider, meshContext.style, FoliageColorKey);
-    auto trunkGradient = GradientUtils::evaluateGradient(builderContext.styleProvider, meshContext.style, TrunkColorKey);
+    auto foliageGradient = GradientUtils::evaluateGradient(builderContext.styleProvider, meshContext.style, keys.foliageColor);
+    auto trunkGradient = GradientUtils::evaluateGradient(builderContext.styleProvider, meshContext.style, keys.trunkColor);
 
     return TreeGenerator(builderContext, meshContext)
         .setFoliageColor(foliageGradient, 0)
         .setFoliageRadius(foliageRadiusInDegrees, foliageRadiusInMeters)
         .setTrunkColor(trunkGradient, 0)
-        .setTrunkRadius(meshContext.style.getValue(TrunkRadius, relativeSize, relativeCoordinate))
-        .setTrunkHeight(meshContext.style.getValue(TrunkHeight, relativeSize));
+        .setTrunkRadius(meshContext.style.getValue(keys.trunkRadius, relativeSize, relativeCoordinate))
+        .setTrunkHeight(meshContext.style.getValue(keys.trunkHeight, relativeSize));
 }
\ No newline at end of file
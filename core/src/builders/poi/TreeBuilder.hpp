@@ -17,10 +17,7 @@ class TreeBuilder : public utymap::builders::ElementBuilder
 {
 public:
 
-    TreeBuilder(const utymap::builders::BuilderContext& context) :
-                utymap::builders::ElementBuilder(context)
-    {
-    }
+    TreeBuilder(const utymap::builders::BuilderContext& context);
 
     void visitNode(const utymap::entities::Node& node);
 
@@ -35,6 +32,15 @@ public:
     // Creates tree generator which can be used to produce multiple trees inside mesh.
     static TreeGenerator createGenerator(const utymap::builders::BuilderContext& builderContext,
                                          utymap::builders::MeshContext& meshContext);
+
+private:
+    struct Keys;
+
+    static TreeGenerator createGenerator(const utymap::builders::BuilderContext& builderContext,
+                                         utymap::builders::MeshContext& meshContext,
+                                         const Keys& keys);
+
+    const Keys& keys_;
 };
 
 }}
@@ -0,0 +1,39 @@
+#include "builders/terrain/FlatTerraBuilder.hpp"
+#include "builders/terrain/TerraGenerator.hpp"
+#include "utils/GradientUtils.hpp"
+
+using namespace utymap::builders;
+using namespace utymap::mapcss;
+using namespace utymap::meshing;
+using namespace utymap::utils;
+
+namespace {
+    // NOTE should be the same as detailed terrain has, so it is replaced.
+    const std::string TerrainMeshName = "terrain";
+}
+
+void FlatTerraBuilder::complete()
+{
+    if (context_.cancelToken.isCancelled())
+        return;
+
+    Style style = context_.styleProvider.forCanvas(context_.quadKey.levelOfDetail);
+    const auto& keys = context_.styleProvider.getKeys<TerraGenerator::RegionKeys>();
+    const auto& bbox = context_.boundingBox;
+
+    Polygon polygon(4, 0);
+    polygon.addContour(std::vector<Vector2> {
+        Vector2(bbox.minPoint.longitude, bbox.minPoint.latitude),
+        Vector2(bbox.maxPoint.longitude, bbox.minPoint.latitude),
+        Vector2(bbox.maxPoint.longitude, bbox.maxPoint.latitude),
+        Vector2(bbox.minPoint.longitude, bbox.maxPoint.latitude)
+    });
+
+    // NOTE zero area disables refinement, zero noise gives flat solid color.
+    MeshBuilder::Options options(0, 0, 0, 0,
+        GradientUtils::evaluateGradient(context_.styleProvider, style, keys.gradient));
+
+    Mesh mesh(TerrainMeshName);
+    context_.meshBuilder.addPolygon(mesh, polygon, options);
+    context_.meshCallback(mesh);
+}
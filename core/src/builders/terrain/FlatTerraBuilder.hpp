@@ -0,0 +1,32 @@
+#ifndef BUILDERS_TERRAIN_FLATTERRABUILDER_HPP_DEFINED
+#define BUILDERS_TERRAIN_FLATTERRABUILDER_HPP_DEFINED
+
+#include "builders/BuilderContext.hpp"
+#include "builders/ElementBuilder.hpp"
+
+namespace utymap { namespace builders {
+
+// Builds terrain as single unrefined plane which covers quadkey and uses background
+// color. It is cheap, so it is used as placeholder until detailed terrain is built.
+class FlatTerraBuilder : public utymap::builders::ElementBuilder
+{
+public:
+    FlatTerraBuilder(const utymap::builders::BuilderContext& context)
+        : ElementBuilder(context)
+    {
+    }
+
+    void visitNode(const utymap::entities::Node&) { }
+
+    void visitWay(const utymap::entities::Way&) { }
+
+    void visitArea(const utymap::entities::Area&) { }
+
+    void visitRelation(const utymap::entities::Relation&) { }
+
+    void complete();
+};
+
+}}
+
+#endif // BUILDERS_TERRAIN_FLATTERRABUILDER_HPP_DEFINED
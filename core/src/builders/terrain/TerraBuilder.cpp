@@ -29,6 +29,18 @@ namespace {
     const static std::string TerrainLayerKey = "terrain-layer";
     const static std::string WidthKey = "width";
 
+    // Ids of terrain layer and width keys.
+    struct TerraBuilderKeys
+    {
+        std::uint32_t terrainLayer, width;
+
+        TerraBuilderKeys(StringTable& stringTable, const std::string& prefix) :
+            terrainLayer(stringTable.getId(prefix + TerrainLayerKey)),
+            width(stringTable.getId(prefix + WidthKey))
+        {
+        }
+    };
+
     // Converts coordinate to clipper's IntPoint.
     inline IntPoint toIntPoint(double x, double y)
     {
@@ -72,7 +84,8 @@ public:
         ElementBuilder(context), 
         style_(context.styleProvider.forCanvas(context.quadKey.levelOfDetail)), 
         clipper_(),
-        generator_(context, style_, clipper_)
+        generator_(context, style_, clipper_),
+        keys_(context.styleProvider.getKeys<TerraBuilderKeys>())
     {
         tileRect_.push_back(toIntPoint(context.boundingBox.minPoint.longitude, context.boundingBox.minPoint.latitude));
         tileRect_.push_back(toIntPoint(context.boundingBox.maxPoint.longitude, context.boundingBox.minPoint.latitude));
@@ -92,7 +105,7 @@ public:
         auto region = createRegion(style, way.coordinates);
 
         // make polygon from line by offsetting it using width specified
-        double width = style.getValue(WidthKey, 
+        double width = style.getValue(keys_.width, 
             context_.boundingBox.maxPoint.latitude - context_.boundingBox.minPoint.latitude,
             context_.boundingBox.center());
 
@@ -107,7 +120,7 @@ public:
 
         region->points = solution;
         std::string type = region->isLayer
-            ? *style.getString(TerrainLayerKey)
+            ? *style.getString(keys_.terrainLayer)
             : "";
         generator_.addRegion(type, region);
     }
@@ -117,7 +130,7 @@ public:
         Style style = context_.styleProvider.forElement(area, context_.quadKey.levelOfDetail);
         auto region = createRegion(style, area.coordinates);
         std::string type = region->isLayer
-            ? *style.getString(TerrainLayerKey)
+            ? *style.getString(keys_.terrainLayer)
             : "";
         generator_.addRegion(type, region);
     }
@@ -138,12 +151,12 @@ public:
 
         if (!region->points.empty()) {
             Style style = context_.styleProvider.forElement(rel, context_.quadKey.levelOfDetail);
-            region->isLayer = style.has(context_.stringTable.getId(TerrainLayerKey));
+            region->isLayer = style.has(keys_.terrainLayer);
             if (!region->isLayer)
-                region->context = std::make_shared<TerraGenerator::RegionContext>(generator_.createRegionContext(style, ""));
+                region->context = std::make_shared<TerraGenerator::RegionContext>(generator_.createRegionContext(style));
 
             std::string type = region->isLayer 
-                ? *style.getString(TerrainLayerKey)
+                ? *style.getString(keys_.terrainLayer)
                 : "";
             generator_.addRegion(type, region);
         }
@@ -168,9 +181,9 @@ private:
 
         region->points.push_back(path);
 
-        region->isLayer = style.has(context_.stringTable.getId(TerrainLayerKey));
+        region->isLayer = style.has(keys_.terrainLayer);
         if (!region->isLayer)
-            region->context = std::make_shared<TerraGenerator::RegionContext>(generator_.createRegionContext(style, ""));
+            region->context = std::make_shared<TerraGenerator::RegionContext>(generator_.createRegionContext(style));
 
         region->area = std::abs(utymap::utils::getArea(coordinates));
 
@@ -182,6 +195,7 @@ private:
     ClipperOffset offset_;
     TerraGenerator generator_;
     ClipperLib::Path tileRect_;
+    const TerraBuilderKeys& keys_;
 };
 
 void TerraBuilder::visitNode(const utymap::entities::Node& node) { pimpl_->visitNode(node); }
@@ -1,5 +1,6 @@
 #include "builders/terrain/TerraGenerator.hpp"
 #include "utils/GeoUtils.hpp"
+#include "utils/GradientUtils.hpp"
 
 #include <iterator>
 
@@ -29,6 +30,18 @@ namespace {
     const static std::string MeshExtrasKey = "mesh-extras";
     const static std::string GridCellSize = "grid-cell-size";
 
+    // Contains ids of canvas style keys used by generator.
+    struct TerraKeys
+    {
+        std::uint32_t layerPriority, gridCellSize;
+
+        TerraKeys(utymap::index::StringTable& stringTable, const std::string& prefix) :
+            layerPriority(stringTable.getId(prefix + LayerPriorityKey)),
+            gridCellSize(stringTable.getId(prefix + GridCellSize))
+        {
+        }
+    };
+
     const static std::unordered_map<std::string, TerraExtras::ExtrasFunc> ExtrasFuncs = 
     {
         { "forest", std::bind(&TerraExtras::addForest, _1, _2) },
@@ -36,12 +49,24 @@ namespace {
     };
 };
 
+TerraGenerator::RegionKeys::RegionKeys(utymap::index::StringTable& stringTable, const std::string& prefix) :
+    maxArea(stringTable.getId(prefix + MaxAreaKey)),
+    eleNoiseFreq(stringTable.getId(prefix + EleNoiseFreqKey)),
+    colorNoiseFreq(stringTable.getId(prefix + ColorNoiseFreqKey)),
+    heightOffset(stringTable.getId(prefix + HeightOffsetKey)),
+    gradient(stringTable.getId(prefix + GradientKey)),
+    meshName(stringTable.getId(prefix + MeshNameKey)),
+    meshExtras(stringTable.getId(prefix + MeshExtrasKey))
+{
+}
+
 TerraGenerator::TerraGenerator(const BuilderContext& context, const Style& style, ClipperEx& foregroundClipper) :
 context_(context), mesh_(TerrainMeshName), style_(style), foregroundClipper_(foregroundClipper), backGroundClipper_(),
         rect_(context.boundingBox.minPoint.longitude, 
               context.boundingBox.minPoint.latitude, 
               context.boundingBox.maxPoint.longitude, 
-              context.boundingBox.maxPoint.latitude)
+              context.boundingBox.maxPoint.latitude),
+        defaultKeys_(context.styleProvider.getKeys<RegionKeys>())
 {
 }
 
@@ -52,12 +77,16 @@ void TerraGenerator::addRegion(const std::string& type, std::shared_ptr<Region>&
 
 void TerraGenerator::generate(Path& tileRect)
 {
-    double size = style_.getValue(GridCellSize,
+    double size = style_.getValue(context_.styleProvider.getKeys<TerraKeys>().gridCellSize,
         context_.boundingBox.maxPoint.latitude - context_.boundingBox.minPoint.latitude, 
         context_.boundingBox.center());
     splitter_.setParams(Scale, size);
 
     buildLayers();
+    // NOTE mesh of cancelled build is incomplete.
+    if (context_.cancelToken.isCancelled())
+        return;
+
     buildBackground(tileRect);
 
     context_.meshCallback(mesh_);
@@ -67,20 +96,21 @@ void TerraGenerator::generate(Path& tileRect)
 void TerraGenerator::buildLayers()
 {
     // 1. process layers: regions with shared properties.
-    std::stringstream ss(*style_.getString(LayerPriorityKey));
-    while (ss.good()) {
+    std::stringstream ss(*style_.getString(context_.styleProvider.getKeys<TerraKeys>().layerPriority));
+    while (ss.good() && !context_.cancelToken.isCancelled()) {
         std::string name;
         getline(ss, name, ',');
         auto layer = layers_.find(name);
         if (layer != layers_.end()) {
-            buildFromRegions(layer->second, createRegionContext(style_, name + "-"));
+            buildFromRegions(layer->second,
+                createRegionContext(style_, context_.styleProvider.getKeys<RegionKeys>(name + "-")));
             layers_.erase(layer);
         }
     }
 
     // 2. Process the rest: each region has already its own properties.
     for (auto& layer : layers_)
-        while (!layer.second.empty()) {
+        while (!layer.second.empty() && !context_.cancelToken.isCancelled()) {
             auto& region = layer.second.top();
             buildFromPaths(region->points, *region->context);
             layer.second.pop();
@@ -96,19 +126,24 @@ void TerraGenerator::buildBackground(Path& tileRect)
     backGroundClipper_.Clear();
 
     if (!background.empty())
-        populateMesh(background, createRegionContext(style_, ""));
+        populateMesh(background, createRegionContext(style_));
+}
+
+TerraGenerator::RegionContext TerraGenerator::createRegionContext(const Style& style)
+{
+    return createRegionContext(style, defaultKeys_);
 }
 
-TerraGenerator::RegionContext TerraGenerator::createRegionContext(const Style& style, const std::string& prefix)
+TerraGenerator::RegionContext TerraGenerator::createRegionContext(const Style& style, const RegionKeys& keys)
 {
     double quadKeyWidth = context_.boundingBox.maxPoint.latitude - context_.boundingBox.minPoint.latitude;
 
-    return TerraGenerator::RegionContext(style, prefix, MeshBuilder::Options(
-        style.getValue(prefix + MaxAreaKey, quadKeyWidth * quadKeyWidth),
-        style.getValue(prefix + EleNoiseFreqKey, quadKeyWidth),
-        style.getValue(prefix + ColorNoiseFreqKey, quadKeyWidth),
-        style.getValue(prefix + HeightOffsetKey, quadKeyWidth),
-        context_.styleProvider.getGradient(*style.getString(prefix + GradientKey)),
+    return TerraGenerator::RegionContext(style, keys, MeshBuilder::Options(
+        style.getValue(keys.maxArea, quadKeyWidth * quadKeyWidth),
+        style.getValue(keys.eleNoiseFreq, quadKeyWidth),
+        style.getValue(keys.colorNoiseFreq, quadKeyWidth),
+        style.getValue(keys.heightOffset, quadKeyWidth),
+        GradientUtils::evaluateGradient(context_.styleProvider, style, keys.gradient),
         std::numeric_limits<double>::lowest(),
         /* no new vertices on boundaries */ 1));
 }
@@ -186,7 +221,7 @@ TerraGenerator::Points TerraGenerator::restorePoints(const Path& path)
 
 void TerraGenerator::fillMesh(Polygon& polygon, const RegionContext& regionContext)
 {
-    std::string meshName = *regionContext.style.getString(regionContext.prefix + MeshNameKey);
+    std::string meshName = *regionContext.style.getString(regionContext.keys.meshName);
     if (!meshName.empty()) {
         Mesh polygonMesh(meshName);
         TerraExtras::Context extrasContext(polygonMesh, regionContext.style);
@@ -205,7 +240,7 @@ void TerraGenerator::addExtrasIfNecessary(utymap::meshing::Mesh &mesh,
                                           TerraExtras::Context& extrasContext,
                                           const RegionContext& regionContext)
 {
-    std::string meshExtras = *regionContext.style.getString(regionContext.prefix + MeshExtrasKey);
+    std::string meshExtras = *regionContext.style.getString(regionContext.keys.meshExtras);
     if (meshExtras.empty())
         return;
 
@@ -9,7 +9,9 @@
 #include "meshing/MeshBuilder.hpp"
 #include "meshing/MeshTypes.hpp"
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <queue>
 #include <vector>
@@ -21,17 +23,32 @@ class TerraGenerator
 {
 public:
 
+    // Contains ids of region style keys which are prefixed by layer name in mapcss.
+    struct RegionKeys
+    {
+        std::uint32_t maxArea, eleNoiseFreq, colorNoiseFreq, heightOffset, gradient, meshName, meshExtras;
+
+        RegionKeys(utymap::index::StringTable& stringTable, const std::string& prefix);
+    };
+
     // Region context encapsulates information about given region.
     struct RegionContext
     {
+        // NOTE style borrows tags: region is built after element is released, so keep a copy.
+        const std::vector<utymap::entities::Tag> tags;
         const utymap::mapcss::Style style;
-        const std::string prefix;  // Prefix in mapcss.
+        const RegionKeys& keys;  // Keys with prefix in mapcss.
         const utymap::meshing::MeshBuilder::Options options;
 
         RegionContext(const utymap::mapcss::Style& style,
-                      const std::string& prefix,
+                      const RegionKeys& keys,
                       const utymap::meshing::MeshBuilder::Options& options) :
-            style(style), prefix(prefix), options(options)
+            tags(style.tags()), style(style, tags), keys(keys), options(options)
+        {
+        }
+
+        RegionContext(const RegionContext& other) :
+            tags(other.tags), style(other.style, tags), keys(other.keys), options(other.options)
         {
         }
     };
@@ -60,9 +77,8 @@ public:
     // Generates mesh and calls callback from context.
     void generate(ClipperLib::Path& tileRect);
 
-    // Creates region  context.
-    RegionContext createRegionContext(const utymap::mapcss::Style& style,
-                                      const std::string& prefix);
+    // Creates region context using keys without prefix.
+    RegionContext createRegionContext(const utymap::mapcss::Style& style);
 
 private:
     typedef std::shared_ptr<Region> RegionPtr;
@@ -86,6 +102,8 @@ private:
     // Builds background as clip area of layers
     void buildBackground(ClipperLib::Path& tileRect);
 
+    RegionContext createRegionContext(const utymap::mapcss::Style& style, const RegionKeys& keys);
+
     void buildFromRegions(Regions& regions, const RegionContext& regionContext);
 
     void buildFromPaths(const ClipperLib::Paths& paths, const RegionContext& regionContext);
@@ -111,6 +129,7 @@ private:
     utymap::meshing::Mesh mesh_;
     Layers layers_;
     utymap::meshing::Rectangle rect_;
+    const RegionKeys& defaultKeys_;
 };
 
 }}
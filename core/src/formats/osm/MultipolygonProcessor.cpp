@@ -1,3 +1,4 @@
+#include "BoundingBox.hpp"
 #include "entities/Node.hpp"
 #include "entities/Way.hpp"
 #include "entities/Area.hpp"
@@ -9,83 +10,90 @@
 #include "utils/GeometryUtils.hpp"
 
 #include <algorithm>
+#include <deque>
+#include <limits>
+#include <queue>
 
 using namespace utymap;
 using namespace utymap::entities;
 using namespace utymap::formats;
 using namespace utymap::index;
 
-typedef std::deque<GeoCoordinate> Coords;
+typedef std::vector<GeoCoordinate> Coords;
 typedef std::vector<int> Ints;
 
+namespace {
+
+    // Hashes coordinate by its exact value: way ends are shared nodes, so they are equal bitwise.
+    struct GeoCoordinateHash
+    {
+        std::size_t operator()(const GeoCoordinate& coordinate) const
+        {
+            std::hash<double> hasher;
+            return hasher(coordinate.latitude) ^ (hasher(coordinate.longitude) << 1);
+        }
+    };
+
+    // Maps sequence end coordinate to indices of sequences which start or end there.
+    typedef std::unordered_map<GeoCoordinate, std::vector<std::size_t>, GeoCoordinateHash> EndpointMap;
+
+    // Specifies part of ring: sequence index and traversal direction.
+    typedef std::pair<std::size_t, bool> RingPart;
+
+    // Returns the lowest index of unused sequence which has an end at given coordinate.
+    std::size_t findSequence(const EndpointMap& endpoints, const GeoCoordinate& coordinate, const std::vector<bool>& used)
+    {
+        auto candidates = endpoints.find(coordinate);
+        if (candidates != endpoints.end()) {
+            for (auto index : candidates->second) {
+                if (!used[index])
+                    return index;
+            }
+        }
+        return std::numeric_limits<std::size_t>::max();
+    }
+
+    // Checks whether one bounding box is inside another one including their borders.
+    inline bool containsBox(const BoundingBox& outer, const BoundingBox& inner)
+    {
+        return inner.minPoint.latitude >= outer.minPoint.latitude && inner.minPoint.longitude >= outer.minPoint.longitude &&
+               inner.maxPoint.latitude <= outer.maxPoint.latitude && inner.maxPoint.longitude <= outer.maxPoint.longitude;
+    }
+}
 
 struct MultipolygonProcessor::CoordinateSequence
 {
     std::uint64_t id;
     Coords coordinates;
+    BoundingBox bbox;
 
     CoordinateSequence(std::uint64_t id, const Coordinates& coordinates) :
         id(id), coordinates(coordinates.begin(), coordinates.end())
     {
+        bbox.expand(coordinates.begin(), coordinates.end());
     }
 
-    // Tries to add another sequence onto the start or end of this one.
-    // If it succeeds, the other sequence may also be modified and
-    // should be considered "spent".
-    bool tryAdd(CoordinateSequence& other)
+    CoordinateSequence(std::uint64_t id, Coords&& coordinates, const BoundingBox& bbox) :
+        id(id), coordinates(std::move(coordinates)), bbox(bbox)
     {
-        //add the sequence at the end
-        if (last() == other.first()) {
-            coordinates.pop_back();
-            addToEnd(other.coordinates);
-            return true;
-        }
-        //add the sequence backwards at the end
-        if (last() == other.last()) {
-            coordinates.pop_back();
-            other.reverse();
-            addToEnd(other.coordinates);
-            return true;
-        }
-        //add the sequence at the beginning
-        if (first() == other.last()) {
-            coordinates.pop_front();
-            addToBegin(other.coordinates);
-            return true;
-        }
-        //add the sequence backwards at the beginning
-        if (first() == other.first()) {
-            coordinates.pop_front();
-            other.reverse();
-            addToBegin(other.coordinates);
-            return true;
-        }
-        return false;
     }
 
-    inline bool isClosed() 
-    { 
+    inline bool isClosed() const
+    {
         return coordinates.size() > 1 && coordinates[0] == coordinates[coordinates.size() - 1]; 
     }
 
-    inline bool containsRing(const Coords& other) const
+    // Checks whether other ring is inside this one. Rings are not supposed to intersect,
+    // so bounding box check followed by testing one vertex is enough.
+    inline bool containsRing(const CoordinateSequence& other) const
     {
-        return std::all_of(other.begin(), other.end(), [&](const GeoCoordinate& c) {
-            return utymap::utils::GeoUtils::isPointInPolygon(c, coordinates.begin(), coordinates.end());
-        });
+        return containsBox(bbox, other.bbox) &&
+               utymap::utils::GeoUtils::isPointInPolygon(other.coordinates[0], coordinates.begin(), coordinates.end());
     }
 
-private:
+    inline const GeoCoordinate& first() const { return coordinates[0]; }
 
-    inline GeoCoordinate first() const { return coordinates[0]; }
-
-    inline GeoCoordinate last() const { return coordinates[coordinates.size() - 1]; }
-
-    inline void addToBegin(const Coords& other) { coordinates.insert(coordinates.begin(), other.begin(), other.end()); }
-
-    inline void addToEnd(const Coords& other) { coordinates.insert(coordinates.end(), other.begin(), other.end()); }
-
-    inline void reverse() { std::reverse(coordinates.begin(), coordinates.end()); }
+    inline const GeoCoordinate& last() const { return coordinates[coordinates.size() - 1]; }
 };
 
 
@@ -186,35 +194,68 @@ void MultipolygonProcessor::complexCase(CoordinateSequences& sequences)
 
 std::vector<std::shared_ptr<MultipolygonProcessor::CoordinateSequence>> MultipolygonProcessor::createRings(CoordinateSequences& sequences)
 {
+    EndpointMap endpoints;
+    endpoints.reserve(sequences.size() * 2);
+    for (std::size_t i = 0; i < sequences.size(); ++i) {
+        endpoints[sequences[i]->first()].push_back(i);
+        endpoints[sequences[i]->last()].push_back(i);
+    }
+
+    const auto noIndex = std::numeric_limits<std::size_t>::max();
+    std::vector<bool> used(sequences.size(), false);
     CoordinateSequences closedRings;
-    std::shared_ptr<MultipolygonProcessor::CoordinateSequence> currentRing = nullptr;
-    while (!sequences.empty()) {
-        if (currentRing == nullptr) {
-            // start a new ring with any remaining node sequence
-            auto lastIndex = sequences.size() - 1;
-            currentRing = sequences[lastIndex];
-            sequences.erase(sequences.begin() + lastIndex);
-        }
-        else {
-            // try to continue the ring by appending a node sequence
-            bool isFound = false;
-            for (auto it = sequences.begin(); it != sequences.end(); ++it) {
-                if (!currentRing->tryAdd(**it)) continue;
-                isFound = true;
-                sequences.erase(it);
-                break;
-            }
 
-            if (!isFound) 
+    // start a new ring with any remaining node sequence
+    for (std::size_t start = sequences.size(); start-- > 0;) {
+        if (used[start]) continue;
+        used[start] = true;
+
+        std::deque<RingPart> parts { RingPart(start, false) };
+        GeoCoordinate head = sequences[start]->first();
+        GeoCoordinate tail = sequences[start]->last();
+        BoundingBox bbox = sequences[start]->bbox;
+        std::size_t size = sequences[start]->coordinates.size();
+
+        // try to continue the ring by appending a node sequence
+        while (!(size > 1 && head == tail)) {
+            auto tailIndex = findSequence(endpoints, tail, used);
+            auto headIndex = findSequence(endpoints, head, used);
+            if (tailIndex == noIndex && headIndex == noIndex)
                 return CoordinateSequences();
+
+            if (tailIndex <= headIndex) {
+                const auto& other = *sequences[tailIndex];
+                bool isReversed = !(tail == other.first());
+                tail = isReversed ? other.first() : other.last();
+                parts.push_back(RingPart(tailIndex, isReversed));
+                used[tailIndex] = true;
+                bbox.expand(other.bbox);
+                size += other.coordinates.size() - 1;
+            }
+            else {
+                const auto& other = *sequences[headIndex];
+                bool isReversed = !(head == other.last());
+                head = isReversed ? other.last() : other.first();
+                parts.push_front(RingPart(headIndex, isReversed));
+                used[headIndex] = true;
+                bbox.expand(other.bbox);
+                size += other.coordinates.size() - 1;
+            }
         }
 
-        // check whether the ring under construction is closed
-        if (currentRing != nullptr && currentRing->isClosed()) {
-            // TODO check that it isn't self-intersecting!
-            closedRings.push_back(std::make_shared<CoordinateSequence>(*currentRing));
-            currentRing = nullptr;
+        // the ring is closed: copy its coordinates only once
+        // TODO check that it isn't self-intersecting!
+        Coords coordinates;
+        coordinates.reserve(size);
+        for (const auto& part : parts) {
+            const auto& source = sequences[part.first]->coordinates;
+            std::size_t skip = coordinates.empty() ? 0 : 1;
+            if (part.second)
+                coordinates.insert(coordinates.end(), source.rbegin() + skip, source.rend());
+            else
+                coordinates.insert(coordinates.end(), source.begin() + skip, source.end());
         }
+        closedRings.push_back(std::make_shared<CoordinateSequence>(sequences[start]->id, std::move(coordinates), bbox));
     }
 
     return std::move(closedRings);
@@ -222,59 +263,66 @@ std::vector<std::shared_ptr<MultipolygonProcessor::CoordinateSequence>> Multipol
 
 void MultipolygonProcessor::fillRelation(CoordinateSequences& rings)
 {
-    while (!rings.empty()) {
-        // find an outer ring
-        std::shared_ptr<CoordinateSequence> outer = nullptr;
-        for (auto candidate = rings.begin(); candidate != rings.end(); ++candidate) {
-            bool containedInOtherRings = false;
-            for (auto other = rings.begin(); other != rings.end(); ++other) {
-                if (other != candidate && (*other)->containsRing((*candidate)->coordinates)) {
-                    containedInOtherRings = true;
-                    break;
-                }
+    // build containment graph once: for every ring, the rings which contain it and which it contains
+    std::vector<std::vector<std::size_t>> containees(rings.size());
+    std::vector<std::size_t> containers(rings.size(), 0);
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        for (std::size_t j = 0; j < rings.size(); ++j) {
+            if (i != j && rings[j]->containsRing(*rings[i])) {
+                containees[j].push_back(i);
+                ++containers[i];
             }
-            if (containedInOtherRings) continue;
-            outer = *candidate;
-            rings.erase(candidate);
-            break;
         }
+    }
 
-        // find inner rings of that ring
-        CoordinateSequences inners;
-        for (auto ring = rings.begin(); ring != rings.end();) {
-            if (outer->containsRing((*ring)->coordinates)) {
-                bool containedInOthers = false;
-                for (auto other = rings.begin(); other != rings.end(); ++other) {
-                    if (other != ring && (*other)->containsRing((*ring)->coordinates)) {
-                        containedInOthers = true;
-                        break;
-                    }
-                }
-                if (!containedInOthers) {
-                    inners.push_back(*ring);
-                    ring = rings.erase(ring);
-                    continue;
-                }
-            }
-            ++ring;
+    std::vector<bool> used(rings.size(), false);
+    std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<std::size_t>> candidates;
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        if (containers[i] == 0)
+            candidates.push(i);
+    }
+
+    auto remove = [&](std::size_t index) {
+        used[index] = true;
+        for (auto containee : containees[index]) {
+            if (--containers[containee] == 0 && !used[containee])
+                candidates.push(containee);
+        }
+    };
+
+    while (!candidates.empty()) {
+        // find an outer ring: it is not contained in any of remaining rings
+        auto outerIndex = candidates.top();
+        candidates.pop();
+        if (used[outerIndex]) continue;
+        remove(outerIndex);
+
+        // find inner rings of that ring: they are contained only in the outer one
+        Ints inners;
+        for (auto containee : containees[outerIndex]) {
+            if (!used[containee] && containers[containee] == 0)
+                inners.push_back(static_cast<int>(containee));
         }
+        for (auto inner : inners)
+            remove(inner);
 
         // outer
+        const auto& outer = rings[outerIndex];
         auto outerArea = std::make_shared<Area>();
         outerArea->id = outer->id;
         insertCoordinates(outer->coordinates, outerArea->coordinates, true);
         relation_.elements.push_back(outerArea);
 
-        // inner: create a new area and remove the used rings
-        for (const auto& innerRing : inners) {
+        // inner: create a new area
+        for (auto inner : inners) {
             auto innerArea = std::make_shared<Area>();
-            insertCoordinates(innerRing->coordinates, innerArea->coordinates, false);
+            insertCoordinates(rings[inner]->coordinates, innerArea->coordinates, false);
             relation_.elements.push_back(innerArea);
         }
     }
 }
 
-void MultipolygonProcessor::insertCoordinates(const std::deque<GeoCoordinate>& source, std::vector<GeoCoordinate>& destination, bool isOuter) const
+void MultipolygonProcessor::insertCoordinates(const std::vector<GeoCoordinate>& source, std::vector<GeoCoordinate>& destination, bool isOuter) const
 {
     bool isClockwise = utymap::utils::isClockwise(source);
     if ((isOuter && isClockwise) || (!isOuter && !isClockwise))
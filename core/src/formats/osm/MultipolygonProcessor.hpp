@@ -6,10 +6,10 @@
 #include "formats/osm/OsmDataContext.hpp"
 #include "index/StringTable.hpp"
 
-#include <deque>
 #include <functional>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace utymap { namespace formats {
 
@@ -44,7 +44,7 @@ private:
 
     void fillRelation(CoordinateSequences& rings);
 
-    void insertCoordinates(const std::deque<GeoCoordinate>& source, 
+    void insertCoordinates(const std::vector<GeoCoordinate>& source, 
                            std::vector<GeoCoordinate>& destination, 
                            bool isOuter) const;
 
@@ -3,6 +3,7 @@
 
 #include "heightmap/ElevationProvider.hpp"
 
+#include <atomic>
 #include <cstdio>
 #include <cstdint>
 #include <cmath>
@@ -12,7 +13,9 @@
 #include <stdexcept>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <iomanip>
+#include <vector>
 
 namespace utymap { namespace heightmap {
 
@@ -43,23 +46,32 @@ class SrtmElevationProvider : public ElevationProvider
             offset((totalPx * totalPx - totalPx) * 2), data(data), size(size)
         {
         }
+
+        ~HgtCell()
+        {
+            delete[] data;
+        }
+
+        HgtCell(const HgtCell&) = delete;
+        HgtCell& operator=(const HgtCell&) = delete;
     };
 
-    typedef std::shared_ptr<HgtCell> CellPtr;
+    typedef std::shared_ptr<const HgtCell> CellPtr;
+    typedef std::map<HgtCellKey, CellPtr> CellMap;
 
 public:
 
     SrtmElevationProvider(std::string dataDirectory, int maxCacheSize = 4):
         dataDirectory_(dataDirectory), maxCacheSize_(maxCacheSize)
     {
+        snapshots_.push_back(std::unique_ptr<const CellMap>(new CellMap()));
+        cells_.store(snapshots_.back().get());
     }
 
-    ~SrtmElevationProvider()
-    {
-        for (const auto& pair : cells_)
-            delete pair.second->data;
-    }
-
+    // Loads cells which intersect bounding box. Can be called while elevation is read:
+    // loaded cells are published as new snapshot of cell map. NOTE loaded cells are never
+    // released, so memory grows with amount of visited cells (up to 25MB per SRTM-1 cell)
+    // and each snapshot copies pointers to all cells loaded before.
     void preload(const utymap::BoundingBox& bbox)
     {
         int minLat = (int)bbox.minPoint.latitude;
@@ -71,18 +83,26 @@ public:
         int latDiff = maxLat - minLat;
         int lonDiff = maxLon - minLon;
 
+        std::lock_guard<std::mutex> lock(preloadLock_);
+        std::unique_ptr<CellMap> cells;
         for (int j = 0; j <= latDiff; j++)
             for (int i = 0; i <= lonDiff; i++) {
                 HgtCellKey cellKey(minLat + j, minLon + i);
 
-                if (cells_.find(cellKey) != cells_.end()) 
+                if (getCell(cellKey) != nullptr)
                     continue;
 
-                std::string path = getFilePath(cellKey);
-                CellPtr cell = readCell(path);
-                // TODO limit loaded cells.
-                cells_[cellKey] = cell;
+                if (cells == nullptr)
+                    cells.reset(new CellMap(*cells_.load()));
+
+                cells->insert(std::make_pair(cellKey, readCell(getFilePath(cellKey))));
             }
+
+        if (cells == nullptr)
+            return;
+
+        cells_.store(cells.get(), std::memory_order_release);
+        snapshots_.push_back(std::move(cells));
     }
 
     double getElevation(const utymap::GeoCoordinate& coordinate) const { return getElevationImpl(coordinate.latitude, coordinate.longitude); };
@@ -99,7 +119,7 @@ private:
         double secondsLat = (latitude - latDec) * 3600;
         double secondsLon = (longitude - lonDec) * 3600;
 
-        auto cell = cells_.find(HgtCellKey(latDec, lonDec))->second;
+        const HgtCell* cell = getCell(HgtCellKey(latDec, lonDec));
 
         // load tile
         //X coresponds to x/y values,
@@ -117,10 +137,10 @@ private:
         int x = (int)(secondsLon / cell->secondsPerPx);
 
         //get norther and easter points
-        int height2 = readPx(cell, y, x);
-        int height0 = readPx(cell, y + 1, x);
-        int height3 = readPx(cell, y, x + 1);
-        int height1 = readPx(cell, y + 1, x + 1);
+        int height2 = readPx(*cell, y, x);
+        int height0 = readPx(*cell, y + 1, x);
+        int height3 = readPx(*cell, y, x + 1);
+        int height1 = readPx(*cell, y + 1, x + 1);
 
         //ratio where X lays
         double dy = std::fmod(secondsLat, cell->secondsPerPx) / cell->secondsPerPx;
@@ -138,12 +158,21 @@ private:
         return height0*dy*(1 - dx) + height1*dy*(dx)+height2*(1 - dy)*(1 - dx) + height3*(1 - dy)*dx;
     }
 
-    inline int readPx(CellPtr cell, int y, int x) const
+    // NOTE cells can be preloaded by another thread, so current snapshot is read
+    // without locking. Returned cell is alive as snapshots are not released.
+    inline const HgtCell* getCell(const HgtCellKey& key) const
+    {
+        const CellMap& cells = *cells_.load(std::memory_order_acquire);
+        auto pair = cells.find(key);
+        return pair != cells.end() ? pair->second.get() : nullptr;
+    }
+
+    inline int readPx(const HgtCell& cell, int y, int x) const
     {
-        int pos = cell->offset + 2 * (x - cell->totalPx*y);
+        int pos = cell.offset + 2 * (x - cell.totalPx*y);
         // TODO ensure that it works on all platforms
-        return *((cell->data + pos)) << 8 |
-               *((cell->data + pos + 1));
+        return *((cell.data + pos)) << 8 |
+               *((cell.data + pos + 1));
     }
 
     inline CellPtr readCell(const std::string& path) const
@@ -189,7 +218,10 @@ private:
         return stream.str();
     }
 
-    std::map<HgtCellKey, CellPtr> cells_;
+    // NOTE previous snapshots are kept as they can be still read by another thread.
+    std::vector<std::unique_ptr<const CellMap>> snapshots_;
+    std::atomic<const CellMap*> cells_;
+    std::mutex preloadLock_;
     std::string dataDirectory_;
     int maxCacheSize_;
 };
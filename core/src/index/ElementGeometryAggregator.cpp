@@ -0,0 +1,360 @@
+#include "clipper/clipper.hpp"
+#include "GeoCoordinate.hpp"
+#include "QuadKey.hpp"
+#include "entities/Node.hpp"
+#include "entities/Way.hpp"
+#include "entities/Area.hpp"
+#include "entities/Relation.hpp"
+#include "index/ElementGeometryAggregator.hpp"
+#include "utils/GeometryUtils.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+using namespace utymap;
+using namespace utymap::entities;
+using namespace utymap::index;
+
+namespace {
+    // Max precision for Lat/Lon
+    const double Scale = 1E7;
+
+    // Tile size in pixels used to detect sub-pixel areas.
+    const double TileSize = 256;
+
+    // Represents single area collected for aggregation.
+    struct Part
+    {
+        ClipperLib::Path path;
+        std::vector<Tag> tags;
+        double area;
+    };
+
+    // Represents all areas of one class inside one tile.
+    struct Group
+    {
+        double distance;
+        std::vector<Part> parts;
+        // Offsets of parts spilled to temporary file.
+        std::vector<long> spilled;
+    };
+
+    //                                      Spilled part format
+    //------------------------------------------------------------------------------------------------------|
+    //   DESCRIPTION    |                       DETAILS                                                     |
+    //------------------------------------------------------------------------------------------------------|
+    //      Path        |  Point count (4b), each point is x (8b) and y (8b)                                |
+    //------------------------------------------------------------------------------------------------------|
+    //      Tags        |  Tag count (4b), each tag is key (4b) and value (4b)                              |
+    //------------------------------------------------------------------------------------------------------|
+    //      Area        |  Area of path (8b)                                                                |
+    //------------------------------------------------------------------------------------------------------|
+
+    // Gets approximate amount of memory used by part.
+    std::size_t getSize(const Part& part)
+    {
+        return sizeof(Part) + part.path.size() * sizeof(ClipperLib::IntPoint) + part.tags.size() * sizeof(Tag);
+    }
+
+    struct QuadKeyComparator
+    {
+        bool operator() (const QuadKey& lhs, const QuadKey& rhs) const
+        {
+            return std::tie(lhs.levelOfDetail, lhs.tileX, lhs.tileY) <
+                   std::tie(rhs.levelOfDetail, rhs.tileX, rhs.tileY);
+        }
+    };
+
+    typedef std::map<QuadKey, std::map<std::string, Group>, QuadKeyComparator> GroupMap;
+
+    // Collects area parts of element.
+    class PartCollector : public ElementVisitor
+    {
+    public:
+        std::vector<Part> parts;
+        bool hasOtherGeometry = false;
+
+        void visitNode(const Node&) { hasOtherGeometry = true; }
+
+        void visitWay(const Way&) { hasOtherGeometry = true; }
+
+        void visitArea(const Area& area)
+        {
+            if (area.coordinates.size() < 3)
+                return;
+
+            Part part;
+            part.tags = area.tags;
+            part.path.reserve(area.coordinates.size());
+            for (const auto& coordinate : area.coordinates) {
+                part.path.push_back(ClipperLib::IntPoint(
+                    static_cast<ClipperLib::cInt>(coordinate.longitude * Scale),
+                    static_cast<ClipperLib::cInt>(coordinate.latitude * Scale)));
+            }
+            // NOTE offset treats paths with negative orientation as holes.
+            if (!ClipperLib::Orientation(part.path))
+                std::reverse(part.path.begin(), part.path.end());
+            part.area = ClipperLib::Area(part.path);
+            parts.push_back(std::move(part));
+        }
+
+        void visitRelation(const Relation& relation)
+        {
+            for (const auto& element : relation.elements) {
+                // NOTE members of relation may have no tags.
+                auto size = parts.size();
+                element->accept(*this);
+                for (auto i = size; i < parts.size(); ++i) {
+                    if (parts[i].tags.empty())
+                        parts[i].tags = relation.tags;
+                }
+            }
+        }
+    };
+}
+
+class ElementGeometryAggregator::ElementGeometryAggregatorImpl
+{
+public:
+    ElementGeometryAggregatorImpl(std::size_t memoryBudget) :
+        memoryBudget_(memoryBudget), memorySize_(0), spillFile_(nullptr, &std::fclose)
+    {
+    }
+
+    bool add(const Element& element, const QuadKey& quadKey, const std::string& className, double distance)
+    {
+        PartCollector collector;
+        element.accept(collector);
+        if (collector.hasOtherGeometry || collector.parts.empty())
+            return false;
+
+        std::lock_guard<std::mutex> lock(lock_);
+        auto& group = groups_[quadKey][className];
+        group.distance = distance;
+        for (auto& part : collector.parts) {
+            memorySize_ += getSize(part);
+            group.parts.push_back(std::move(part));
+        }
+
+        if (memorySize_ > memoryBudget_)
+            spill();
+
+        return true;
+    }
+
+    void flush(const Callback& callback)
+    {
+        GroupMap groups;
+        SpillFile spillFile(nullptr, &std::fclose);
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            std::swap(groups, groups_);
+            std::swap(spillFile, spillFile_);
+            memorySize_ = 0;
+        }
+
+        for (auto& quadKeyGroups : groups) {
+            double pixelSize = 360. / (1 << quadKeyGroups.first.levelOfDetail) / TileSize * Scale;
+            for (auto& classGroup : quadKeyGroups.second) {
+                // NOTE only one group is read back into memory at once.
+                restore(spillFile.get(), classGroup.second);
+                flush(quadKeyGroups.first, classGroup.second, pixelSize * pixelSize, callback);
+                std::vector<Part>().swap(classGroup.second.parts);
+            }
+        }
+    }
+
+private:
+    typedef std::unique_ptr<std::FILE, int(*)(std::FILE*)> SpillFile;
+
+    // Moves all collected parts to temporary file. Should be called under lock.
+    void spill()
+    {
+        if (spillFile_ == nullptr) {
+            spillFile_.reset(std::tmpfile());
+            if (spillFile_ == nullptr)
+                throw std::domain_error("Cannot create aggregation spill file.");
+        }
+
+        std::FILE* file = spillFile_.get();
+        std::fseek(file, 0, SEEK_END);
+        for (auto& quadKeyGroups : groups_) {
+            for (auto& classGroup : quadKeyGroups.second) {
+                auto& group = classGroup.second;
+                for (const auto& part : group.parts) {
+                    group.spilled.push_back(std::ftell(file));
+                    write(file, static_cast<std::uint32_t>(part.path.size()));
+                    std::fwrite(part.path.data(), sizeof(ClipperLib::IntPoint), part.path.size(), file);
+                    write(file, static_cast<std::uint32_t>(part.tags.size()));
+                    std::fwrite(part.tags.data(), sizeof(Tag), part.tags.size(), file);
+                    write(file, part.area);
+                }
+                std::vector<Part>().swap(group.parts);
+            }
+        }
+        memorySize_ = 0;
+    }
+
+    // Reads spilled parts of group back.
+    void restore(std::FILE* file, Group& group)
+    {
+        for (long offset : group.spilled) {
+            std::uint32_t size;
+            Part part;
+            std::fseek(file, offset, SEEK_SET);
+            read(file, size);
+            part.path.resize(size);
+            read(file, part.path.data(), size);
+            read(file, size);
+            part.tags.resize(size);
+            read(file, part.tags.data(), size);
+            read(file, part.area);
+            group.parts.push_back(std::move(part));
+        }
+        std::vector<long>().swap(group.spilled);
+    }
+
+    template <typename T>
+    static void write(std::FILE* file, const T& value)
+    {
+        std::fwrite(&value, sizeof(T), 1, file);
+    }
+
+    template <typename T>
+    static void read(std::FILE* file, T& value)
+    {
+        read(file, &value, 1);
+    }
+
+    template <typename T>
+    static void read(std::FILE* file, T* values, std::size_t count)
+    {
+        if (count > 0 && std::fread(values, sizeof(T), count, file) != count)
+            throw std::domain_error("Cannot read aggregation spill file.");
+    }
+
+    void flush(const QuadKey& quadKey, Group& group, double minArea, const Callback& callback)
+    {
+        // NOTE parts are added concurrently: sort them to have the same result for the same input.
+        std::sort(group.parts.begin(), group.parts.end(), lessPart);
+
+        ClipperLib::Paths paths;
+        paths.reserve(group.parts.size());
+        for (const auto& part : group.parts)
+            paths.push_back(part.path);
+
+        // merge areas closer than distance: expand, union and shrink back.
+        ClipperLib::Paths solution;
+        double delta = group.distance * Scale / 2;
+        if (delta > 0) {
+            ClipperLib::Paths expanded;
+            ClipperLib::ClipperOffset offset;
+            offset.AddPaths(paths, ClipperLib::jtMiter, ClipperLib::etClosedPolygon);
+            offset.Execute(expanded, delta);
+            offset.Clear();
+            offset.AddPaths(expanded, ClipperLib::jtMiter, ClipperLib::etClosedPolygon);
+            offset.Execute(solution, -delta);
+        }
+        else {
+            ClipperLib::Clipper clipper;
+            clipper.AddPaths(paths, ClipperLib::ptSubject, true);
+            clipper.Execute(ClipperLib::ctUnion, solution, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        }
+
+        // parts ordered by area: the largest one goes first.
+        std::vector<std::size_t> order(group.parts.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) {
+            return group.parts[lhs].area > group.parts[rhs].area;
+        });
+
+        for (const auto& path : solution) {
+            // NOTE holes are dropped: blocks are filled at overview levels of details.
+            if (!ClipperLib::Orientation(path) || ClipperLib::Area(path) < minArea)
+                continue;
+
+            Area area;
+            area.id = 0;
+            area.tags = getTags(group.parts, order, path);
+            area.coordinates.reserve(path.size());
+            for (const auto& point : path)
+                area.coordinates.push_back(GeoCoordinate(point.Y / Scale, point.X / Scale));
+
+            if (!utymap::utils::isClockwise(area.coordinates))
+                std::reverse(area.coordinates.begin(), area.coordinates.end());
+
+            callback(area, quadKey);
+        }
+    }
+
+    // Defines total order of parts: by first point, area, the rest of path and tags.
+    static bool lessPart(const Part& lhs, const Part& rhs)
+    {
+        if (std::tie(lhs.path[0].X, lhs.path[0].Y, lhs.area) != std::tie(rhs.path[0].X, rhs.path[0].Y, rhs.area))
+            return std::tie(lhs.path[0].X, lhs.path[0].Y, lhs.area) < std::tie(rhs.path[0].X, rhs.path[0].Y, rhs.area);
+
+        auto lessPoint = [](const ClipperLib::IntPoint& a, const ClipperLib::IntPoint& b) {
+            return std::tie(a.X, a.Y) < std::tie(b.X, b.Y);
+        };
+        if (lhs.path != rhs.path)
+            return std::lexicographical_compare(lhs.path.begin(), lhs.path.end(),
+                                                rhs.path.begin(), rhs.path.end(), lessPoint);
+
+        return std::lexicographical_compare(lhs.tags.begin(), lhs.tags.end(), rhs.tags.begin(), rhs.tags.end(),
+            [](const Tag& a, const Tag& b) { return std::tie(a.key, a.value) < std::tie(b.key, b.value); });
+    }
+
+    // Gets tags of the largest part inside aggregated block: it defines class of the block.
+    // Falls back to the largest part of group if block contains no part vertex.
+    static const std::vector<Tag>& getTags(const std::vector<Part>& parts,
+                                           const std::vector<std::size_t>& order,
+                                           const ClipperLib::Path& block)
+    {
+        ClipperLib::cInt minX = block[0].X, minY = block[0].Y, maxX = minX, maxY = minY;
+        for (const auto& point : block) {
+            minX = std::min(minX, point.X); maxX = std::max(maxX, point.X);
+            minY = std::min(minY, point.Y); maxY = std::max(maxY, point.Y);
+        }
+
+        for (std::size_t index : order) {
+            const auto& point = parts[index].path[0];
+            if (point.X >= minX && point.X <= maxX && point.Y >= minY && point.Y <= maxY &&
+                ClipperLib::PointInPolygon(point, block) != 0)
+                return parts[index].tags;
+        }
+        return parts[order[0]].tags;
+    }
+
+    const std::size_t memoryBudget_;
+    std::size_t memorySize_;
+    GroupMap groups_;
+    SpillFile spillFile_;
+    std::mutex lock_;
+};
+
+const std::size_t ElementGeometryAggregator::DefaultMemoryBudget;
+
+ElementGeometryAggregator::ElementGeometryAggregator(std::size_t memoryBudget) :
+    pimpl_(new ElementGeometryAggregator::ElementGeometryAggregatorImpl(memoryBudget))
+{
+}
+
+ElementGeometryAggregator::~ElementGeometryAggregator()
+{
+}
+
+bool ElementGeometryAggregator::add(const Element& element, const QuadKey& quadKey, const std::string& className, double distance)
+{
+    return pimpl_->add(element, quadKey, className, distance);
+}
+
+void ElementGeometryAggregator::flush(const Callback& callback)
+{
+    pimpl_->flush(callback);
+}
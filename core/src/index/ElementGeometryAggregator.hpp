@@ -0,0 +1,49 @@
+#ifndef INDEX_ELEMENTGEOMETRYAGGREGATOR_HPP_DEFINED
+#define INDEX_ELEMENTGEOMETRYAGGREGATOR_HPP_DEFINED
+
+#include "QuadKey.hpp"
+#include "entities/Element.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace utymap { namespace index {
+
+// Merges nearby areas of the same class inside tile into aggregated blocks.
+// Used for generalization of low levels of detail.
+class ElementGeometryAggregator
+{
+public:
+    static const std::size_t DefaultMemoryBudget = 64 * 1024 * 1024;
+
+    // Defines callback which receives aggregated element.
+    typedef std::function<void(const utymap::entities::Element&, const utymap::QuadKey&)> Callback;
+
+    // Creates aggregator. Collected areas which do not fit into memory budget (in bytes)
+    // are spilled to temporary file and read back group by group on flush.
+    explicit ElementGeometryAggregator(std::size_t memoryBudget = DefaultMemoryBudget);
+
+    ~ElementGeometryAggregator();
+
+    // Collects area geometry of element for given class inside quadkey. Areas closer than
+    // distance (in degrees) are merged. Returns false if element has no area geometry.
+    // Thread safe.
+    bool add(const utymap::entities::Element& element,
+             const utymap::QuadKey& quadKey,
+             const std::string& className,
+             double distance);
+
+    // Unions collected areas, drops sub-pixel results and passes them to callback.
+    // Output does not depend on order of collected areas.
+    void flush(const Callback& callback);
+
+private:
+    class ElementGeometryAggregatorImpl;
+    std::unique_ptr<ElementGeometryAggregatorImpl> pimpl_;
+};
+
+}}
+
+#endif // INDEX_ELEMENTGEOMETRYAGGREGATOR_HPP_DEFINED
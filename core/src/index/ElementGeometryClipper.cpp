@@ -8,6 +8,9 @@
 #include "index/ElementStore.hpp"
 #include "index/ElementGeometryClipper.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace utymap;
 using namespace utymap::entities;
 
@@ -17,44 +20,86 @@ namespace {
     // Max precision for Lat/Lon
     const double Scale = 1E7;
 
-    using PointLocation = utymap::index::ElementGeometryClipper::PointLocation;
+    // Amount of consecutive segments which share bounds.
+    const std::size_t SegmentRangeSize = 16;
 
-    inline PointLocation checkWay(const BoundingBox& bbox, const Way& way, ClipperLib::Path& wayShape) {
-        wayShape.reserve(way.coordinates.size());
-        bool allInside = true;
-        bool allOutside = true;
-        for (const GeoCoordinate& coord : way.coordinates) {
-            bool contains = bbox.contains(coord);
-            allInside &= contains;
-            allOutside &= !contains;
+    // Represents bounds of consecutive segments of path.
+    struct SegmentRange
+    {
+        std::size_t start, end;
+        ClipperLib::cInt xMin, yMin, xMax, yMax;
+    };
 
-            auto x = static_cast<ClipperLib::cInt>(coord.longitude * Scale);
-            auto y = static_cast<ClipperLib::cInt>(coord.latitude * Scale);
-            wayShape.push_back(ClipperLib::IntPoint(x, y));
+    // Represents path converted once for clipping by many rectangles.
+    struct ClipPath
+    {
+        ClipperLib::Path points;
+        std::vector<SegmentRange> ranges;
+    };
+
+    // Represents quadkey rectangle in clipper coordinates.
+    struct ClipRect
+    {
+        explicit ClipRect(const BoundingBox& bbox) :
+            xMin(static_cast<ClipperLib::cInt>(bbox.minPoint.longitude * Scale)),
+            yMin(static_cast<ClipperLib::cInt>(bbox.minPoint.latitude * Scale)),
+            xMax(static_cast<ClipperLib::cInt>(bbox.maxPoint.longitude * Scale)),
+            yMax(static_cast<ClipperLib::cInt>(bbox.maxPoint.latitude * Scale))
+        {
         }
 
-        return allInside ? PointLocation::AllInside :
-            (allOutside ? PointLocation::AllOutside : PointLocation::Mixed);
-    }
+        // Checks whether point is inside and not on the border.
+        inline bool containsStrict(const ClipperLib::IntPoint& point) const
+        {
+            return point.X > xMin && point.X < xMax && point.Y > yMin && point.Y < yMax;
+        }
 
-    inline PointLocation checkArea(const BoundingBox& bbox, const Area& area, ClipperLib::Path& areaShape) {
-        bool allInside = true;
-        auto areaBbox = BoundingBox();
+        // Checks whether segments of range may touch rectangle.
+        inline bool intersects(const SegmentRange& range) const
+        {
+            return range.xMax >= xMin && range.xMin <= xMax && range.yMax >= yMin && range.yMin <= yMax;
+        }
 
-        areaShape.reserve(area.coordinates.size());
-        for (const GeoCoordinate& coord : area.coordinates) {
-            bool contains = bbox.contains(coord);
-            areaBbox.expand(coord);
-            allInside &= contains;
+        // Checks whether segment lies on the border.
+        inline bool isBorder(const ClipperLib::IntPoint& p1, const ClipperLib::IntPoint& p2) const
+        {
+            return (p1.X == p2.X && (p1.X == xMin || p1.X == xMax)) ||
+                   (p1.Y == p2.Y && (p1.Y == yMin || p1.Y == yMax));
+        }
 
-            auto x = static_cast<ClipperLib::cInt>(coord.longitude * Scale);
-            auto y = static_cast<ClipperLib::cInt>(coord.latitude * Scale);
-            areaShape.push_back(ClipperLib::IntPoint(x, y));
+        // Gets position of border point walking counterclockwise from min point.
+        inline double position(const ClipperLib::IntPoint& point) const
+        {
+            double width = static_cast<double>(xMax - xMin), height = static_cast<double>(yMax - yMin);
+            if (point.Y == yMin) return static_cast<double>(point.X - xMin);
+            if (point.X == xMax) return width + (point.Y - yMin);
+            if (point.Y == yMax) return width + height + (xMax - point.X);
+            return 2 * width + height + (yMax - point.Y);
         }
 
-        return allInside ? PointLocation::AllInside :
-            (bbox.intersects(areaBbox) ? PointLocation::Mixed : PointLocation::AllOutside);
-    }
+        inline double perimeter() const
+        {
+            return 2. * ((xMax - xMin) + (yMax - yMin));
+        }
+
+        // Gets corner in counterclockwise order starting from min point.
+        inline ClipperLib::IntPoint corner(int index) const
+        {
+            switch (index) {
+                case 0: return ClipperLib::IntPoint(xMin, yMin);
+                case 1: return ClipperLib::IntPoint(xMax, yMin);
+                case 2: return ClipperLib::IntPoint(xMax, yMax);
+                default: return ClipperLib::IntPoint(xMin, yMax);
+            }
+        }
+
+        inline ClipperLib::Path path() const
+        {
+            return ClipperLib::Path{ corner(0), corner(1), corner(2), corner(3) };
+        }
+
+        ClipperLib::cInt xMin, yMin, xMax, yMax;
+    };
 
     template<typename T>
     inline void setCoordinates(T& t, const ClipperLib::Path& path) {
@@ -71,65 +116,367 @@ namespace {
         setCoordinates<T>(t, path);
     }
 
-    ClipperLib::Path createPathFromBoundingBox(const BoundingBox& quadKeyBbox)
+    // Converts coordinates to clipper path and computes bounds of segment ranges.
+    template<typename T>
+    void createClipPath(const T& coordinates, bool isClosed, ClipPath& clipPath, BoundingBox& bbox)
+    {
+        auto& points = clipPath.points;
+        points.reserve(coordinates.size());
+        for (const GeoCoordinate& coord : coordinates) {
+            bbox.expand(coord);
+            points.push_back(ClipperLib::IntPoint(static_cast<ClipperLib::cInt>(coord.longitude * Scale),
+                                                  static_cast<ClipperLib::cInt>(coord.latitude * Scale)));
+        }
+
+        // NOTE clipper produces areas with positive orientation.
+        if (isClosed && !ClipperLib::Orientation(points))
+            std::reverse(points.begin(), points.end());
+
+        std::size_t size = points.size();
+        std::size_t count = isClosed ? size : (size > 0 ? size - 1 : 0);
+        clipPath.ranges.reserve(count / SegmentRangeSize + 1);
+        for (std::size_t start = 0; start < count; start += SegmentRangeSize) {
+            SegmentRange range = { start, std::min(start + SegmentRangeSize, count),
+                                   points[start].X, points[start].Y, points[start].X, points[start].Y };
+            for (std::size_t i = start + 1; i <= range.end; ++i) {
+                const auto& point = points[i % size];
+                range.xMin = std::min(range.xMin, point.X);
+                range.yMin = std::min(range.yMin, point.Y);
+                range.xMax = std::max(range.xMax, point.X);
+                range.yMax = std::max(range.yMax, point.Y);
+            }
+            clipPath.ranges.push_back(range);
+        }
+    }
+
+    // Clips segment by rectangle using Liang-Barsky algorithm. Sides are indices of borders
+    // which define entry and exit points or -1 if the segment point itself is used.
+    bool clipSegment(const ClipRect& rect, const ClipperLib::IntPoint& p1, const ClipperLib::IntPoint& p2,
+                     double& t0, int& side0, double& t1, int& side1)
     {
-        double xMin = quadKeyBbox.minPoint.longitude, yMin = quadKeyBbox.minPoint.latitude,
-            xMax = quadKeyBbox.maxPoint.longitude, yMax = quadKeyBbox.maxPoint.latitude;
-        ClipperLib::Path rect;
-        rect.push_back(ClipperLib::IntPoint(static_cast<ClipperLib::cInt>(xMin*Scale),
-            static_cast<ClipperLib::cInt>(yMin*Scale)));
+        double dx = static_cast<double>(p2.X - p1.X), dy = static_cast<double>(p2.Y - p1.Y);
+        double p[4] = { -dx, dx, -dy, dy };
+        double q[4] = { static_cast<double>(p1.X - rect.xMin), static_cast<double>(rect.xMax - p1.X),
+                        static_cast<double>(p1.Y - rect.yMin), static_cast<double>(rect.yMax - p1.Y) };
+        t0 = 0; t1 = 1;
+        side0 = side1 = -1;
+        for (int i = 0; i < 4; ++i) {
+            if (p[i] == 0) {
+                if (q[i] < 0) return false;
+                continue;
+            }
+            double r = q[i] / p[i];
+            if (p[i] < 0) {
+                if (r > t0) { t0 = r; side0 = i; }
+            }
+            else if (r < t1) { t1 = r; side1 = i; }
+        }
+        return t0 <= t1;
+    }
+
+    // Gets point of segment at given parameter snapped to the given border.
+    ClipperLib::IntPoint getPoint(const ClipRect& rect, const ClipperLib::IntPoint& p1,
+                                  const ClipperLib::IntPoint& p2, double t, int side)
+    {
+        if (side < 0)
+            return t < 0.5 ? p1 : p2;
+
+        auto x = static_cast<ClipperLib::cInt>(std::llround(p1.X + t * (p2.X - p1.X)));
+        auto y = static_cast<ClipperLib::cInt>(std::llround(p1.Y + t * (p2.Y - p1.Y)));
+        switch (side) {
+            case 0: x = rect.xMin; break;
+            case 1: x = rect.xMax; break;
+            case 2: y = rect.yMin; break;
+            default: y = rect.yMax; break;
+        }
+        return ClipperLib::IntPoint(std::min(std::max(x, rect.xMin), rect.xMax),
+                                    std::min(std::max(y, rect.yMin), rect.yMax));
+    }
+
+    // Adds part to solution if it has enough points.
+    void addPart(ClipperLib::Path& part, std::size_t minSize, ClipperLib::Paths& solution)
+    {
+        if (part.size() > 1 && part.front() == part.back() && minSize > 2)
+            part.pop_back();
+        if (part.size() >= minSize)
+            solution.push_back(std::move(part));
+        part = ClipperLib::Path();
+    }
+
+    // Checks whether point is inside ring using ray casting. Skips segment ranges which cannot cross the ray.
+    bool containsPoint(const ClipPath& ring, const ClipperLib::IntPoint& point)
+    {
+        const auto& points = ring.points;
+        std::size_t size = points.size();
+        bool isInside = false;
+        for (const auto& range : ring.ranges) {
+            if (range.yMin > point.Y || range.yMax < point.Y || range.xMax < point.X)
+                continue;
+
+            for (std::size_t i = range.start; i < range.end; ++i) {
+                const auto& a = points[i];
+                const auto& b = points[(i + 1) % size];
+                if ((a.Y > point.Y) != (b.Y > point.Y) &&
+                    point.X < a.X + static_cast<double>(point.Y - a.Y) * (b.X - a.X) / (b.Y - a.Y))
+                    isInside = !isInside;
+            }
+        }
+        return isInside;
+    }
+
+    // Clips polyline by rectangle keeping its direction.
+    void clipLine(const ClipRect& rect, const ClipPath& line, ClipperLib::Paths& solution)
+    {
+        const auto& points = line.points;
+        ClipperLib::Path part;
+        double t0, t1;
+        int side0, side1;
+        for (const auto& range : line.ranges) {
+            if (!rect.intersects(range))
+                continue;
+
+            for (std::size_t i = range.start; i < range.end; ++i) {
+                const auto& p1 = points[i];
+                const auto& p2 = points[i + 1];
+                if (!clipSegment(rect, p1, p2, t0, side0, t1, side1))
+                    continue;
+
+                auto entry = getPoint(rect, p1, p2, t0, side0);
+                auto exit = getPoint(rect, p1, p2, t1, side1);
+                if (part.empty() || part.back() != entry) {
+                    addPart(part, 2, solution);
+                    part.push_back(entry);
+                }
+                if (part.back() != exit)
+                    part.push_back(exit);
+            }
+        }
+        addPart(part, 2, solution);
+    }
+
+    // Clips ring with positive orientation by rectangle. Parts of ring inside rectangle are
+    // connected by walking rectangle border in counterclockwise direction. Returns false
+    // if ring is degenerated (e.g. self intersecting) and general clipper should be used.
+    bool clipRing(const ClipRect& rect, const ClipPath& ring, ClipperLib::Paths& solution)
+    {
+        const auto& points = ring.points;
+        std::size_t size = points.size();
+
+        // collect chains of ring inside rectangle: each starts and ends on border.
+        std::vector<ClipperLib::Path> chains;
+        bool startsInside = rect.containsStrict(points[0]);
+        bool isInside = startsInside;
+        if (startsInside)
+            chains.push_back(ClipperLib::Path(1, points[0]));
+
+        double t0, t1;
+        int side0, side1;
+        for (const auto& range : ring.ranges) {
+            // NOTE all points of skipped range are outside, so current chain is already closed.
+            if (!rect.intersects(range))
+                continue;
+
+            for (std::size_t i = range.start; i < range.end; ++i) {
+                const auto& p1 = points[i];
+                const auto& p2 = points[(i + 1) % size];
+                bool isNextInside = rect.containsStrict(p2);
+                if (isInside && isNextInside) {
+                    chains.back().push_back(p2);
+                    continue;
+                }
+
+                if (!clipSegment(rect, p1, p2, t0, side0, t1, side1) ||
+                    (!isInside && !isNextInside && t0 == t1))
+                    continue;
+
+                auto entry = getPoint(rect, p1, p2, t0, side0);
+                auto exit = isNextInside ? p2 : getPoint(rect, p1, p2, t1, side1);
+                // NOTE segments along border are restored by border walk below.
+                if (!isInside && !isNextInside && rect.isBorder(entry, exit))
+                    continue;
+
+                if (!isInside)
+                    chains.push_back(ClipperLib::Path(1, entry));
+
+                chains.back().push_back(exit);
+                isInside = isNextInside;
+            }
+        }
+
+        // ring starts inside: the last chain ends at the first point.
+        if (startsInside) {
+            if (chains.size() == 1) {
+                addPart(chains[0], 3, solution);
+                return true;
+            }
+            // NOTE merged chain is kept last as it is closed by the first point.
+            auto& last = chains.back();
+            last.insert(last.end(), chains[0].begin() + 1, chains[0].end());
+            chains.erase(chains.begin());
+        }
+
+        // ring does not cross rectangle: it is either inside ring or outside.
+        if (chains.empty()) {
+            ClipperLib::IntPoint center((rect.xMin + rect.xMax) / 2, (rect.yMin + rect.yMax) / 2);
+            if (containsPoint(ring, center))
+                solution.push_back(rect.path());
+            return true;
+        }
+
+        double perimeter = rect.perimeter();
+        double corners[4] = { rect.position(rect.corner(0)), rect.position(rect.corner(1)),
+                              rect.position(rect.corner(2)), rect.position(rect.corner(3)) };
+        std::vector<double> entries;
+        entries.reserve(chains.size());
+        for (const auto& chain : chains)
+            entries.push_back(rect.position(chain.front()));
+
+        std::vector<bool> used(chains.size(), false);
+        for (std::size_t first = 0; first < chains.size(); ++first) {
+            if (used[first])
+                continue;
+
+            ClipperLib::Path part;
+            std::size_t current = first;
+            while (true) {
+                used[current] = true;
+                part.insert(part.end(), chains[current].begin(), chains[current].end());
+
+                // find the nearest entry along border.
+                double exit = rect.position(chains[current].back());
+                std::size_t next = chains.size();
+                double distance = perimeter;
+                for (std::size_t i = 0; i < chains.size(); ++i) {
+                    double d = entries[i] - exit;
+                    if (d < 0) d += perimeter;
+                    if (next == chains.size() || d < distance) {
+                        next = i;
+                        distance = d;
+                    }
+                }
+
+                // add corners passed on the way.
+                std::pair<double, int> passed[4];
+                int count = 0;
+                for (int i = 0; i < 4; ++i) {
+                    double d = corners[i] - exit;
+                    if (d <= 0) d += perimeter;
+                    if (d < distance)
+                        passed[count++] = std::make_pair(d, i);
+                }
+                std::sort(passed, passed + count);
+                for (int i = 0; i < count; ++i)
+                    part.push_back(rect.corner(passed[i].second));
+
+                if (next == first)
+                    break;
+                if (used[next])
+                    return false;
+                current = next;
+            }
+
+            part.erase(std::unique(part.begin(), part.end()), part.end());
+            addPart(part, 3, solution);
+        }
+
+        return true;
+    }
+}
 
-        rect.push_back(ClipperLib::IntPoint(static_cast<ClipperLib::cInt>(xMax*Scale),
-            static_cast<ClipperLib::cInt>(yMin*Scale)));
+namespace utymap { namespace index {
 
-        rect.push_back(ClipperLib::IntPoint(static_cast<ClipperLib::cInt>(xMax*Scale),
-            static_cast<ClipperLib::cInt>(yMax*Scale)));
+// Represents element geometry converted for clipping.
+class ElementGeometryClipper::Input
+{
+public:
+    enum Type { NodeType, WayType, AreaType, RelationType };
 
-        rect.push_back(ClipperLib::IntPoint(static_cast<ClipperLib::cInt>(xMin*Scale),
-            static_cast<ClipperLib::cInt>(yMax*Scale)));
-        return std::move(rect);
+    Input(const Element& element, Type type) : element(element), type(type), bbox(), shape(), members()
+    {
     }
 
-    std::shared_ptr<Element> processWay(ClipperLib::ClipperEx& clipper, const BoundingBox& bbox, const Way& way)
+    const Element& element;
+    const Type type;
+    BoundingBox bbox;
+    ClipPath shape;
+    std::vector<std::unique_ptr<Input>> members;
+};
+
+}}
+
+namespace {
+    using Input = utymap::index::ElementGeometryClipper::Input;
+
+    // Creates clip input from element.
+    class InputBuilder : public ElementVisitor
+    {
+    public:
+        std::unique_ptr<Input> input;
+
+        void visitNode(const Node& node)
+        {
+            input.reset(new Input(node, Input::NodeType));
+            input->bbox.expand(node.coordinate);
+        }
+
+        void visitWay(const Way& way)
+        {
+            input.reset(new Input(way, Input::WayType));
+            createClipPath(way.coordinates, false, input->shape, input->bbox);
+        }
+
+        void visitArea(const Area& area)
+        {
+            input.reset(new Input(area, Input::AreaType));
+            createClipPath(area.coordinates, true, input->shape, input->bbox);
+        }
+
+        void visitRelation(const Relation& relation)
+        {
+            auto result = std::unique_ptr<Input>(new Input(relation, Input::RelationType));
+            result->members.reserve(relation.elements.size());
+            for (const auto& element : relation.elements) {
+                element->accept(*this);
+                result->bbox.expand(input->bbox);
+                result->members.push_back(std::move(input));
+            }
+            input = std::move(result);
+        }
+    };
+
+    std::shared_ptr<Element> processWay(const BoundingBox& bbox, const Input& input)
     {
-        ClipperLib::Path wayShape;
-        PointLocation pointLocation = checkWay(bbox, way, wayShape);
+        const Way& way = static_cast<const Way&>(input.element);
         // 1. all geometry inside current quadkey: no need to truncate.
-        if (pointLocation == PointLocation::AllInside) {
+        if (bbox.contains(input.bbox)) {
             return std::make_shared<Way>(way);
         }
 
         // 2. all geometry outside : way should be skipped
-        if (pointLocation == PointLocation::AllOutside) {
+        if (!bbox.intersects(input.bbox)) {
             return nullptr;
         }
 
-        ClipperLib::PolyTree solution;
-        clipper.AddPath(wayShape, ClipperLib::ptSubject, false);
-        clipper.Execute(ClipperLib::ctIntersection, solution);
-        clipper.removeSubject();
-        
-        std::size_t count = static_cast<std::size_t>(solution.Total());
+        ClipperLib::Paths solution;
+        clipLine(ClipRect(bbox), input.shape, solution);
 
         // 3. way intersects border only once: store a copy with clipped geometry
-        if (count == 1) {
+        if (solution.size() == 1) {
             auto clippedWay = std::make_shared<Way>();
-            setData(*clippedWay, way, solution.GetFirst()->Contour);
+            setData(*clippedWay, way, solution[0]);
             return clippedWay;
         }
         // 4. in this case, result should be stored as relation (collection of ways)
-        else if (count > 1) {
+        else if (solution.size() > 1) {
             auto relation = std::make_shared<Relation>();
             relation->id = way.id;
             relation->tags = way.tags;
-            relation->elements.reserve(count);
-            ClipperLib::PolyNode* polyNode = solution.GetFirst();
-            while (polyNode) {
+            relation->elements.reserve(solution.size());
+            for (const auto& path : solution) {
                 auto clippedWay = std::make_shared<Way>();
                 clippedWay->id = way.id;
-                setCoordinates(*clippedWay, polyNode->Contour);
+                setCoordinates(*clippedWay, path);
                 relation->elements.push_back(clippedWay);
-                polyNode = polyNode->GetNext();
             }
             return relation;
         }
@@ -138,24 +485,29 @@ namespace {
         return nullptr;
     }
 
-    std::shared_ptr<Element> processArea(ClipperLib::ClipperEx& clipper, const BoundingBox& bbox, const Area& area)
+    std::shared_ptr<Element> processArea(ClipperLib::ClipperEx& clipper, const BoundingBox& bbox, const Input& input)
     {
-        ClipperLib::Path areaShape;
-        PointLocation pointLocation = checkArea(bbox, area, areaShape);
+        const Area& area = static_cast<const Area&>(input.element);
         // 1. all geometry inside current quadkey: no need to truncate.
-        if (pointLocation == PointLocation::AllInside) {
+        if (bbox.contains(input.bbox)) {
             return std::make_shared<Area>(area);
         }
 
         // 2. all geometry outside: use geometry of quadkey
-        if (pointLocation == PointLocation::AllOutside) {
+        if (!bbox.intersects(input.bbox) || input.shape.points.size() < 3) {
             return nullptr;
         }
 
+        ClipRect rect(bbox);
         ClipperLib::Paths solution;
-        clipper.AddPath(areaShape, ClipperLib::ptSubject, true);
-        clipper.Execute(ClipperLib::ctIntersection, solution);
-        clipper.removeSubject();
+        if (!clipRing(rect, input.shape, solution)) {
+            solution.clear();
+            clipper.Clear();
+            clipper.AddPath(rect.path(), ClipperLib::ptClip, true);
+            clipper.AddPath(input.shape.points, ClipperLib::ptSubject, true);
+            clipper.Execute(ClipperLib::ctIntersection, solution);
+            clipper.Clear();
+        }
 
         // 3. way intersects border only once: store a copy with clipped geometry
         if (solution.size() == 1) {
@@ -181,79 +533,51 @@ namespace {
         return nullptr;
     }
 
-    std::shared_ptr<Element> processRelation(ClipperLib::ClipperEx& clipper, const BoundingBox& bbox, const Relation& relation);
- 
-    // Visits relation and collects clipped elements
-    struct RelationVisitor : public ElementVisitor
-    {
-        RelationVisitor(ClipperLib::ClipperEx& clipper, const BoundingBox& quadKeyBbox) :
-            clipper_(clipper), bbox_(quadKeyBbox), relation(nullptr)
-        {
-        }
-
-        void visitNode(const Node& node)
-        {
-            if (bbox_.contains(node.coordinate)) {
-                ensureRelation();
-                relation->elements.push_back(std::make_shared<Node>(node));
-            }
-        }
-
-        void visitWay(const Way& way)
-        {
-            addElement(processWay(clipper_, bbox_, way), way);
-        }
-
-        void visitArea(const Area& area)
-        {
-            addElement(processArea(clipper_, bbox_, area),area);
-        }
+    std::shared_ptr<Element> processRelation(ClipperLib::ClipperEx& clipper, const BoundingBox& bbox, const Input& input);
 
-        void visitRelation(const Relation& relation)
-        {
-            addElement(processRelation(clipper_, bbox_, relation), relation);
+    std::shared_ptr<Element> processInput(ClipperLib::ClipperEx& clipper, const BoundingBox& bbox, const Input& input)
+    {
+        switch (input.type) {
+            case Input::NodeType:
+                return bbox.contains(input.bbox)
+                    ? std::make_shared<Node>(static_cast<const Node&>(input.element))
+                    : nullptr;
+            case Input::WayType:
+                return processWay(bbox, input);
+            case Input::AreaType:
+                return processArea(clipper, bbox, input);
+            default:
+                return processRelation(clipper, bbox, input);
         }
+    }
 
-        std::shared_ptr<Relation> relation;
-
-    private:
-
-        inline void ensureRelation()
-        {
-            if (relation == nullptr)
-                relation = std::make_shared<Relation>();
-        }
+    std::shared_ptr<Element> processRelation(ClipperLib::ClipperEx& clipper, const BoundingBox& bbox, const Input& input)
+    {
+        const Element& relation = input.element;
+        if (!bbox.intersects(input.bbox))
+            return nullptr;
 
-        void addElement(std::shared_ptr<Element> element, const Element& original)
-        {
+        // collect clipped elements
+        std::shared_ptr<Relation> result = nullptr;
+        for (const auto& member : input.members) {
+            auto element = processInput(clipper, bbox, *member);
             if (element == nullptr)
-                return;
+                continue;
 
-            ensureRelation();
+            if (result == nullptr)
+                result = std::make_shared<Relation>();
 
-            element->id = original.id;
-            element->tags = original.tags;
-
-            relation->elements.push_back(element);
+            element->id = member->element.id;
+            element->tags = member->element.tags;
+            result->elements.push_back(element);
         }
 
-        ClipperLib::ClipperEx& clipper_;
-        const BoundingBox& bbox_;
-    };
-
-    std::shared_ptr<Element> processRelation(ClipperLib::ClipperEx& clipper, const BoundingBox& bbox, const Relation& relation)
-    {
-        RelationVisitor visitor(clipper, bbox);
-
-        for (const auto& element : relation.elements) 
-            element->accept(visitor);
-
-        if (visitor.relation == nullptr)
+        if (result == nullptr)
             return nullptr;
-        
-        std::shared_ptr<Element> element = visitor.relation->elements.size() == 1
-            ? visitor.relation->elements.at(0)
-            : visitor.relation;
+
+        std::shared_ptr<Element> element = result->elements.size() == 1
+            ? result->elements.at(0)
+            : result;
 
         element->id = relation.id;
         element->tags = relation.tags;
@@ -265,44 +589,41 @@ namespace {
 namespace utymap { namespace index {
 
 ElementGeometryClipper::ElementGeometryClipper(Callback callback) :
-    callback_(callback), quadKey_(), quadKeyBbox_(), clipper_()
+    callback_(callback), clipper_()
+{
+}
+
+ElementGeometryClipper::~ElementGeometryClipper()
 {
 }
 
 void ElementGeometryClipper::clipAndCall(const Element& element, const QuadKey& quadKey, const BoundingBox& quadKeyBbox)
 {
-    quadKey_ = quadKey;
-    quadKeyBbox_ = quadKeyBbox;
-    clipper_.Clear();
-    clipper_.AddPath(createPathFromBoundingBox(quadKeyBbox_), ClipperLib::ptClip, true);
-    element.accept(*this);
+    clipAndCall(*prepare(element), quadKey, quadKeyBbox);
 }
 
-void ElementGeometryClipper:: visitNode(const Node& node)
+void ElementGeometryClipper::clipAndCall(const Input& input, const QuadKey& quadKey, const BoundingBox& quadKeyBbox)
 {
-    if (quadKeyBbox_.contains(node.coordinate))
-        callback_(node, quadKey_);
+    auto result = clip(input, quadKeyBbox);
+    if (result != nullptr)
+        callback_(*result, quadKey);
 }
 
-void ElementGeometryClipper::visitWay(const Way& way)
+std::shared_ptr<Element> ElementGeometryClipper::clip(const Element& element, const BoundingBox& quadKeyBbox)
 {
-    auto element = processWay(clipper_, quadKeyBbox_, way);
-    if (element != nullptr)
-        callback_(*element, quadKey_);
+    return clip(*prepare(element), quadKeyBbox);
 }
 
-void ElementGeometryClipper::visitArea(const Area& area)
+std::shared_ptr<Element> ElementGeometryClipper::clip(const Input& input, const BoundingBox& quadKeyBbox)
 {
-    auto element = processArea(clipper_, quadKeyBbox_, area);
-    if (element != nullptr)
-        callback_(*element, quadKey_);
+    return processInput(clipper_, quadKeyBbox, input);
 }
 
-void ElementGeometryClipper::visitRelation(const Relation& relation)
+std::shared_ptr<ElementGeometryClipper::Input> ElementGeometryClipper::prepare(const Element& element) const
 {
-    auto element = processRelation(clipper_, quadKeyBbox_, relation);
-    if (element != nullptr)
-        callback_(*element, quadKey_);
+    InputBuilder builder;
+    element.accept(builder);
+    return std::shared_ptr<Input>(builder.input.release());
 }
 
 }}
@@ -13,35 +13,41 @@
 #include "index/ElementStore.hpp"
 
 #include <functional>
+#include <memory>
 
 namespace utymap { namespace index {
 
 // Modifies geometry of element by bounding box clipping.
-class ElementGeometryClipper : private utymap::entities::ElementVisitor
+class ElementGeometryClipper
 {
 public:
     // Defines callback
     typedef std::function<void(const utymap::entities::Element& element, const utymap::QuadKey& quadKey)> Callback;
     // Defines polygon points location relative to current quadkey.
     enum PointLocation { AllInside, AllOutside, Mixed };
+    // Represents element geometry converted once for clipping by many bounding boxes.
+    // Keeps reference to original element.
+    class Input;
 
     ElementGeometryClipper(Callback callback);
 
-    void clipAndCall(const utymap::entities::Element& element, const QuadKey& quadKey, const BoundingBox& quadKeyBbox);
+    ~ElementGeometryClipper();
 
-private:
+    void clipAndCall(const utymap::entities::Element& element, const QuadKey& quadKey, const BoundingBox& quadKeyBbox);
 
-    void visitNode(const utymap::entities::Node& node);
+    void clipAndCall(const Input& input, const QuadKey& quadKey, const BoundingBox& quadKeyBbox);
 
-    void visitWay(const utymap::entities::Way& way);
+    // Clips element by given bounding box. Returns nullptr if there is no intersection.
+    // Result can be clipped again by smaller bounding box inside.
+    std::shared_ptr<utymap::entities::Element> clip(const utymap::entities::Element& element, const BoundingBox& quadKeyBbox);
 
-    void visitArea(const utymap::entities::Area& area);
+    std::shared_ptr<utymap::entities::Element> clip(const Input& input, const BoundingBox& quadKeyBbox);
 
-    void visitRelation(const utymap::entities::Relation& relation);
+    // Prepares element for clipping by many bounding boxes.
+    std::shared_ptr<Input> prepare(const utymap::entities::Element& element) const;
 
+private:
     Callback callback_;
-    QuadKey quadKey_;
-    BoundingBox quadKeyBbox_;
     ClipperLib::ClipperEx clipper_;
 };
 
@@ -6,7 +6,14 @@
 #include "entities/Area.hpp"
 #include "entities/Relation.hpp"
 #include "formats/FormatTypes.hpp"
+#include "index/ElementGeometryAggregator.hpp"
 #include "index/ElementGeometryClipper.hpp"
+#include "utils/CoreUtils.hpp"
+#include "utils/GeometryUtils.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
 
 using namespace utymap;
 using namespace utymap::entities;
@@ -17,6 +24,20 @@ namespace {
     const static std::string ClipKey = "clip";
     const static std::string SkipKey = "skip";
     const static std::string SizeKey = "size";
+    const static std::string SimplifyKey = "simplify";
+    const static std::string SimplifyTopologyKey = "simplify-topology";
+    const static std::string AggregateKey = "aggregate";
+    const static std::string AggregateDistanceKey = "aggregate-distance";
+
+    // Tile size in pixels used to convert distances.
+    const double TileSize = 256;
+
+    // Creates random start of revision, so revisions of different stores and sessions do not match.
+    std::uint64_t createInstanceRevision()
+    {
+        std::random_device device;
+        return (static_cast<std::uint64_t>(device()) << 32) | device();
+    }
 
     // Creates bounding box of given element.
     class BoundingBoxVisitor : public ElementVisitor
@@ -46,6 +67,67 @@ namespace {
             }
         }
     };
+
+    // Creates copy of given element with simplified geometry. Result is null if geometry collapses.
+    class ElementGeometrySimplifier : public ElementVisitor
+    {
+    public:
+        std::shared_ptr<Element> element;
+
+        ElementGeometrySimplifier(double tolerance, bool preserveTopology) :
+            tolerance_(tolerance), preserveTopology_(preserveTopology)
+        {
+        }
+
+        void visitNode(const Node& node)
+        {
+            element = std::make_shared<Node>(node);
+        }
+
+        void visitWay(const Way& way)
+        {
+            auto simplified = std::make_shared<Way>();
+            simplified->id = way.id;
+            simplified->tags = way.tags;
+            simplified->coordinates = utymap::utils::simplify(way.coordinates, tolerance_);
+            element = simplified;
+        }
+
+        void visitArea(const Area& area)
+        {
+            auto coordinates = utymap::utils::simplifyRing(area.coordinates, tolerance_);
+            // NOTE area is smaller than tolerance
+            if (coordinates.size() < 3) {
+                element = nullptr;
+                return;
+            }
+
+            auto simplified = std::make_shared<Area>();
+            simplified->id = area.id;
+            simplified->tags = area.tags;
+            simplified->coordinates = preserveTopology_ && utymap::utils::hasSelfIntersections(coordinates)
+                ? area.coordinates
+                : std::move(coordinates);
+            element = simplified;
+        }
+
+        void visitRelation(const Relation& relation)
+        {
+            auto simplified = std::make_shared<Relation>();
+            simplified->id = relation.id;
+            simplified->tags = relation.tags;
+            for (const auto& child : relation.elements) {
+                child->accept(*this);
+                if (element != nullptr)
+                    simplified->elements.push_back(element);
+            }
+            element = simplified->elements.empty() ? nullptr : simplified;
+        }
+
+    private:
+        double tolerance_;
+        bool preserveTopology_;
+    };
 }
 
 namespace utymap { namespace index {
@@ -53,7 +135,14 @@ namespace utymap { namespace index {
 ElementStore::ElementStore(StringTable& stringTable) :
     clipKeyId_(stringTable.getId(ClipKey)),
     skipKeyId_(stringTable.getId(SkipKey)),
-    sizeKeyId_(stringTable.getId(SizeKey))
+    sizeKeyId_(stringTable.getId(SizeKey)),
+    simplifyKeyId_(stringTable.getId(SimplifyKey)),
+    simplifyTopologyKeyId_(stringTable.getId(SimplifyTopologyKey)),
+    aggregateKeyId_(stringTable.getId(AggregateKey)),
+    aggregateDistanceKeyId_(stringTable.getId(AggregateDistanceKey)),
+    aggregator_(new ElementGeometryAggregator()),
+    instanceRevision_(createInstanceRevision()),
+    revision_(0)
 {
 }
 
@@ -63,43 +152,91 @@ ElementStore::~ElementStore()
 
 bool ElementStore::store(const Element& element, const utymap::LodRange& range, const StyleProvider& styleProvider)
 {
-    return store(element, range, styleProvider, [&](const BoundingBox&, const BoundingBox&) {
-        return true;
-    });
+    return prepare(element, range, styleProvider, storeCallback());
 }
 
 bool ElementStore::store(const Element& element, const QuadKey& quadKey, const StyleProvider& styleProvider)
 {
-    const BoundingBox expectedQuadKeyBbox = utymap::utils::GeoUtils::quadKeyToBoundingBox(quadKey);
-    return store(element, 
-                LodRange(quadKey.levelOfDetail, quadKey.levelOfDetail), 
-                styleProvider, 
-                [&](const BoundingBox& elementBoundingBox, const BoundingBox& quadKeyBbox) {
-                    return elementBoundingBox.intersects(expectedQuadKeyBbox) &&
-                           expectedQuadKeyBbox.center() == quadKeyBbox.center();
-                });
+    return prepare(element, quadKey, styleProvider, storeCallback());
 }
 
 bool ElementStore::store(const Element& element, const BoundingBox& bbox, const utymap::LodRange& range, const StyleProvider& styleProvider)
 {
-    return store(element, range, styleProvider, [&](const BoundingBox& elementBoundingBox, const BoundingBox& quadKeyBbox) {
+    return prepare(element, bbox, range, styleProvider, storeCallback());
+}
+
+bool ElementStore::prepare(const Element& element, const utymap::LodRange& range, const StyleProvider& styleProvider, const StoreCallback& callback) const
+{
+    return prepare(element, range, styleProvider, [&](const BoundingBox&, const BoundingBox&) {
+        return true;
+    }, callback);
+}
+
+bool ElementStore::prepare(const Element& element, const QuadKey& quadKey, const StyleProvider& styleProvider, const StoreCallback& callback) const
+{
+    const BoundingBox expectedQuadKeyBbox = utymap::utils::GeoUtils::quadKeyToBoundingBox(quadKey);
+    return prepare(element, 
+                   LodRange(quadKey.levelOfDetail, quadKey.levelOfDetail), 
+                   styleProvider, 
+                   [&](const BoundingBox& elementBoundingBox, const BoundingBox& quadKeyBbox) {
+                       return elementBoundingBox.intersects(expectedQuadKeyBbox) &&
+                              expectedQuadKeyBbox.center() == quadKeyBbox.center();
+                   }, 
+                   callback);
+}
+
+bool ElementStore::prepare(const Element& element, const BoundingBox& bbox, const utymap::LodRange& range, const StyleProvider& styleProvider, const StoreCallback& callback) const
+{
+    return prepare(element, range, styleProvider, [&](const BoundingBox& elementBoundingBox, const BoundingBox& quadKeyBbox) {
         return elementBoundingBox.intersects(bbox);
-    });
+    }, callback);
+}
+
+std::uint64_t ElementStore::getRevision(const QuadKey&) const
+{
+    return instanceRevision_ + revision_.load();
+}
+
+void ElementStore::write(const Element& element, const QuadKey& quadKey)
+{
+    storeElement(element, quadKey);
+}
+
+void ElementStore::commit()
+{
+    aggregator_->flush(storeCallback());
+    commitImpl();
+}
+
+ElementStore::StoreCallback ElementStore::storeCallback()
+{
+    using namespace std::placeholders;
+    return std::bind(&ElementStore::storeElement, this, _1, _2);
+}
+
+void ElementStore::storeElement(const Element& element, const QuadKey& quadKey)
+{
+    ++revision_;
+    storeImpl(element, quadKey);
 }
 
 template <typename Visitor>
-bool ElementStore::store(const Element& element, const LodRange& range, const StyleProvider& styleProvider, const Visitor& visitor)
+bool ElementStore::prepare(const Element& element, const LodRange& range, const StyleProvider& styleProvider,
+                           const Visitor& visitor, const StoreCallback& callback) const
 {
     BoundingBoxVisitor bboxVisitor;
-    using namespace std::placeholders;
-    ElementGeometryClipper geometryClipper(std::bind(&ElementStore::storeImpl, this, _1, _2));
+    StoreCallback lodCallback = callback;
+    ElementGeometryClipper geometryClipper([&](const Element& part, const QuadKey& quadKey) {
+        lodCallback(part, quadKey);
+    });
+    // callbacks of levels of details where original geometry is clipped: they are processed hierarchically.
+    std::vector<StoreCallback> clipCallbacks(range.end - range.start + 1);
+    int clipStart = range.end + 1, clipEnd = range.start - 1;
     bool wasStored = false;
     double size = -1; // match all by default
     for (int lod = range.start; lod <= range.end; ++lod) {
-        if (!styleProvider.hasStyle(element, lod))
-            continue;
         Style style = styleProvider.forElement(element, lod);
-        if (style.has(skipKeyId_, "true")) continue;
+        if (style.empty() || style.has(skipKeyId_, "true")) continue;
 
         // initialize bounding box and size only once
         if (!bboxVisitor.boundingBox.isValid()) {
@@ -109,26 +246,112 @@ bool ElementStore::store(const Element& element, const LodRange& range, const St
                 size = style.getValue(sizeKeyId_, 1, bboxVisitor.boundingBox.center());
         }
 
-         utymap::utils::GeoUtils::visitTileRange(bboxVisitor.boundingBox, lod,
-                                                 [&](const QuadKey& quadKey, const BoundingBox& quadKeyBbox) {
-             if (!visitor(bboxVisitor.boundingBox, quadKeyBbox) ||
-                 !checkSize(quadKeyBbox, bboxVisitor.boundingBox, size)) // can be optimized (quadkey widht is const for lod)
-                 return;
+        // simplify geometry for given level of details if requested
+        std::shared_ptr<Element> simplified = nullptr;
+        if (style.has(simplifyKeyId_)) {
+            ElementGeometrySimplifier simplifier(getTileDistance(style, simplifyKeyId_, lod, bboxVisitor.boundingBox.center()),
+                                                 style.has(simplifyTopologyKeyId_, "true"));
+            element.accept(simplifier);
+            // NOTE geometry is smaller than tolerance
+            if (simplifier.element == nullptr)
+                continue;
+            simplified = simplifier.element;
+        }
+        const Element& lodElement = simplified != nullptr ? *simplified : element;
 
-            if (style.has(clipKeyId_, "true"))
-                geometryClipper.clipAndCall(element, quadKey, quadKeyBbox);
+        // collect areas for aggregation instead of storing them if requested
+        lodCallback = callback;
+        if (style.has(aggregateKeyId_)) {
+            std::string className = *style.getString(aggregateKeyId_);
+            // NOTE areas closer than one pixel are merged by default
+            double distance = style.has(aggregateDistanceKeyId_)
+                ? getTileDistance(style, aggregateDistanceKeyId_, lod, bboxVisitor.boundingBox.center())
+                : 360. / (1 << lod) / TileSize;
+            lodCallback = [&, className, distance](const Element& part, const QuadKey& quadKey) {
+                if (!aggregator_->add(part, quadKey, className, distance))
+                    callback(part, quadKey);
+            };
+        }
+
+        bool isClipped = style.has(clipKeyId_, "true");
+        if (isClipped && simplified == nullptr) {
+            clipCallbacks[lod - range.start] = lodCallback;
+            clipStart = std::min(clipStart, lod);
+            clipEnd = std::max(clipEnd, lod);
+            continue;
+        }
+
+        // NOTE geometry is converted for clipping once and reused by all tiles of level of details.
+        std::shared_ptr<ElementGeometryClipper::Input> clipInput = nullptr;
+        utymap::utils::GeoUtils::visitTileRange(bboxVisitor.boundingBox, lod,
+                                                [&](const QuadKey& quadKey, const BoundingBox& quadKeyBbox) {
+            if (!visitor(bboxVisitor.boundingBox, quadKeyBbox) ||
+                !checkSize(quadKeyBbox, bboxVisitor.boundingBox, size)) // can be optimized (quadkey widht is const for lod)
+                return;
+
+            if (isClipped) {
+                if (clipInput == nullptr)
+                    clipInput = geometryClipper.prepare(lodElement);
+                geometryClipper.clipAndCall(*clipInput, quadKey, quadKeyBbox);
+            }
             else
-                storeImpl(element, quadKey);
+                lodCallback(lodElement, quadKey);
 
             wasStored = true;
         });
-
     }
 
+    if (clipStart > clipEnd)
+        return wasStored;
+
+    // clip geometry of parent tile into its children, so clipping cost depends on tile geometry only.
+    std::function<void(const QuadKey&, const BoundingBox&, const ElementGeometryClipper::Input&)> clipTile =
+        [&](const QuadKey& quadKey, const BoundingBox& quadKeyBbox, const ElementGeometryClipper::Input& parent) {
+        auto part = geometryClipper.clip(parent, quadKeyBbox);
+        if (part == nullptr)
+            return;
+
+        const auto& clipCallback = clipCallbacks[quadKey.levelOfDetail - range.start];
+        if (clipCallback &&
+            visitor(bboxVisitor.boundingBox, quadKeyBbox) &&
+            checkSize(quadKeyBbox, bboxVisitor.boundingBox, size)) {
+            clipCallback(*part, quadKey);
+            wasStored = true;
+        }
+
+        if (quadKey.levelOfDetail == clipEnd)
+            return;
+
+        // NOTE part is converted once and clipped by all four children.
+        auto input = geometryClipper.prepare(*part);
+        for (int i = 0; i < 4; ++i) {
+            QuadKey child(quadKey.levelOfDetail + 1, quadKey.tileX * 2 + i % 2, quadKey.tileY * 2 + i / 2);
+            clipTile(child, utymap::utils::GeoUtils::quadKeyToBoundingBox(child), *input);
+        }
+    };
+
+    auto input = geometryClipper.prepare(element);
+    utymap::utils::GeoUtils::visitTileRange(bboxVisitor.boundingBox, clipStart,
+                                            [&](const QuadKey& quadKey, const BoundingBox& quadKeyBbox) {
+        clipTile(quadKey, quadKeyBbox, *input);
+    });
+
     // NOTE still might be clipped and then skipped
     return wasStored;
 }
 
+double ElementStore::getTileDistance(const Style& style, std::uint32_t keyId, int levelOfDetail, const GeoCoordinate& coordinate) const
+{
+    double tileWidth = 360. / (1 << levelOfDetail);
+    auto value = style.getString(keyId);
+    // distance in pixels of tile
+    if (utymap::utils::endsWith(*value, "px"))
+        return utymap::utils::parseDouble(value->substr(0, value->size() - 2)) * tileWidth / TileSize;
+
+    // distance in meters, percents of tile width or degrees
+    return style.getValue(keyId, tileWidth, coordinate);
+}
+
 bool ElementStore::checkSize(const utymap::BoundingBox& quadKeyBBox, const utymap::BoundingBox& elementBbox, double minSize) const {
     return elementBbox.width() / quadKeyBBox.width() > minSize;
 }
@@ -9,15 +9,22 @@
 #include "formats/FormatTypes.hpp"
 #include "mapcss/StyleProvider.hpp"
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <memory>
 
 namespace utymap { namespace index {
 
+class ElementGeometryAggregator;
+
 // Defines API to store elements.
 class ElementStore
 {
 public:
+    // Defines callback which receives element prepared for storing in given quadkey.
+    typedef std::function<void(const utymap::entities::Element&, const utymap::QuadKey&)> StoreCallback;
+
     ElementStore(utymap::index::StringTable& stringTable);
 
     virtual ~ElementStore();
@@ -29,6 +36,10 @@ public:
     // Checks whether there is data for given quadkey.
     virtual bool hasData(const utymap::QuadKey& quadKey) const = 0;
 
+    // Gets revision of quadkey data: it is changed when data of quadkey may be changed.
+    // Default one is changed by any write and is unique for store instance.
+    virtual std::uint64_t getRevision(const utymap::QuadKey& quadKey) const;
+
     // Stores element in storage in all affected tiles at given level of details range.
     bool store(const utymap::entities::Element& element, 
                const utymap::LodRange& range,
@@ -45,25 +56,68 @@ public:
                const utymap::LodRange& range,
                const utymap::mapcss::StyleProvider& styleProvider);
 
-    // Commits changes done in element store.
-    virtual void commit() = 0;
+    // Prepares element for storing in all affected tiles at given level of details range.
+    // Results are passed to callback instead of storage, so it can be called concurrently.
+    bool prepare(const utymap::entities::Element& element,
+                 const utymap::LodRange& range,
+                 const utymap::mapcss::StyleProvider& styleProvider,
+                 const StoreCallback& callback) const;
+
+    // Prepares element for storing only in given quadkey.
+    bool prepare(const utymap::entities::Element& element,
+                 const utymap::QuadKey& quadKey,
+                 const utymap::mapcss::StyleProvider& styleProvider,
+                 const StoreCallback& callback) const;
+
+    // Prepares element for storing only in given bounding box.
+    bool prepare(const utymap::entities::Element& element,
+                 const utymap::BoundingBox& bbox,
+                 const utymap::LodRange& range,
+                 const utymap::mapcss::StyleProvider& styleProvider,
+                 const StoreCallback& callback) const;
+
+    // Writes already prepared element to given quadkey.
+    void write(const utymap::entities::Element& element, const utymap::QuadKey& quadKey);
+
+    // Commits changes done in element store. Aggregated elements are stored here.
+    void commit();
 
 protected:
     // Stores element in given quadkey.
     virtual void storeImpl(const utymap::entities::Element& element, const utymap::QuadKey& quadKey) = 0;
 
+    // Commits changes done in specific element store.
+    virtual void commitImpl() = 0;
+
 private:
     template <typename Visitor>
-    bool store(const utymap::entities::Element& element,
-               const utymap::LodRange& range,
-               const utymap::mapcss::StyleProvider& styleProvider,
-               const Visitor& visitor);
+    bool prepare(const utymap::entities::Element& element,
+                 const utymap::LodRange& range,
+                 const utymap::mapcss::StyleProvider& styleProvider,
+                 const Visitor& visitor,
+                 const StoreCallback& callback) const;
+
+    // Gets callback which stores element in this store.
+    StoreCallback storeCallback();
+
+    // Stores element in given quadkey and updates revision.
+    void storeElement(const utymap::entities::Element& element, const utymap::QuadKey& quadKey);
 
     bool checkSize(const utymap::BoundingBox& quadKeyBBox,
                    const utymap::BoundingBox& elementBbox,
                    double minSize) const;
 
-    std::uint32_t clipKeyId_, skipKeyId_, sizeKeyId_;
+    // Gets distance in degrees specified by declaration for given level of detail.
+    double getTileDistance(const utymap::mapcss::Style& style,
+                           std::uint32_t keyId,
+                           int levelOfDetail,
+                           const utymap::GeoCoordinate& coordinate) const;
+
+    std::uint32_t clipKeyId_, skipKeyId_, sizeKeyId_, simplifyKeyId_, simplifyTopologyKeyId_,
+                  aggregateKeyId_, aggregateDistanceKeyId_;
+    std::unique_ptr<ElementGeometryAggregator> aggregator_;
+    const std::uint64_t instanceRevision_;
+    std::atomic<std::uint64_t> revision_;
 };
 
 }}
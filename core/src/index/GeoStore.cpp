@@ -6,6 +6,7 @@
 #include "formats/osm/pbf/OsmPbfParser.hpp"
 #include "formats/osm/OsmDataVisitor.hpp"
 #include "index/GeoStore.hpp"
+#include "index/ImportPipeline.hpp"
 #include "index/InMemoryElementStore.hpp"
 #include "index/PersistentElementStore.hpp"
 #include "utils/CoreUtils.hpp"
@@ -13,6 +14,7 @@
 #include <set>
 #include <map>
 #include <memory>
+#include <thread>
 
 using namespace utymap::entities;
 using namespace utymap::formats;
@@ -78,8 +80,8 @@ public:
     void add(const std::string& storeKey, const std::string& path, const QuadKey& quadKey, const StyleProvider& styleProvider)
     {
         auto elementStore = storeMap_[storeKey];
-        add(path, styleProvider, [&](Element& element) {
-            return elementStore->store(element, quadKey, styleProvider);
+        add(path, *elementStore, [&](const Element& element, const ElementStore::StoreCallback& callback) {
+            return elementStore->prepare(element, quadKey, styleProvider, callback);
         });
         elementStore->commit();
     }
@@ -87,8 +89,8 @@ public:
     void add(const std::string& storeKey, const std::string& path, const LodRange& range, const StyleProvider& styleProvider)
     {
         auto elementStore = storeMap_[storeKey];
-        add(path, styleProvider, [&](Element& element) {
-            return elementStore->store(element, range, styleProvider);
+        add(path, *elementStore, [&](const Element& element, const ElementStore::StoreCallback& callback) {
+            return elementStore->prepare(element, range, styleProvider, callback);
         });
         elementStore->commit();
     }
@@ -96,13 +98,20 @@ public:
     void add(const std::string& storeKey, const std::string& path, const BoundingBox& bbox, const LodRange& range, const StyleProvider& styleProvider)
     {
         auto elementStore = storeMap_[storeKey];
-        add(path, styleProvider, [&](Element& element) {
-            return elementStore->store(element, bbox, range, styleProvider);
+        add(path, *elementStore, [&](const Element& element, const ElementStore::StoreCallback& callback) {
+            return elementStore->prepare(element, bbox, range, styleProvider, callback);
         });
         elementStore->commit();
     }
 
-    void add(const std::string& path, const StyleProvider& styleProvider, const std::function<bool(Element&)>& functor)
+    void add(const std::string& path, ElementStore& elementStore, const ImportPipeline::Processor& processor)
+    {
+        ImportPipeline pipeline(elementStore, processor, std::thread::hardware_concurrency());
+        add(path, [&](Element& element) { return pipeline.add(element); });
+        pipeline.complete();
+    }
+
+    void add(const std::string& path, const std::function<bool(Element&)>& functor)
     {
         switch (getFormatTypeFromPath(path)) {
             case FormatType::Shape: {
@@ -157,6 +166,17 @@ public:
         return false;
     }
 
+    std::uint64_t getRevision(const QuadKey& quadKey)
+    {
+        // NOTE stores without data do not affect output, so they are skipped.
+        std::uint64_t revision = 0;
+        for (const auto& pair : storeMap_) {
+            if (pair.second->hasData(quadKey))
+                revision = revision * 31 + pair.second->getRevision(quadKey);
+        }
+        return revision;
+    }
+
 private:
     StringTable& stringTable_;
     std::map<std::string, std::shared_ptr<ElementStore>> storeMap_;
@@ -221,3 +241,8 @@ bool utymap::index::GeoStore::hasData(const QuadKey& quadKey)
 {
     return pimpl_->hasData(quadKey);
 }
+
+std::uint64_t utymap::index::GeoStore::getRevision(const QuadKey& quadKey)
+{
+    return pimpl_->getRevision(quadKey);
+}
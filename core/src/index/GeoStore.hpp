@@ -14,6 +14,7 @@
 #include "mapcss/StyleSheet.hpp"
 #include "mapcss/StyleProvider.hpp"
 
+#include <cstdint>
 #include <string>
 #include <memory>
 
@@ -70,6 +71,9 @@ public:
     // Checks whether there is data for given quadkey.
     bool hasData(const QuadKey& quadKey);
 
+    // Gets combined revision of quadkey data in all stores.
+    std::uint64_t getRevision(const QuadKey& quadKey);
+
 private:
     class GeoStoreImpl;
     std::unique_ptr<GeoStoreImpl> pimpl_;
@@ -0,0 +1,271 @@
+#include "QuadKey.hpp"
+#include "entities/Node.hpp"
+#include "entities/Way.hpp"
+#include "entities/Area.hpp"
+#include "entities/Relation.hpp"
+#include "index/ImportPipeline.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace utymap;
+using namespace utymap::entities;
+using namespace utymap::index;
+
+namespace {
+    typedef std::vector<std::shared_ptr<Element>> Elements;
+    typedef std::vector<std::pair<QuadKey, std::shared_ptr<Element>>> Entries;
+
+    // Represents elements added by caller in the same order.
+    struct Batch
+    {
+        std::size_t sequence;
+        Elements elements;
+    };
+
+    // Creates a copy of element which can be owned by pipeline.
+    struct ElementCloner : public ElementVisitor
+    {
+        std::shared_ptr<Element> element;
+
+        void visitNode(const Node& node) { element = std::make_shared<Node>(node); }
+
+        void visitWay(const Way& way) { element = std::make_shared<Way>(way); }
+
+        void visitArea(const Area& area) { element = std::make_shared<Area>(area); }
+
+        void visitRelation(const Relation& relation) { element = std::make_shared<Relation>(relation); }
+    };
+
+    std::shared_ptr<Element> clone(const Element& element)
+    {
+        ElementCloner cloner;
+        element.accept(cloner);
+        return cloner.element;
+    }
+}
+
+class ImportPipeline::ImportPipelineImpl
+{
+public:
+    ImportPipelineImpl(ElementStore& elementStore, const Processor& processor,
+                       std::size_t workerCount, std::size_t batchSize, std::size_t capacity) :
+        elementStore_(elementStore), processor_(processor),
+        batchSize_(batchSize > 0 ? batchSize : 1), capacity_(capacity > 0 ? capacity : 1),
+        current_(), batches_(), results_(), nextSequence_(0), written_(0),
+        isCompleted_(false), isStopped_(false), error_(nullptr), workers_(), writer_()
+    {
+        if (workerCount == 0)
+            return;
+
+        current_.elements.reserve(batchSize_);
+        for (std::size_t i = 0; i < workerCount; ++i)
+            workers_.push_back(std::thread(&ImportPipelineImpl::processBatches, this));
+        writer_ = std::thread(&ImportPipelineImpl::writeBatches, this);
+    }
+
+    ~ImportPipelineImpl()
+    {
+        stop(nullptr);
+        join();
+    }
+
+    bool add(const Element& element)
+    {
+        // sequential mode: no threads are used.
+        if (workers_.empty())
+            return processor_(element, [&](const Element& part, const QuadKey& quadKey) {
+                elementStore_.write(part, quadKey);
+            });
+
+        current_.elements.push_back(clone(element));
+        if (current_.elements.size() >= batchSize_)
+            submit();
+
+        return true;
+    }
+
+    void complete()
+    {
+        if (!workers_.empty()) {
+            if (!current_.elements.empty())
+                submit();
+            {
+                std::lock_guard<std::mutex> lock(lock_);
+                isCompleted_ = true;
+            }
+            inputCondition_.notify_all();
+            outputCondition_.notify_all();
+            join();
+        }
+
+        if (error_ != nullptr)
+            std::rethrow_exception(error_);
+    }
+
+private:
+
+    // Sends current batch to workers. Blocks while there are too many batches in flight.
+    void submit()
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        spaceCondition_.wait(lock, [&]() {
+            return isStopped_ || nextSequence_ - written_ < capacity_;
+        });
+
+        if (error_ != nullptr)
+            std::rethrow_exception(error_);
+
+        current_.sequence = nextSequence_++;
+        batches_.push_back(std::move(current_));
+        lock.unlock();
+        inputCondition_.notify_one();
+
+        current_ = Batch();
+        current_.elements.reserve(batchSize_);
+    }
+
+    // Worker stage: styles and clips elements of batch.
+    void processBatches()
+    {
+        while (true) {
+            Batch batch;
+            {
+                std::unique_lock<std::mutex> lock(lock_);
+                inputCondition_.wait(lock, [&]() {
+                    return isStopped_ || isCompleted_ || !batches_.empty();
+                });
+                if (isStopped_ || batches_.empty())
+                    return;
+                batch = std::move(batches_.front());
+                batches_.pop_front();
+            }
+
+            Entries entries;
+            try {
+                for (const auto& element : batch.elements) {
+                    processor_(*element, [&](const Element& part, const QuadKey& quadKey) {
+                        // NOTE clipper creates temporary elements, original one is owned by batch.
+                        entries.push_back(std::make_pair(quadKey, &part == element.get() ? element : clone(part)));
+                    });
+                }
+            }
+            catch (...) {
+                stop(std::current_exception());
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(lock_);
+                results_[batch.sequence] = std::move(entries);
+            }
+            outputCondition_.notify_one();
+        }
+    }
+
+    // Writer stage: writes results to element store keeping original order.
+    void writeBatches()
+    {
+        while (true) {
+            Entries entries;
+            {
+                std::unique_lock<std::mutex> lock(lock_);
+                outputCondition_.wait(lock, [&]() {
+                    return isStopped_ || results_.find(written_) != results_.end() ||
+                           (isCompleted_ && written_ == nextSequence_);
+                });
+                auto result = results_.find(written_);
+                if (isStopped_ || result == results_.end())
+                    return;
+                entries = std::move(result->second);
+                results_.erase(result);
+            }
+
+            try {
+                for (const auto& entry : entries)
+                    elementStore_.write(*entry.second, entry.first);
+            }
+            catch (...) {
+                stop(std::current_exception());
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(lock_);
+                ++written_;
+            }
+            spaceCondition_.notify_one();
+        }
+    }
+
+    // Stops all stages. Keeps the first error only.
+    void stop(std::exception_ptr error)
+    {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            if (error_ == nullptr)
+                error_ = error;
+            isStopped_ = true;
+        }
+        inputCondition_.notify_all();
+        outputCondition_.notify_all();
+        spaceCondition_.notify_all();
+    }
+
+    void join()
+    {
+        for (auto& worker : workers_) {
+            if (worker.joinable())
+                worker.join();
+        }
+        if (writer_.joinable())
+            writer_.join();
+    }
+
+    ElementStore& elementStore_;
+    const Processor processor_;
+    const std::size_t batchSize_;
+    const std::size_t capacity_;
+
+    Batch current_;
+    std::deque<Batch> batches_;
+    std::map<std::size_t, Entries> results_;
+    std::size_t nextSequence_;
+    std::size_t written_;
+    bool isCompleted_;
+    bool isStopped_;
+    std::exception_ptr error_;
+
+    std::mutex lock_;
+    std::condition_variable inputCondition_;
+    std::condition_variable outputCondition_;
+    std::condition_variable spaceCondition_;
+    std::vector<std::thread> workers_;
+    std::thread writer_;
+};
+
+ImportPipeline::ImportPipeline(ElementStore& elementStore, const Processor& processor,
+                               std::size_t workerCount, std::size_t batchSize, std::size_t capacity) :
+    pimpl_(new ImportPipeline::ImportPipelineImpl(elementStore, processor, workerCount, batchSize, capacity))
+{
+}
+
+ImportPipeline::~ImportPipeline()
+{
+}
+
+bool ImportPipeline::add(const Element& element)
+{
+    return pimpl_->add(element);
+}
+
+void ImportPipeline::complete()
+{
+    pimpl_->complete();
+}
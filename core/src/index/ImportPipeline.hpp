@@ -0,0 +1,50 @@
+#ifndef INDEX_IMPORTPIPELINE_HPP_DEFINED
+#define INDEX_IMPORTPIPELINE_HPP_DEFINED
+
+#include "entities/Element.hpp"
+#include "index/ElementStore.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace utymap { namespace index {
+
+// Imports elements into element store using staged processing:
+// caller thread parses data and interns strings, worker threads style and clip
+// elements, single writer thread owns element store. Elements are written in
+// the same order as they were added, so result is identical to sequential import.
+class ImportPipeline
+{
+public:
+    // Defines function which prepares element for storing. Should be thread safe.
+    typedef std::function<bool(const utymap::entities::Element&,
+                               const utymap::index::ElementStore::StoreCallback&)> Processor;
+
+    // Creates pipeline. If worker count is zero, elements are processed and stored
+    // on caller thread. Batch size defines amount of elements processed by worker
+    // at once, capacity defines max amount of batches in flight.
+    ImportPipeline(utymap::index::ElementStore& elementStore,
+                   const Processor& processor,
+                   std::size_t workerCount,
+                   std::size_t batchSize = 64,
+                   std::size_t capacity = 64);
+
+    // Stops pipeline without waiting for queued elements.
+    ~ImportPipeline();
+
+    // Adds element to pipeline. Blocks if pipeline is full. Returns whether
+    // element is accepted: it is not yet known whether it will be stored.
+    bool add(const utymap::entities::Element& element);
+
+    // Waits until all added elements are stored. Rethrows processing error if any.
+    void complete();
+
+private:
+    class ImportPipelineImpl;
+    std::unique_ptr<ImportPipelineImpl> pimpl_;
+};
+
+}}
+
+#endif // INDEX_IMPORTPIPELINE_HPP_DEFINED
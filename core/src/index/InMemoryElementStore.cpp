@@ -29,6 +29,7 @@ namespace {
 
     typedef std::vector<std::shared_ptr<Element>> Elements;
     typedef std::map<QuadKey, Elements, QuadKeyComparator> ElementMap;
+    typedef std::map<QuadKey, std::uint64_t, QuadKeyComparator> RevisionMap;
 
     class ElementMapVisitor : public ElementVisitor
     {
@@ -67,6 +68,7 @@ class InMemoryElementStore::InMemoryElementStoreImpl
 {
  public:
     ElementMap elementsMap;
+    RevisionMap revisions;
 
     inline ElementMap::const_iterator begin(const utymap::QuadKey& quadKey) const
     {
@@ -97,6 +99,10 @@ void InMemoryElementStore::storeImpl(const utymap::entities::Element& element, c
 {
     ElementMapVisitor visitor(quadKey, pimpl_->elementsMap);
     element.accept(visitor);
+
+    // NOTE depends only on ids and order of written elements.
+    auto& revision = pimpl_->revisions[quadKey];
+    revision = revision * 31 + element.id + 1;
 }
 
 bool InMemoryElementStore::hasData(const utymap::QuadKey& quadKey) const
@@ -104,6 +110,12 @@ bool InMemoryElementStore::hasData(const utymap::QuadKey& quadKey) const
     return pimpl_->hasData(quadKey);
 }
 
+std::uint64_t InMemoryElementStore::getRevision(const utymap::QuadKey& quadKey) const
+{
+    auto pair = pimpl_->revisions.find(quadKey);
+    return pair != pimpl_->revisions.end() ? pair->second : 0;
+}
+
 void InMemoryElementStore::search(const utymap::QuadKey& quadKey, utymap::entities::ElementVisitor& visitor)
 {
     auto it = pimpl_->begin(quadKey);
@@ -117,7 +129,7 @@ void InMemoryElementStore::search(const utymap::QuadKey& quadKey, utymap::entiti
     }
 }
 
-void InMemoryElementStore::commit()
+void InMemoryElementStore::commitImpl()
 {
 
 }
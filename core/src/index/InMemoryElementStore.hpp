@@ -23,11 +23,14 @@ public:
 
     bool hasData(const utymap::QuadKey& quadKey) const;
 
-    void commit();
+    // Gets revision based on elements written to quadkey, so it is the same between sessions.
+    std::uint64_t getRevision(const utymap::QuadKey& quadKey) const;
 
 protected:
     void storeImpl(const utymap::entities::Element& element, const utymap::QuadKey& quadKey);
 
+    void commitImpl();
+
 private:
     class InMemoryElementStoreImpl;
     std::unique_ptr<InMemoryElementStoreImpl> pimpl_;
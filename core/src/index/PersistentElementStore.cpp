@@ -5,8 +5,14 @@
 #include "entities/Relation.hpp"
 #include "index/PersistentElementStore.hpp"
 
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
+#include <mutex>
+#include <queue>
 #include <sstream>
+#include <stdexcept>
+#include <tuple>
 
 using namespace utymap;
 using namespace utymap::index;
@@ -40,11 +46,36 @@ namespace {
     //------------------------------------------------------------------------------------------------------|
     const std::string DataFileExtension = ".dat";
 
-    // Writes element to file stream.
+    //                                      Sorted run file format
+    //------------------------------------------------------------------------------------------------------|
+    //   DESCRIPTION    |                       DETAILS                                                     |
+    //------------------------------------------------------------------------------------------------------|
+    //     Record       |  List of records, each is represented by quadkey (4b + 4b + 4b), element id (8b), |
+    //                  |  data size (4b) and element data in data file format                              |
+    //------------------------------------------------------------------------------------------------------|
+    const std::string RunFilePrefix = "sort-";
+    const std::string RunFileExtension = ".run";
+
+    // Represents serialized element which waits for being written to its quadkey files.
+    struct SortRecord
+    {
+        QuadKey quadKey;
+        std::uint64_t id;
+        std::string data;
+    };
+
+    // Orders quadkeys to write each tile files once.
+    inline bool lessQuadKey(const QuadKey& lhs, const QuadKey& rhs)
+    {
+        return std::tie(lhs.levelOfDetail, lhs.tileX, lhs.tileY) <
+               std::tie(rhs.levelOfDetail, rhs.tileX, rhs.tileY);
+    }
+
+    // Writes element to stream.
     class ElementWriter : public ElementVisitor
     {
     public:
-        ElementWriter(std::fstream& dataFile) : dataFile_(dataFile)
+        ElementWriter(std::ostream& dataFile) : dataFile_(dataFile)
         {
         }
 
@@ -113,14 +144,14 @@ namespace {
             dataFile_.write(reinterpret_cast<const char*>(&coord.longitude), sizeof(coord.longitude));
         }
 
-        std::fstream& dataFile_;
+        std::ostream& dataFile_;
     };
 
     // Reads element from file stream.
     class ElementReader
     {
     public:
-        ElementReader(std::fstream& dataFile) : dataFile_(dataFile)
+        ElementReader(std::istream& dataFile) : dataFile_(dataFile)
         {
         }
 
@@ -231,20 +262,32 @@ namespace {
             return std::move(tags);
         }
 
-        std::fstream& dataFile_;
+        std::istream& dataFile_;
     };
 }
 
 class PersistentElementStore::PersistentElementStoreImpl
 {
 public:
-    PersistentElementStoreImpl(const std::string& dataPath)
-            : dataPath_(dataPath)
+    PersistentElementStoreImpl(const std::string& dataPath, std::size_t sortBufferSize)
+            : dataPath_(dataPath), sortBufferSize_(sortBufferSize), bufferedSize_(0)
     {
     }
 
+    ~PersistentElementStoreImpl()
+    {
+        closeFiles();
+        removeRuns();
+    }
+
     void store(const Element& element, const QuadKey& quadKey)
     {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (sortBufferSize_ > 0) {
+            buffer(element, quadKey);
+            return;
+        }
+
         ensureFiles(quadKey);
 
         // write element data
@@ -261,19 +304,33 @@ public:
 
     void search(const QuadKey& quadKey, ElementVisitor& visitor)
     {
-        ensureFiles(quadKey);
+        // NOTE elements written to current quadkey may still be buffered.
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            if (quadKey == currentQuadKey_) {
+                dataFile_.flush();
+                indexFile_.flush();
+            }
+        }
+
+        // NOTE search uses own streams, so quadkeys can be searched concurrently.
+        using std::ios;
+        std::ifstream dataFile(getFilePath(quadKey, DataFileExtension), ios::in | ios::binary);
+        std::ifstream indexFile(getFilePath(quadKey, IndexFileExtension), ios::in | ios::binary | ios::ate);
+        if (!dataFile.good() || !indexFile.good())
+            return;
 
-        std::uint32_t count = static_cast<std::uint32_t>(indexFile_.tellg() /
+        std::uint32_t count = static_cast<std::uint32_t>(indexFile.tellg() /
                 (sizeof(std::uint64_t) + sizeof(std::uint32_t)));
 
-        ElementReader reader(dataFile_);
+        ElementReader reader(dataFile);
 
-        indexFile_.seekg(0, std::ios::beg);
+        indexFile.seekg(0, ios::beg);
         for (std::uint32_t i = 0; i < count; ++i) {
             std::uint64_t id;
             std::uint32_t offset;
-            indexFile_.read(reinterpret_cast<char*>(&id), sizeof(id));
-            indexFile_.read(reinterpret_cast<char*>(&offset), sizeof(offset));
+            indexFile.read(reinterpret_cast<char*>(&id), sizeof(id));
+            indexFile.read(reinterpret_cast<char*>(&offset), sizeof(offset));
 
             reader.readElement(id, offset)->accept(visitor);
         }
@@ -285,13 +342,174 @@ public:
         return file.good();
     }
 
+    // Gets revision from file sizes: files are append only. Returns false if quadkey
+    // files are being written as their size is not yet known.
+    bool getRevision(const QuadKey& quadKey, std::uint64_t& revision) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            if (quadKey == currentQuadKey_)
+                return false;
+        }
+
+        using std::ios;
+        std::ifstream dataFile(getFilePath(quadKey, DataFileExtension), ios::in | ios::binary | ios::ate);
+        std::ifstream indexFile(getFilePath(quadKey, IndexFileExtension), ios::in | ios::binary | ios::ate);
+        std::uint64_t dataSize = dataFile.good() ? static_cast<std::uint64_t>(dataFile.tellg()) : 0;
+        std::uint64_t indexSize = indexFile.good() ? static_cast<std::uint64_t>(indexFile.tellg()) : 0;
+
+        // NOTE offsets in data file are 4 bytes.
+        revision = (indexSize << 32) | (dataSize & 0xFFFFFFFF);
+        return true;
+    }
+
     void commit()
     {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (sortBufferSize_ > 0)
+            merge();
+
         closeFiles();
         currentQuadKey_ = QuadKey();
     }
 
 private:
+
+    // Serializes element into sort buffer. Spills buffer to sorted run file when it is full.
+    void buffer(const Element& element, const QuadKey& quadKey)
+    {
+        std::ostringstream stream;
+        ElementWriter visitor(stream);
+        element.accept(visitor);
+
+        SortRecord record = { quadKey, element.id, stream.str() };
+        bufferedSize_ += record.data.size() + sizeof(SortRecord);
+        records_.push_back(std::move(record));
+
+        if (bufferedSize_ >= sortBufferSize_)
+            writeRun();
+    }
+
+    // Sorts buffered records by quadkey keeping input order and writes them to new run file.
+    void writeRun()
+    {
+        sortRecords();
+
+        std::string path = getRunPath(runs_.size());
+        std::ofstream runFile(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!runFile.good())
+            throw std::domain_error("Cannot create sort run file: " + path);
+        runs_.push_back(path);
+
+        for (const auto& record : records_) {
+            std::uint32_t size = static_cast<std::uint32_t>(record.data.size());
+            runFile.write(reinterpret_cast<const char*>(&record.quadKey.levelOfDetail), sizeof(record.quadKey.levelOfDetail));
+            runFile.write(reinterpret_cast<const char*>(&record.quadKey.tileX), sizeof(record.quadKey.tileX));
+            runFile.write(reinterpret_cast<const char*>(&record.quadKey.tileY), sizeof(record.quadKey.tileY));
+            runFile.write(reinterpret_cast<const char*>(&record.id), sizeof(record.id));
+            runFile.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            runFile.write(record.data.data(), size);
+        }
+
+        records_.clear();
+        bufferedSize_ = 0;
+    }
+
+    // Reads next record from run file. Returns false if there are no more records.
+    static bool readRun(std::ifstream& runFile, SortRecord& record)
+    {
+        std::uint32_t size;
+        runFile.read(reinterpret_cast<char*>(&record.quadKey.levelOfDetail), sizeof(record.quadKey.levelOfDetail));
+        runFile.read(reinterpret_cast<char*>(&record.quadKey.tileX), sizeof(record.quadKey.tileX));
+        runFile.read(reinterpret_cast<char*>(&record.quadKey.tileY), sizeof(record.quadKey.tileY));
+        runFile.read(reinterpret_cast<char*>(&record.id), sizeof(record.id));
+        runFile.read(reinterpret_cast<char*>(&size), sizeof(size));
+        if (!runFile.good())
+            return false;
+
+        record.data.resize(size);
+        runFile.read(&record.data[0], size);
+        return runFile.good();
+    }
+
+    // Merges sorted runs and buffered records into quadkey files.
+    void merge()
+    {
+        // all data fit into memory: no need for run files.
+        if (runs_.empty()) {
+            sortRecords();
+            for (const auto& record : records_)
+                write(record.quadKey, record.id, record.data);
+            records_.clear();
+            bufferedSize_ = 0;
+            return;
+        }
+
+        if (!records_.empty())
+            writeRun();
+
+        std::vector<std::unique_ptr<std::ifstream>> runFiles;
+        std::vector<SortRecord> heads(runs_.size());
+        // NOTE ties are resolved by run index which keeps input order.
+        auto greater = [&](std::size_t lhs, std::size_t rhs) {
+            if (lessQuadKey(heads[rhs].quadKey, heads[lhs].quadKey)) return true;
+            if (lessQuadKey(heads[lhs].quadKey, heads[rhs].quadKey)) return false;
+            return lhs > rhs;
+        };
+        std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)> queue(greater);
+
+        for (std::size_t i = 0; i < runs_.size(); ++i) {
+            runFiles.push_back(std::unique_ptr<std::ifstream>(new std::ifstream(runs_[i], std::ios::in | std::ios::binary)));
+            if (readRun(*runFiles[i], heads[i]))
+                queue.push(i);
+        }
+
+        while (!queue.empty()) {
+            std::size_t index = queue.top();
+            queue.pop();
+            write(heads[index].quadKey, heads[index].id, heads[index].data);
+            if (readRun(*runFiles[index], heads[index]))
+                queue.push(index);
+        }
+
+        runFiles.clear();
+        removeRuns();
+    }
+
+    // Writes serialized element data to quadkey files.
+    void write(const QuadKey& quadKey, std::uint64_t id, const std::string& data)
+    {
+        ensureFiles(quadKey);
+
+        std::uint32_t offset = static_cast<std::uint32_t>(dataFile_.tellg());
+        dataFile_.write(data.data(), data.size());
+
+        indexFile_.seekg(0, std::ios::end);
+        indexFile_.write(reinterpret_cast<const char*>(&id), sizeof(id));
+        indexFile_.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    }
+
+    void sortRecords()
+    {
+        std::stable_sort(records_.begin(), records_.end(), [](const SortRecord& lhs, const SortRecord& rhs) {
+            return lessQuadKey(lhs.quadKey, rhs.quadKey);
+        });
+    }
+
+    void removeRuns()
+    {
+        for (const auto& path : runs_)
+            std::remove(path.c_str());
+        runs_.clear();
+    }
+
+    inline std::string getRunPath(std::size_t index) const
+    {
+        std::stringstream ss;
+        ss << dataPath_ << RunFilePrefix << index << RunFileExtension;
+        return ss.str();
+    }
+
     // gets full file path for given quadkey
     inline std::string getFilePath(const QuadKey& quadKey, const std::string& extension) const
     {
@@ -322,15 +540,22 @@ private:
     }
 
     const std::string dataPath_;
-    
+    const std::size_t sortBufferSize_;
+
     QuadKey currentQuadKey_;
+    // NOTE guards write state as search runs concurrently with import.
+    mutable std::mutex lock_;
+
+    std::vector<SortRecord> records_;
+    std::size_t bufferedSize_;
+    std::vector<std::string> runs_;
 
     std::fstream indexFile_;
     std::fstream dataFile_;
 };
 
-PersistentElementStore::PersistentElementStore(const std::string& dataPath, StringTable& stringTable) :
-        ElementStore(stringTable), pimpl_(new PersistentElementStore::PersistentElementStoreImpl(dataPath))
+PersistentElementStore::PersistentElementStore(const std::string& dataPath, StringTable& stringTable, std::size_t sortBufferSize) :
+        ElementStore(stringTable), pimpl_(new PersistentElementStore::PersistentElementStoreImpl(dataPath, sortBufferSize))
 {
 }
 
@@ -353,7 +578,15 @@ bool PersistentElementStore::hasData(const QuadKey& quadKey) const
     return pimpl_->hasData(quadKey);
 }
 
-void PersistentElementStore::commit()
+std::uint64_t PersistentElementStore::getRevision(const QuadKey& quadKey) const
+{
+    std::uint64_t revision;
+    return pimpl_->getRevision(quadKey, revision)
+        ? revision
+        : ElementStore::getRevision(quadKey);
+}
+
+void PersistentElementStore::commitImpl()
 {
     pimpl_->commit();
 }
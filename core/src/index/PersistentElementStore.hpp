@@ -5,6 +5,7 @@
 #include "entities/Element.hpp"
 #include "index/ElementStore.hpp"
 
+#include <cstdint>
 #include <string>
 #include <memory>
 
@@ -14,8 +15,13 @@ namespace utymap { namespace index {
 class PersistentElementStore : public ElementStore
 {
 public:
+    // Creates store. If sort buffer size (in bytes) is positive, elements are written
+    // using external sort: they are buffered and spilled to sorted run files which are
+    // merged on commit, so each quadkey file is written once and sequentially.
+    // Elements stored in this mode are visible only after commit.
     PersistentElementStore(const std::string& path,
-                           utymap::index::StringTable& stringTable);
+                           utymap::index::StringTable& stringTable,
+                           std::size_t sortBufferSize = 0);
 
     ~PersistentElementStore();
 
@@ -24,11 +30,14 @@ public:
 
     bool hasData(const utymap::QuadKey& quadKey) const;
 
-    void commit();
+    // Gets revision based on sizes of quadkey files, so it is the same between sessions.
+    std::uint64_t getRevision(const utymap::QuadKey& quadKey) const;
 
 protected:
     void storeImpl(const utymap::entities::Element& element, const utymap::QuadKey& quadKey);
 
+    void commitImpl();
+
 private:
     class PersistentElementStoreImpl;
     std::unique_ptr<PersistentElementStoreImpl> pimpl_;
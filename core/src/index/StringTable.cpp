@@ -1,7 +1,10 @@
 #include "hashing/MurmurHash3.h"
 #include "StringTable.hpp"
+#include "utils/CoreUtils.hpp"
 
+#include <atomic>
 #include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <memory>
 #include <mutex>
@@ -11,6 +14,74 @@
 using std::ios;
 using namespace utymap::index;
 
+namespace {
+    // Caches strings parsed as doubles. Values are stored as bits in two level array of
+    // atomics, so reads are lock free. Chunks are allocated on first write.
+    class NumberCache
+    {
+        static const std::uint32_t ChunkBits = 12;
+        static const std::uint32_t ChunkSize = 1 << ChunkBits;
+        static const std::uint32_t ChunkCount = 1 << 12;
+        // NOTE signaling NaN with payload which is not produced by parsing.
+        static const std::uint64_t Empty = 0x7ff4dead0000beefULL;
+
+        struct Chunk
+        {
+            Chunk() { for (auto& value : values) value.store(Empty, std::memory_order_relaxed); }
+            std::atomic<std::uint64_t> values[ChunkSize];
+        };
+
+    public:
+        NumberCache() : chunks_(new std::atomic<Chunk*>[ChunkCount])
+        {
+            for (std::uint32_t i = 0; i < ChunkCount; ++i)
+                chunks_[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        ~NumberCache()
+        {
+            for (std::uint32_t i = 0; i < ChunkCount; ++i)
+                delete chunks_[i].load(std::memory_order_relaxed);
+        }
+
+        // Gets cached value or computes and stores it using given function.
+        template <typename Factory>
+        double get(std::uint32_t id, const Factory& factory)
+        {
+            std::uint32_t chunkIndex = id >> ChunkBits;
+            // NOTE ids outside of cache range are not cached.
+            if (chunkIndex >= ChunkCount)
+                return factory();
+
+            Chunk* chunk = chunks_[chunkIndex].load(std::memory_order_acquire);
+            if (chunk != nullptr) {
+                std::uint64_t bits = chunk->values[id & (ChunkSize - 1)].load(std::memory_order_relaxed);
+                if (bits != Empty) {
+                    double value;
+                    std::memcpy(&value, &bits, sizeof(value));
+                    return value;
+                }
+            }
+            else {
+                Chunk* newChunk = new Chunk();
+                if (chunks_[chunkIndex].compare_exchange_strong(chunk, newChunk, std::memory_order_acq_rel))
+                    chunk = newChunk;
+                else
+                    delete newChunk;
+            }
+
+            double value = factory();
+            std::uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            chunk->values[id & (ChunkSize - 1)].store(bits, std::memory_order_relaxed);
+            return value;
+        }
+
+    private:
+        std::unique_ptr<std::atomic<Chunk*>[]> chunks_;
+    };
+}
+
 // Naive implementation of string table: reads all the time string from file; acquires lock
 // TODO optimize it to avoid locks and expensive file reads.
 class StringTable::StringTableImpl
@@ -78,6 +149,11 @@ public:
         return str;
     }
 
+    double getDouble(std::uint32_t id)
+    {
+        return numbers_.get(id, [&]() { return utymap::utils::parseDouble(getString(id)); });
+    }
+
     void flush() { /* TODO */ }
 
 private:
@@ -125,6 +201,7 @@ private:
     std::vector<std::uint32_t> offsets_;
 
     std::mutex lock_;
+    NumberCache numbers_;
 };
 
 StringTable::StringTable(const std::string& path) :
@@ -144,6 +221,11 @@ std::string StringTable::getString(std::uint32_t id)
     return pimpl_->getString(id);
 }
 
+double StringTable::getDouble(std::uint32_t id)
+{
+    return pimpl_->getDouble(id);
+}
+
 void StringTable::flush()
 {
     pimpl_->flush();
@@ -29,6 +29,10 @@ public:
     // Gets original string by id.
     std::string getString(std::uint32_t id);
 
+    // Gets string parsed as double by id or zero if string is not a number.
+    // Parsed values are cached, so it does not read string for the same id again.
+    double getDouble(std::uint32_t id);
+
     // Flushes changes to disk.
     void flush();
 
@@ -3,6 +3,7 @@
 
 #include "mapcss/Color.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <utility>
@@ -22,9 +23,33 @@ public:
     ColorGradient(const GradientData& colors) :
         colors_(colors)
     {
+        if (colors_.empty()) return;
+
+        // NOTE colors are baked into lookup table once as gradient is evaluated for each vertex.
+        lookup_.reserve(LookupSize + 1);
+        for (std::size_t i = 0; i <= LookupSize; ++i)
+            lookup_.push_back(interpolate(static_cast<double>(i) / LookupSize));
     }
 
+    // Gets color for given time using lookup table. Time outside [0, 1] is interpolated.
     inline utymap::mapcss::Color evaluate(double time) const
+    {
+        return time >= 0 && time <= 1
+            ? lookup_[static_cast<std::size_t>(time * LookupSize + 0.5)]
+            : interpolate(time);
+    }
+
+    // Returns true if there is no color specified.
+    inline bool empty() const { return colors_.empty(); }
+
+    // Returns gradient data.
+    inline const GradientData& data() const { return colors_; }
+
+private:
+    // Amount of lookup table intervals. Power of two keeps stops like 25% or 50% exact.
+    static const std::size_t LookupSize = 1024;
+
+    inline utymap::mapcss::Color interpolate(double time) const
     {
         GradientData::size_type index = 0;
         while (index < colors_.size() - 1 && colors_[index].first < time)
@@ -40,11 +65,6 @@ public:
         return interpolate(pairA.second, pairB.second, mu);
     }
 
-    // Returns true if there is no color specified.
-    inline bool empty() const { return colors_.empty(); }
-
-private:
-
     // So far, use linear interpolation algorithm as the fastest.
     inline utymap::mapcss::Color interpolate(const utymap::mapcss::Color& a,
                                              const utymap::mapcss::Color& b,
@@ -54,6 +74,7 @@ private:
     }
 
     GradientData colors_;
+    std::vector<utymap::mapcss::Color> lookup_;
 };
 
 }}
@@ -8,50 +8,77 @@
 #include "utils/CoreUtils.hpp"
 #include "utils/GeoUtils.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <memory>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace utymap { namespace mapcss {
 
-// Represents style for element.
+// Represents style for element. Borrows tags of element which should outlive style
+// and shares immutable declarations, so copying style does not allocate.
 struct Style
 {
     typedef std::uint32_t key_type;
     typedef std::shared_ptr<utymap::mapcss::StyleDeclaration> value_type;
-
-    std::unordered_map<key_type, value_type> declarations;
+    // Declarations sorted by key.
+    typedef std::vector<std::pair<key_type, value_type>> Declarations;
 
     Style(const std::vector<utymap::entities::Tag>& tags,
-          utymap::index::StringTable& stringTable)
-        : tags_(tags), stringTable_(stringTable), declarations()
+          utymap::index::StringTable& stringTable,
+          std::shared_ptr<const Declarations> declarations = nullptr)
+        : tags_(&tags), stringTable_(stringTable), declarations_(declarations)
     {
     }
 
-    inline bool has(key_type key) const
+    // Creates copy of style which uses given tags.
+    Style(const Style& style, const std::vector<utymap::entities::Tag>& tags)
+        : tags_(&tags), stringTable_(style.stringTable_), declarations_(style.declarations_)
     {
-        return declarations.find(key) != declarations.end();
     }
 
-    inline bool has(key_type key, const std::string& value) const
+    // Returns true if style has no declarations.
+    inline bool empty() const
+    {
+        return declarations_ == nullptr || declarations_->empty();
+    }
+
+    inline const Declarations& declarations() const
+    {
+        static const Declarations empty;
+        return declarations_ != nullptr ? *declarations_ : empty;
+    }
+
+    inline const std::vector<utymap::entities::Tag>& tags() const
+    {
+        return *tags_;
+    }
+
+    inline utymap::index::StringTable& stringTable() const
+    {
+        return stringTable_;
+    }
+
+    inline bool has(key_type key) const
     {
-        auto it = declarations.find(key);
-        return it != declarations.end() && *it->second->value() == value;
+        return find(key) != nullptr;
     }
 
-    inline void put(const value_type& declaration)
+    inline bool has(key_type key, const std::string& value) const
     {
-        declarations[declaration->key()] = declaration;
+        auto declaration = find(key);
+        return declaration != nullptr && *(*declaration)->value() == value;
     }
 
     inline value_type get(key_type key) const
     {
-        auto it = declarations.find(key);
-        if (it == declarations.end())
+        auto declaration = find(key);
+        if (declaration == nullptr)
             throw MapCssException(std::string("Cannot find declaration with the key: ") + stringTable_.getString(key));
 
-        return it->second;
+        return *declaration;
     }
 
     // Gets string by given key. Empty string by default
@@ -70,10 +97,23 @@ struct Style
         auto declaration = get(keyId);
 
         return declaration->isEval()
-               ? std::make_shared<std::string>(declaration->evaluate<std::string>(tags_, stringTable_))
+               ? std::make_shared<std::string>(declaration->evaluate<std::string>(*tags_, stringTable_))
                : declaration->value();
     }
 
+    // Gets gradient parsed on load or nullptr if value is not gradient.
+    inline std::shared_ptr<const ColorGradient> getGradient(const std::string& key) const
+    {
+        return getGradient(stringTable_.getId(key));
+    }
+
+    // Gets gradient parsed on load or nullptr if value is not gradient.
+    inline std::shared_ptr<const ColorGradient> getGradient(key_type keyId) const
+    {
+        auto declaration = find(keyId);
+        return declaration != nullptr ? (*declaration)->gradient() : nullptr;
+    }
+
     // Gets double value or zero.
     inline double getValue(const std::string& key,
                            double size = 1,
@@ -92,30 +132,36 @@ struct Style
             return 0;
 
         auto declaration = get(keyId);
-        auto rawValue = declaration->value();
-        char dimen = (*rawValue)[rawValue->size() - 1];
-
-        if (dimen == 'm') {
-            double value = utymap::utils::parseDouble(rawValue->substr(0, rawValue->size() - 1));
-            return coordinate.isValid()
-                ? utymap::utils::GeoUtils::getOffset(coordinate, value)
-                : value;
+        switch (declaration->type()) {
+            case StyleDeclaration::Meters:
+                return coordinate.isValid()
+                    ? utymap::utils::GeoUtils::getOffset(coordinate, declaration->number())
+                    : declaration->number();
+            // relative to size
+            case StyleDeclaration::Percent:
+                return size * declaration->number() * 0.01;
+            case StyleDeclaration::Eval:
+                return declaration->evaluate<double>(*tags_, stringTable_);
+            default:
+                return declaration->number();
         }
+    }
 
-        // relative to size
-        if (dimen == '%') {
-            double value = utymap::utils::parseDouble(rawValue->substr(0, rawValue->size() - 1));
-            return size * value * 0.01;
-        }
+private:
+    // Finds declaration using binary search.
+    inline const value_type* find(key_type key) const
+    {
+        if (declarations_ == nullptr)
+            return nullptr;
 
-        return  declaration->isEval()
-                ? declaration->evaluate<double>(tags_, stringTable_)
-                : utymap::utils::parseDouble(*rawValue);
+        auto it = std::lower_bound(declarations_->begin(), declarations_->end(), key,
+            [](const Declarations::value_type& declaration, key_type key) { return declaration.first < key; });
+        return it != declarations_->end() && it->first == key ? &it->second : nullptr;
     }
 
-private:
+    const std::vector<utymap::entities::Tag>* tags_;
     utymap::index::StringTable& stringTable_;
-    const std::vector<utymap::entities::Tag> tags_;
+    std::shared_ptr<const Declarations> declarations_;
 };
 
 }}
@@ -0,0 +1,84 @@
+#include "mapcss/StyleDeclaration.hpp"
+#include "utils/CoreUtils.hpp"
+#include "utils/GradientUtils.hpp"
+
+#include <limits>
+
+using namespace utymap::index;
+using namespace utymap::mapcss;
+using namespace utymap::utils;
+
+namespace {
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    std::shared_ptr<const StyleEvaluator::Program> compile(const std::string& value, StringTable& stringTable)
+    {
+        // NOTE creating eval grammar is expensive, so it is skipped for plain values.
+        if (value.find("eval(") == std::string::npos)
+            return nullptr;
+
+        auto tree = StyleEvaluator::parse(value);
+        return tree != nullptr ? StyleEvaluator::compile(*tree, stringTable) : nullptr;
+    }
+
+    std::vector<std::string> split(const std::string& value)
+    {
+        std::vector<std::string> values;
+        std::string::size_type start = 0;
+        while (true) {
+            auto end = value.find(',', start);
+            values.push_back(value.substr(start, end - start));
+            if (end == std::string::npos)
+                break;
+            start = end + 1;
+        }
+        return values;
+    }
+}
+
+StyleDeclaration::StyleDeclaration(std::uint32_t key, const std::string& value, StringTable& stringTable,
+                                   std::shared_ptr<const ColorGradient> gradient) :
+    key_(key),
+    value_(std::make_shared<std::string>(value)),
+    program_(gradient == nullptr ? compile(value, stringTable) : nullptr),
+    type_(String),
+    number_(0)
+{
+    if (program_ != nullptr) {
+        type_ = Eval;
+        return;
+    }
+
+    values_ = split(value);
+
+    if (gradient != nullptr) {
+        type_ = Gradient;
+        gradient_ = gradient;
+        return;
+    }
+
+    char dimen = value.empty() ? '\0' : value[value.size() - 1];
+    if (dimen == 'm' || dimen == '%') {
+        double number = parseDouble(value.substr(0, value.size() - 1), NaN);
+        if (number == number) {
+            type_ = dimen == 'm' ? Meters : Percent;
+            number_ = number;
+            return;
+        }
+    }
+
+    double number = parseDouble(value, NaN);
+    if (number == number) {
+        type_ = Number;
+        number_ = number;
+        return;
+    }
+
+    if (!value.empty() && GradientUtils::isGradient(value)) {
+        auto gradient = GradientUtils::parseGradient(value);
+        if (!gradient->empty()) {
+            type_ = Gradient;
+            gradient_ = gradient;
+        }
+    }
+}
@@ -4,12 +4,10 @@
 #include "Exceptions.hpp"
 #include "entities/Element.hpp"
 #include "index/StringTable.hpp"
+#include "mapcss/ColorGradient.hpp"
 #include "mapcss/StyleEvaluator.hpp"
 #include "utils/ElementUtils.hpp"
 
-#include <boost/variant/recursive_variant.hpp>
-#include <boost/variant/apply_visitor.hpp>
-
 #include <cstdint>
 #include <string>
 #include <memory>
@@ -20,12 +18,13 @@ namespace utymap { namespace mapcss {
 // Represents style declaration which support evaluation.
 struct StyleDeclaration
 {
-    StyleDeclaration(std::uint32_t key, const std::string& value) :
-        key_(key), 
-        value_(std::make_shared<std::string>(value)), 
-        tree_(StyleEvaluator::parse(value))
-    {
-    }
+    // Defines type of declaration value detected once on creation.
+    enum Type { String, Number, Meters, Percent, Gradient, Eval };
+
+    // Creates declaration. Value is parsed and eval expression is compiled once using string table.
+    // Gradient parsed before (e.g. loaded from compiled stylesheet) can be given to skip parsing.
+    StyleDeclaration(std::uint32_t key, const std::string& value, utymap::index::StringTable& stringTable,
+                     std::shared_ptr<const ColorGradient> gradient = nullptr);
 
     ~StyleDeclaration() {}
 
@@ -35,8 +34,20 @@ struct StyleDeclaration
     // Gets declaration value.
     inline std::shared_ptr<std::string> value() const { return value_; };
 
+    // Gets type of value.
+    inline Type type() const { return type_; }
+
+    // Gets numeric value without dimension. Zero for non numeric values.
+    inline double number() const { return number_; }
+
+    // Gets parsed gradient or nullptr if value is not gradient.
+    inline std::shared_ptr<const ColorGradient> gradient() const { return gradient_; }
+
+    // Gets comma separated parts of raw value.
+    inline const std::vector<std::string>& values() const { return values_; }
+
     // Gets true if declaration should be evaluated
-    inline bool isEval() const { return tree_ != nullptr; }
+    inline bool isEval() const { return type_ == Eval; }
 
     // Evaluates expression using tags
     template <typename T>
@@ -46,14 +57,17 @@ struct StyleDeclaration
         if (!isEval())
             throw utymap::MapCssException("Cannot evaluate raw value.");
 
-        return StyleEvaluator::evaluate<T>(*tree_, tags, stringTable);
+        return program_->evaluate<T>(tags, stringTable);
     }
 
 private:
-
     const std::uint32_t key_;
     std::shared_ptr<std::string> value_;
-    std::shared_ptr<StyleEvaluator::Tree> tree_;
+    std::shared_ptr<const StyleEvaluator::Program> program_;
+    Type type_;
+    double number_;
+    std::shared_ptr<const ColorGradient> gradient_;
+    std::vector<std::string> values_;
 };
 
 }}
@@ -1,10 +1,12 @@
 #include "mapcss/StyleEvaluator.hpp"
+#include "utils/ElementUtils.hpp"
 
 #include <boost/config/warning_disable.hpp>
 #include <boost/spirit/include/qi.hpp>
 #include <boost/fusion/include/adapt_struct.hpp>
 
 #include <algorithm>
+#include <stdexcept>
 
 using namespace utymap::entities;
 using namespace utymap::index;
@@ -17,6 +19,10 @@ namespace {
     typedef StyleEvaluator::Tree Tree;
     typedef StyleEvaluator::Operation Operation;
     typedef StyleEvaluator::Operand Operand;
+    typedef StyleEvaluator::Program Program;
+
+    // Max stack size of program which is evaluated without allocation.
+    const std::size_t FixedStackSize = 16;
 
     namespace qi = boost::spirit::qi;
     namespace ascii = boost::spirit::ascii;
@@ -58,6 +64,77 @@ namespace {
     };
 }
 
+namespace {
+    // Compiles AST into instructions of stack machine in postfix order.
+    class Compiler : public boost::static_visitor<void>
+    {
+    public:
+        Compiler(std::vector<Program::Instruction>& instructions, StringTable& stringTable) :
+            maxSize(0), instructions_(instructions), stringTable_(stringTable), size_(0)
+        {
+        }
+
+        void operator()(Nil) { push(Program::PushNumber, 0, 0); }
+
+        void operator()(double n) { push(Program::PushNumber, n, 0); }
+
+        void operator()(const std::string& tagKey) { push(Program::PushTag, 0, stringTable_.getId(tagKey)); }
+
+        void operator()(const Signed& s)
+        {
+            boost::apply_visitor(*this, s.operand);
+            if (s.sign == '-')
+                emit(Program::Negate);
+        }
+
+        void operator()(const Tree& tree)
+        {
+            boost::apply_visitor(*this, tree.first);
+            for (const Operation& operation : tree.rest) {
+                boost::apply_visitor(*this, operation.operand);
+                switch (operation.operator_) {
+                    case '+': emit(Program::Add); break;
+                    case '-': emit(Program::Subtract); break;
+                    case '*': emit(Program::Multiply); break;
+                    case '/': emit(Program::Divide); break;
+                    default: throw std::domain_error("Evaluator: unsupported operation.");
+                }
+                --size_;
+            }
+        }
+
+        std::size_t maxSize;
+
+    private:
+        inline void push(Program::OpCode code, double number, std::uint32_t key)
+        {
+            emit(code, number, key);
+            maxSize = std::max(maxSize, ++size_);
+        }
+
+        inline void emit(Program::OpCode code, double number = 0, std::uint32_t key = 0)
+        {
+            Program::Instruction instruction = { code, number, key };
+            instructions_.push_back(instruction);
+        }
+
+        std::vector<Program::Instruction>& instructions_;
+        StringTable& stringTable_;
+        std::size_t size_;
+    };
+
+    // Finds tag which defines string value of expression.
+    struct StringKeyFinder : public boost::static_visitor<const std::string*>
+    {
+        const std::string* operator()(const std::string& tagKey) const { return &tagKey; }
+
+        const std::string* operator()(const Tree& tree) const { return boost::apply_visitor(*this, tree.first); }
+
+        template <typename T>
+        const std::string* operator()(const T&) const { return nullptr; }
+    };
+}
+
 BOOST_FUSION_ADAPT_STRUCT(
     Signed,
     (char, sign)
@@ -91,4 +168,74 @@ std::shared_ptr<Tree> StyleEvaluator::parse(const std::string& expression)
         tree.reset();
     
     return tree;
-}
\ No newline at end of file
+}
+std::shared_ptr<const StyleEvaluator::Program> StyleEvaluator::compile(const Tree& tree, StringTable& stringTable)
+{
+    auto program = std::make_shared<Program>();
+
+    Compiler compiler(program->instructions_, stringTable);
+    compiler(tree);
+    program->stackSize_ = compiler.maxSize;
+
+    const std::string* stringKey = StringKeyFinder()(tree);
+    if (stringKey != nullptr) {
+        program->hasStringKey_ = true;
+        program->stringKey_ = stringTable.getId(*stringKey);
+    }
+
+    return program;
+}
+
+double StyleEvaluator::Program::evaluate(const std::vector<Tag>& tags, StringTable& stringTable, double*) const
+{
+    if (stackSize_ <= FixedStackSize) {
+        double stack[FixedStackSize];
+        return run(tags, stringTable, stack);
+    }
+
+    std::vector<double> stack(stackSize_);
+    return run(tags, stringTable, stack.data());
+}
+
+std::string StyleEvaluator::Program::evaluate(const std::vector<Tag>& tags, StringTable& stringTable, std::string*) const
+{
+    if (!hasStringKey_)
+        throw std::domain_error("Evaluator: unsupported operation.");
+
+    return utymap::utils::getTagValue(stringKey_, tags, stringTable);
+}
+
+double StyleEvaluator::Program::run(const std::vector<Tag>& tags, StringTable& stringTable, double* stack) const
+{
+    std::size_t top = 0;
+    for (const Instruction& instruction : instructions_) {
+        switch (instruction.code) {
+            case PushNumber:
+                stack[top++] = instruction.number;
+                break;
+            case PushTag:
+                stack[top++] = utymap::utils::getTagNumber(instruction.key, tags, stringTable);
+                break;
+            case Negate:
+                stack[top - 1] = -stack[top - 1];
+                break;
+            case Add:
+                --top;
+                stack[top - 1] += stack[top];
+                break;
+            case Subtract:
+                --top;
+                stack[top - 1] -= stack[top];
+                break;
+            case Multiply:
+                --top;
+                stack[top - 1] *= stack[top];
+                break;
+            case Divide:
+                --top;
+                stack[top - 1] /= stack[top];
+                break;
+        }
+    }
+    return stack[0];
+}
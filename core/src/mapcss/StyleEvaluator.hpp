@@ -3,17 +3,13 @@
 
 #include "entities/Element.hpp"
 #include "index/StringTable.hpp"
-#include "utils/CoreUtils.hpp"
-#include "utils/ElementUtils.hpp"
 
 #include <boost/variant/recursive_variant.hpp>
-#include <boost/variant/apply_visitor.hpp>
 
 #include <cstdint>
 #include <string>
 #include <list>
 #include <memory>
-#include <type_traits>
 #include <vector>
 
 namespace utymap { namespace mapcss {
@@ -21,7 +17,7 @@ namespace utymap { namespace mapcss {
 // Represents style declaration which support evaluation.
 struct StyleEvaluator
 {
-    // NOTE has to put these declarations here due to evaluate function implementation
+    // NOTE AST types are declared here as they are used by parser grammar.
     struct Nil {};
     struct Signed;
     struct Tree;
@@ -48,109 +44,49 @@ struct StyleEvaluator
     // Parses expression into AST.
     static std::shared_ptr<Tree> parse(const std::string& expression);
 
-    // Evaluates expression using tags.
-    template <typename T>
-    static T evaluate(const Tree& tree,
-                      const std::vector<utymap::entities::Tag>& tags,
-                      utymap::index::StringTable& stringTable)
+    // Represents expression compiled into instructions of stack machine with resolved tag keys.
+    class Program
     {
-        typedef typename std::conditional<std::is_same<T, std::string>::value, StringEvaluator, DoubleEvaluator>::type EvaluatorType;
-        return EvaluatorType(tags, stringTable)(tree);
-    }
-
-private:
-
-    // Specifies default AST evaluator behaviour.
-    template <typename T>
-    struct Evaluator
-    {
-        typedef T result_type;
-
-        Evaluator(const std::vector<utymap::entities::Tag>& tags,
-            utymap::index::StringTable& stringTable)
-            : tags_(tags), stringTable_(stringTable)  { }
-
-    protected:
-        std::string throwException() const { throw std::domain_error("Evaluator: unsupported operation."); }
-
-        const std::vector<utymap::entities::Tag>& tags_;
-        utymap::index::StringTable& stringTable_;
-    };
-
-    // Evaluates double from AST.
-    struct DoubleEvaluator : public Evaluator<double>
-    {
-        DoubleEvaluator(const std::vector<utymap::entities::Tag>& tags,
-            utymap::index::StringTable& stringTable)
-            : Evaluator(tags, stringTable) { }
-
-        double operator()(Nil) const { return 0; }
-        double operator()(double n) const { return n; }
-
-        double operator()(const Operation& o, double lhs) const
-        {
-            double rhs = boost::apply_visitor(*this, o.operand);
-            switch (o.operator_) {
-            case '+': return lhs + rhs;
-            case '-': return lhs - rhs;
-            case '*': return lhs * rhs;
-            case '/': return lhs / rhs;
-            }
-            return 0;
-        }
-
-        double operator()(const std::string& tagKey) const
+    public:
+        // Evaluates expression using tags.
+        template <typename T>
+        T evaluate(const std::vector<utymap::entities::Tag>& tags,
+                   utymap::index::StringTable& stringTable) const
         {
-            auto keyId = stringTable_.getId(tagKey);
-            return utymap::utils::parseDouble(utymap::utils::getTagValue(keyId, tags_, stringTable_));
+            return evaluate(tags, stringTable, static_cast<T*>(nullptr));
         }
 
-        double operator()(const Signed& s) const
-        {
-            double rhs = boost::apply_visitor(*this, s.operand);
-            switch (s.sign) {
-            case '-': return -rhs;
-            case '+': return +rhs;
-            }
-            return 0;
-        }
+        enum OpCode { PushNumber, PushTag, Negate, Add, Subtract, Multiply, Divide };
 
-        double operator()(const Tree& tree) const
+        // Represents single instruction: number or tag key are used by push instructions only.
+        struct Instruction
         {
-            double state = boost::apply_visitor(*this, tree.first);
-            for (const Operation& oper : tree.rest)
-                state = (*this)(oper, state);
-            return state;
-        }
-    };
+            OpCode code;
+            double number;
+            std::uint32_t key;
+        };
 
-    // Evaluates string from AST.
-    struct StringEvaluator : public Evaluator<std::string>
-    {
-        StringEvaluator(const std::vector<utymap::entities::Tag>& tags,
-            utymap::index::StringTable& stringTable)
-            : Evaluator(tags, stringTable) { }
-
-        std::string operator()(Nil) const { return throwException(); }
-        std::string operator()(double n) const { return throwException(); }
+    private:
+        friend struct StyleEvaluator;
 
-        std::string operator()(const Operation& o, double lhs) const { return throwException(); }
+        double evaluate(const std::vector<utymap::entities::Tag>& tags,
+                        utymap::index::StringTable& stringTable, double*) const;
 
-        std::string operator()(const std::string& tagKey) const
-        {
-            return utymap::utils::getTagValue(stringTable_.getId(tagKey), tags_, stringTable_);
-        }
+        std::string evaluate(const std::vector<utymap::entities::Tag>& tags,
+                             utymap::index::StringTable& stringTable, std::string*) const;
 
-        std::string operator()(const Signed& s) const { return throwException(); }
+        double run(const std::vector<utymap::entities::Tag>& tags,
+                   utymap::index::StringTable& stringTable, double* stack) const;
 
-        std::string operator()(const Tree& tree) const
-        {
-            return boost::apply_visitor(*this, tree.first);
-        }
+        std::vector<Instruction> instructions_;
+        std::size_t stackSize_ = 0;
+        // tag used for string evaluation if expression has string value.
+        bool hasStringKey_ = false;
+        std::uint32_t stringKey_ = 0;
     };
 
-    std::shared_ptr<std::string> value_;
-    std::shared_ptr<Tree> tree_;
+    // Compiles AST into program resolving tag keys using string table.
+    static std::shared_ptr<const Program> compile(const Tree& tree, utymap::index::StringTable& stringTable);
 };
 
 } }
@@ -8,7 +8,16 @@
 #include "utils/CoreUtils.hpp"
 #include "utils/GradientUtils.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <atomic>
 #include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 using namespace utymap::entities;
 using namespace utymap::index;
@@ -23,6 +32,8 @@ struct ConditionType
 {
     uint32_t key;
     uint32_t value;
+    // value parsed as double for numeric comparison.
+    double number;
     OpType type;
 };
 
@@ -32,8 +43,75 @@ struct Filter
     std::unordered_map<uint32_t, Style::value_type> declarations;
 };
 
+// Contains filters for specific element type and level of details. Filters are bucketed by
+// their most selective condition, so only candidates are checked for given element.
+struct FilterIndex
+{
+    // filters in declaration order.
+    std::vector<Filter> filters;
+    // key: tag key, value: indices of filters which require tag with the key.
+    std::unordered_map<uint32_t, std::vector<std::size_t>> byKey;
+    // key: tag key and value, value: indices of filters which require exactly this tag.
+    std::unordered_map<uint64_t, std::vector<std::size_t>> byTag;
+    // indices of filters without conditions.
+    std::vector<std::size_t> unconditional;
+};
+
 // key: level of detais, value: filters for specific element type.
-typedef std::unordered_map<int, std::vector<Filter>> FilterMap;
+typedef std::unordered_map<int, FilterIndex> FilterMap;
+
+inline uint64_t getTagKey(uint32_t key, uint32_t value)
+{
+    return (static_cast<uint64_t>(key) << 32) | value;
+}
+
+// Builds buckets of filters. Equals condition is preferred to others as it matches only
+// one value, otherwise the key used by the least amount of filters is taken.
+void compile(FilterIndex& index)
+{
+    std::unordered_map<uint32_t, std::size_t> keyCounts;
+    std::unordered_map<uint64_t, std::size_t> tagCounts;
+    for (const Filter& filter : index.filters) {
+        for (const ConditionType& condition : filter.conditions) {
+            ++keyCounts[condition.key];
+            if (condition.type == OpType::Equals)
+                ++tagCounts[getTagKey(condition.key, condition.value)];
+        }
+    }
+
+    for (std::size_t i = 0; i < index.filters.size(); ++i) {
+        const auto& conditions = index.filters[i].conditions;
+        if (conditions.empty()) {
+            index.unconditional.push_back(i);
+            continue;
+        }
+
+        const ConditionType* best = nullptr;
+        std::size_t bestCount = 0;
+        for (const ConditionType& condition : conditions) {
+            if (condition.type != OpType::Equals) continue;
+            std::size_t count = tagCounts[getTagKey(condition.key, condition.value)];
+            if (best == nullptr || count < bestCount) {
+                best = &condition;
+                bestCount = count;
+            }
+        }
+
+        if (best != nullptr) {
+            index.byTag[getTagKey(best->key, best->value)].push_back(i);
+            continue;
+        }
+
+        for (const ConditionType& condition : conditions) {
+            std::size_t count = keyCounts[condition.key];
+            if (best == nullptr || count < bestCount) {
+                best = &condition;
+                bestCount = count;
+            }
+        }
+        index.byKey[best->key].push_back(i);
+    }
+}
 
 struct FilterCollection
 {
@@ -44,50 +122,46 @@ struct FilterCollection
     FilterMap canvases;
 };
 
+// Puts declaration keeping declarations sorted by key. Replaces declaration with the same key.
+void put(Style::Declarations& declarations, const Style::value_type& declaration)
+{
+    auto it = std::lower_bound(declarations.begin(), declarations.end(), declaration->key(),
+        [](const Style::Declarations::value_type& d, Style::key_type key) { return d.first < key; });
+    if (it != declarations.end() && it->first == declaration->key())
+        it->second = declaration;
+    else
+        declarations.insert(it, std::make_pair(declaration->key(), declaration));
+}
+
 class StyleBuilder : public ElementVisitor
 {
     typedef std::vector<Tag>::const_iterator TagIterator;
 public:
 
-    StyleBuilder(std::vector<Tag> tags, StringTable& stringTable,
-                 const FilterCollection& filters, int levelOfDetails, bool onlyCheck = false) :
+    StyleBuilder(StringTable& stringTable, const FilterCollection& filters, int levelOfDetails) :
             filters_(filters),
             levelOfDetails_(levelOfDetails),
-            onlyCheck_(onlyCheck),
-            canBuild_(false),
-            style_(tags, stringTable),
+            declarations_(nullptr),
             stringTable_(stringTable)
     {
     }
 
-    void visitNode(const Node& node) { checkOrBuild(node.tags, filters_.nodes); }
-
-    void visitWay(const Way& way) { checkOrBuild(way.tags, filters_.ways); }
+    void visitNode(const Node& node) { build(node.tags, filters_.nodes); }
 
-    void visitArea(const Area& area) { checkOrBuild(area.tags, filters_.areas); }
+    void visitWay(const Way& way) { build(way.tags, filters_.ways); }
 
-    void visitRelation(const Relation& relation) { checkOrBuild(relation.tags, filters_.relations); }
+    void visitArea(const Area& area) { build(area.tags, filters_.areas); }
 
-    inline bool canBuild() { return canBuild_; }
+    void visitRelation(const Relation& relation) { build(relation.tags, filters_.relations); }
 
-    inline Style build()
+    // Returns declarations of matched filters or nullptr if there is no match.
+    inline std::shared_ptr<const Style::Declarations> build()
     {
-        if (onlyCheck_)
-            throw std::domain_error("Cannot build feature for check mode.");
-
-        return style_;
+        return declarations_;
     }
 
 private:
 
-    inline void checkOrBuild(const std::vector<Tag>& tags, const FilterMap& filters)
-    {
-        if (onlyCheck_)
-            check(tags, filters);
-        else
-            build(tags, filters);
-    }
-
     // checks tag's value assuming that the key is already checked.
     inline bool match_tag(const Tag& tag, const ConditionType& condition)
     {
@@ -99,23 +173,13 @@ private:
             case OpType::NotEquals:
                 return tag.value != condition.value;
             case OpType::Less:
-                return compareDoubles(tag.value, condition.value, std::less<double>());
+                return stringTable_.getDouble(tag.value) < condition.number;
             case OpType::Greater:
-                return compareDoubles(tag.value, condition.value, std::greater<double>());
+                return stringTable_.getDouble(tag.value) > condition.number;
         }
         return false;
     }
 
-    // Compares two raw string values using double conversion.
-    template<typename Func>
-    inline bool compareDoubles(std::uint32_t left, std::uint32_t right, Func binaryOp)
-    {
-        double leftValue = utymap::utils::parseDouble(stringTable_.getString(left));
-        double rightValue = utymap::utils::parseDouble(stringTable_.getString(right));
-
-        return binaryOp(leftValue, rightValue);
-    }
-
     // tries to find tag which satisfy condition using binary search.
     bool match_tags(TagIterator begin, TagIterator end, const ConditionType& condition)
     {
@@ -131,53 +195,172 @@ private:
         return false;
     }
 
-    // Builds style object. More expensive to call than check.
-    void build(const std::vector<Tag>& tags, const FilterMap& filters)
+    // Visits filters matched by tags in declaration order.
+    template<typename Visitor>
+    void match(const std::vector<Tag>& tags, const FilterMap& filters, const Visitor& visitor)
     {
         FilterMap::const_iterator iter = filters.find(levelOfDetails_);
-        if (iter != filters.end()) {
-            for (const Filter& filter : iter->second) {
+        if (iter == filters.end())
+            return;
+
+        // mark candidates in bitset: it keeps declaration order without sorting.
+        const FilterIndex& index = iter->second;
+        std::vector<uint64_t> candidates((index.filters.size() + 63) / 64, 0);
+        auto mark = [&](const std::vector<std::size_t>& indices) {
+            for (std::size_t i : indices)
+                candidates[i / 64] |= uint64_t(1) << (i % 64);
+        };
+
+        mark(index.unconditional);
+        for (const Tag& tag : tags) {
+            auto keyIter = index.byKey.find(tag.key);
+            if (keyIter != index.byKey.end())
+                mark(keyIter->second);
+
+            auto tagIter = index.byTag.find(getTagKey(tag.key, tag.value));
+            if (tagIter != index.byTag.end())
+                mark(tagIter->second);
+        }
+
+        for (std::size_t word = 0; word < candidates.size(); ++word) {
+            uint64_t bits = candidates[word];
+            for (std::size_t bit = 0; bits != 0; ++bit, bits >>= 1) {
+                if ((bits & 1) == 0)
+                    continue;
+
+                const Filter& filter = index.filters[word * 64 + bit];
                 bool isMatched = true;
                 for (auto it = filter.conditions.cbegin(); it != filter.conditions.cend() && isMatched; ++it) {
                     isMatched &= match_tags(tags.cbegin(), tags.cend(), *it);
                 }
-                // merge declarations to style
-                if (isMatched) {
-                    canBuild_ = true;
-                    for (const auto& d : filter.declarations) {
-                        style_.put(d.second);
-                    }
-                }
+                if (isMatched)
+                    visitor(filter);
             }
         }
     }
 
-    // Just checks whether style can be created without constructing actual style.
-    void check(const std::vector<Tag>& tags, const FilterMap& filters)
+    // Builds style object.
+    void build(const std::vector<Tag>& tags, const FilterMap& filters)
     {
-        FilterMap::const_iterator iter = filters.find(levelOfDetails_);
-        if (iter != filters.end()) {
-            for (const Filter& filter : iter->second) {
-                bool isMatched = true;
-                for (auto it = filter.conditions.cbegin(); it != filter.conditions.cend() && isMatched; ++it) {
-                    isMatched &= match_tags(tags.cbegin(), tags.cend(), *it);
-                }
-                if (isMatched) {
-                    canBuild_ = true;
-                    return;
-                }
-            }
-        }
+        match(tags, filters, [&](const Filter& filter) {
+            if (declarations_ == nullptr)
+                declarations_ = std::make_shared<Style::Declarations>();
+            // merge declarations to style
+            for (const auto& d : filter.declarations)
+                put(*declarations_, d.second);
+        });
     }
 
     const FilterCollection &filters_;
     int levelOfDetails_;
-    bool onlyCheck_;
-    bool canBuild_;
-    Style style_;
+    std::shared_ptr<Style::Declarations> declarations_;
     StringTable& stringTable_;
 };
 
+
+// Returns index of element type used in style cache key.
+class ElementTypeVisitor : public ElementVisitor
+{
+public:
+    int type = 0;
+
+    void visitNode(const Node&) { type = 0; }
+
+    void visitWay(const Way&) { type = 1; }
+
+    void visitArea(const Area&) { type = 2; }
+
+    void visitRelation(const Relation&) { type = 3; }
+};
+
+// key: element type, level of details and tag ids in element order.
+typedef std::vector<uint32_t> StyleKey;
+
+struct StyleKeyHash
+{
+    std::size_t operator()(const StyleKey& key) const
+    {
+        std::size_t seed = key.size();
+        for (uint32_t value : key)
+            seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+};
+
+// Caches styles in shards guarded by their own locks. Each shard evicts least recently used style.
+class StyleCache
+{
+    typedef std::shared_ptr<const Style::Declarations> Value;
+    typedef std::pair<StyleKey, Value> Entry;
+    static const std::size_t ShardCount = 16;
+
+    struct Shard
+    {
+        std::mutex lock;
+        std::list<Entry> entries;
+        std::unordered_map<StyleKey, std::list<Entry>::iterator, StyleKeyHash> index;
+    };
+
+public:
+
+    explicit StyleCache(std::size_t capacity) :
+        shardCapacity_((capacity + ShardCount - 1) / ShardCount), hits_(0), misses_(0)
+    {
+    }
+
+    // Gets style from cache or creates it using given function.
+    template<typename Factory>
+    Value get(const StyleKey& key, const Factory& factory)
+    {
+        if (shardCapacity_ == 0) {
+            ++misses_;
+            return factory();
+        }
+
+        Shard& shard = shards_[StyleKeyHash()(key) % ShardCount];
+        {
+            std::lock_guard<std::mutex> lock(shard.lock);
+            auto it = shard.index.find(key);
+            if (it != shard.index.end()) {
+                ++hits_;
+                shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+                return it->second->second;
+            }
+        }
+
+        // NOTE style is built outside of lock: concurrent misses may build the same style.
+        ++misses_;
+        auto style = factory();
+
+        std::lock_guard<std::mutex> lock(shard.lock);
+        if (shard.index.find(key) == shard.index.end()) {
+            shard.entries.push_front(Entry(key, style));
+            shard.index[key] = shard.entries.begin();
+            if (shard.entries.size() > shardCapacity_) {
+                shard.index.erase(shard.entries.back().first);
+                shard.entries.pop_back();
+            }
+        }
+        return style;
+    }
+
+    StyleProvider::CacheStatistics getStatistics()
+    {
+        StyleProvider::CacheStatistics statistics = { hits_, misses_, 0 };
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.lock);
+            statistics.size += shard.entries.size();
+        }
+        return statistics;
+    }
+
+private:
+    const std::size_t shardCapacity_;
+    Shard shards_[ShardCount];
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+};
+
 }
 
 // Converts mapcss stylesheet to index optimized representation to speed search query up.
@@ -188,11 +371,20 @@ public:
     FilterCollection filters;
     StringTable& stringTable;
     std::unordered_map<std::string, std::shared_ptr<const ColorGradient>> gradients;
-
-    StyleProviderImpl(const StyleSheet& stylesheet, StringTable& stringTable) :
+    std::mutex gradientsMutex;
+    StyleCache cache;
+    // key: type of keys and prefix, value: keys interned by string table.
+    std::map<std::pair<std::type_index, std::string>, std::shared_ptr<const void>> keys;
+    std::mutex keysMutex;
+
+    StyleProviderImpl(const StyleSheet& stylesheet,
+                      const std::unordered_map<std::string, std::shared_ptr<const ColorGradient>>& parsedGradients,
+                      StringTable& stringTable,
+                      std::size_t cacheSize) :
         stringTable(stringTable),
         filters(),
-        gradients()
+        gradients(parsedGradients),
+        cache(cacheSize)
     {
         filters.nodes.reserve(24);
         filters.ways.reserve(24);
@@ -226,6 +418,7 @@ public:
 
                         c.key = stringTable.getId(condition.key);
                         c.value = stringTable.getId(condition.value);
+                        c.number = utymap::utils::parseDouble(condition.value);
                         filter.conditions.push_back(c);
                     }
 
@@ -234,47 +427,80 @@ public:
                         Declaration declaration = rule.declarations[i];
                         uint32_t key = stringTable.getId(declaration.key);
 
-                        if (utymap::utils::GradientUtils::isGradient(declaration.value))
-                            addGradient(declaration.value);
+                        // NOTE gradients are parsed once per value or taken from compiled stylesheet.
+                        auto gradientPair = gradients.find(declaration.value);
+                        auto styleDeclaration = std::make_shared<StyleDeclaration>(key, declaration.value, stringTable,
+                            gradientPair != gradients.end() ? gradientPair->second : nullptr);
+                        if (styleDeclaration->type() == StyleDeclaration::Gradient)
+                            gradients[declaration.value] = styleDeclaration->gradient();
 
-                        filter.declarations[key] = Style::value_type(new StyleDeclaration(key, declaration.value));
+                        filter.declarations[key] = styleDeclaration;
                     }
 
                     std::sort(filter.conditions.begin(), filter.conditions.end(),
                         [](const ConditionType& c1, const ConditionType& c2) { return c1.key > c2.key; });
                     for (int i = selector.zoom.start; i <= selector.zoom.end; ++i) {
-                        (*filtersPtr)[i].push_back(filter);
+                        (*filtersPtr)[i].filters.push_back(filter);
                     }
                 }
             }
         }
+
+        for (FilterMap* filterMap : { &filters.nodes, &filters.ways, &filters.areas, &filters.relations, &filters.canvases }) {
+            for (auto& pair : *filterMap)
+                compile(pair.second);
+        }
     }
 
-    inline void addGradient(const std::string& key)
+    // Gets declarations for element from cache or builds them. Returns nullptr if there is no style.
+    std::shared_ptr<const Style::Declarations> getDeclarations(const Element& element, int levelOfDetails)
     {
-        if (gradients.find(key) == gradients.end()) {
-            auto gradient = utymap::utils::GradientUtils::parseGradient(key);
-            if (!gradient->empty())
-                gradients[key] = gradient;
+        ElementTypeVisitor typeVisitor;
+        element.accept(typeVisitor);
+
+        // NOTE key buffer is reused to avoid allocation for cached styles.
+        static thread_local StyleKey key;
+        key.clear();
+        key.push_back(static_cast<uint32_t>(typeVisitor.type));
+        key.push_back(static_cast<uint32_t>(levelOfDetails));
+        for (const Tag& tag : element.tags) {
+            key.push_back(tag.key);
+            key.push_back(tag.value);
         }
+
+        return cache.get(key, [&]() {
+            StyleBuilder builder(stringTable, filters, levelOfDetails);
+            element.accept(builder);
+            return builder.build();
+        });
     }
 
     inline std::shared_ptr<const ColorGradient> getGradient(const std::string& key)
     {
-        auto gradientPair = gradients.find(key);
-        if (gradientPair == gradients.end()) {
-            auto gradient = utymap::utils::GradientUtils::parseGradient(key);
-            if (gradient->empty())
-                throw MapCssException("Invalid gradient: " + key);
-            // TODO store it in map in thread safe way
-            return gradient;
+        {
+            std::lock_guard<std::mutex> lock(gradientsMutex);
+            auto gradientPair = gradients.find(key);
+            if (gradientPair != gradients.end())
+                return gradientPair->second;
         }
-        return gradientPair->second;
+
+        // NOTE parse outside of lock: concurrent callers may parse the same key, first one is stored.
+        auto gradient = utymap::utils::GradientUtils::parseGradient(key);
+        if (gradient->empty())
+            throw MapCssException("Invalid gradient: " + key);
+
+        std::lock_guard<std::mutex> lock(gradientsMutex);
+        return gradients.insert(std::make_pair(key, gradient)).first->second;
     }
 };
 
-StyleProvider::StyleProvider(const StyleSheet& stylesheet, StringTable& stringTable) :
-    pimpl_(new StyleProvider::StyleProviderImpl(stylesheet, stringTable))
+StyleProvider::StyleProvider(const StyleSheet& stylesheet, StringTable& stringTable, std::size_t cacheSize) :
+    pimpl_(new StyleProvider::StyleProviderImpl(stylesheet, {}, stringTable, cacheSize))
+{
+}
+
+StyleProvider::StyleProvider(const CompiledStyleSheet& compiled, StringTable& stringTable, std::size_t cacheSize) :
+    pimpl_(new StyleProvider::StyleProviderImpl(compiled.stylesheet, compiled.gradients, stringTable, cacheSize))
 {
 }
 
@@ -284,30 +510,45 @@ StyleProvider::~StyleProvider()
 
 bool StyleProvider::hasStyle(const utymap::entities::Element& element, int levelOfDetails) const
 {
-    StyleBuilder builder(element.tags, pimpl_->stringTable, pimpl_->filters, levelOfDetails, true);
-    element.accept(builder);
-    return builder.canBuild();
+    return pimpl_->getDeclarations(element, levelOfDetails) != nullptr;
 }
 
 Style StyleProvider::forElement(const Element& element, int levelOfDetails) const
 {
-    StyleBuilder builder(element.tags, pimpl_->stringTable, pimpl_->filters, levelOfDetails);
-    element.accept(builder);
-    return std::move(builder.build());
+    return Style(element.tags, pimpl_->stringTable, pimpl_->getDeclarations(element, levelOfDetails));
 }
 
 Style StyleProvider::forCanvas(int levelOfDetails) const
 {
-    Style style({}, pimpl_->stringTable);
-    for (const auto &filter : pimpl_->filters.canvases[levelOfDetails]) {
-        for (const auto &declaration : filter.declarations) {
-            style.put(declaration.second);
+    static const std::vector<Tag> emptyTags;
+    auto declarations = std::make_shared<Style::Declarations>();
+    // NOTE find is used as method is called concurrently.
+    auto pair = pimpl_->filters.canvases.find(levelOfDetails);
+    if (pair != pimpl_->filters.canvases.end()) {
+        for (const auto &filter : pair->second.filters) {
+            for (const auto &declaration : filter.declarations) {
+                put(*declarations, declaration.second);
+            }
         }
     }
-    return std::move(style);
+    return Style(emptyTags, pimpl_->stringTable, declarations);
 }
 
 std::shared_ptr<const ColorGradient> StyleProvider::getGradient(const std::string& key) const
 {
     return pimpl_->getGradient(key);
 }
+
+const void* StyleProvider::getKeys(std::type_index type, const std::string& prefix, const KeysFactory& factory) const
+{
+    std::lock_guard<std::mutex> lock(pimpl_->keysMutex);
+    auto& keys = pimpl_->keys[std::make_pair(type, prefix)];
+    if (keys == nullptr)
+        keys = factory(pimpl_->stringTable, prefix);
+    return keys.get();
+}
+
+StyleProvider::CacheStatistics StyleProvider::getCacheStatistics() const
+{
+    return pimpl_->cache.getStatistics();
+}
@@ -5,10 +5,14 @@
 #include "entities/Element.hpp"
 #include "mapcss/ColorGradient.hpp"
 #include "mapcss/StyleSheet.hpp"
+#include "mapcss/StyleSheetCompiler.hpp"
 #include "mapcss/Style.hpp"
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <memory>
+#include <typeindex>
 
 namespace utymap { namespace mapcss {
 
@@ -16,15 +20,27 @@ namespace utymap { namespace mapcss {
 class StyleProvider
 {
 public:
+    // Represents counters of style cache.
+    struct CacheStatistics
+    {
+        std::uint64_t hits;
+        std::uint64_t misses;
+        std::size_t size;
+    };
 
-    StyleProvider(const utymap::mapcss::StyleSheet&, utymap::index::StringTable&);
+    // Creates style provider which caches up to cacheSize styles of elements.
+    StyleProvider(const utymap::mapcss::StyleSheet&, utymap::index::StringTable&, std::size_t cacheSize = 65536);
+
+    // Creates style provider from compiled stylesheet reusing its parsed gradients.
+    StyleProvider(const utymap::mapcss::CompiledStyleSheet&, utymap::index::StringTable&, std::size_t cacheSize = 65536);
 
     ~StyleProvider();
 
     // Checks whether style is defined for the element.
     bool hasStyle(const utymap::entities::Element&, int levelOfDetails) const;
 
-    // Returs style for given element at given level of details.
+    // Returs style for given element at given level of details or empty style if there is no one.
+    // Style borrows element tags. Declarations are cached by element type, tags and level of details.
     utymap::mapcss::Style forElement(const utymap::entities::Element&, int levelOfDetails) const;
 
     // Returs style for canvas at given level of details.
@@ -33,7 +49,25 @@ public:
     // Returns color gradient for given key.
     std::shared_ptr<const ColorGradient> getGradient(const std::string& key) const;
 
+    // Returns counters of style cache.
+    CacheStatistics getCacheStatistics() const;
+
+    // Returns style keys of type T interned once per style provider. T is created on first
+    // request using string table and prefix, e.g. layer name, which is added to each key.
+    template <typename T>
+    const T& getKeys(const std::string& prefix = "") const
+    {
+        return *static_cast<const T*>(getKeys(typeid(T), prefix,
+            [](utymap::index::StringTable& stringTable, const std::string& prefix) {
+                return std::static_pointer_cast<const void>(std::make_shared<const T>(stringTable, prefix));
+            }));
+    }
+
 private:
+    typedef std::function<std::shared_ptr<const void>(utymap::index::StringTable&, const std::string&)> KeysFactory;
+
+    const void* getKeys(std::type_index type, const std::string& prefix, const KeysFactory& factory) const;
+
     class StyleProviderImpl;
     std::unique_ptr<StyleProviderImpl> pimpl_;
 };
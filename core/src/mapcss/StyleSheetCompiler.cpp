@@ -0,0 +1,210 @@
+#include "hashing/MurmurHash3.h"
+#include "mapcss/StyleSheetCompiler.hpp"
+#include "utils/GradientUtils.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <unordered_set>
+
+using namespace utymap::mapcss;
+using namespace utymap::utils;
+
+namespace {
+    //                                 Compiled stylesheet format
+    //------------------------------------------------------------------------------------------------------|
+    //   DESCRIPTION    |                       DETAILS                                                     |
+    //------------------------------------------------------------------------------------------------------|
+    //     Header       |  Magic (4b), format version (4b) and hash of mapcss sources (8b)                  |
+    //------------------------------------------------------------------------------------------------------|
+    //     Rules        |  Rule count (4b), each rule is list of selectors and list of declarations.        |
+    //                  |  Selector: names, zoom start and end (1b + 1b), conditions as key, operation and  |
+    //                  |  value strings. Declaration: key and value strings. Lists are prefixed by size    |
+    //                  |  (4b), strings are prefixed by length (4b).                                       |
+    //------------------------------------------------------------------------------------------------------|
+    //    Gradients     |  Gradient count (4b), each is declaration value string and list of color stops    |
+    //                  |  represented by time (8b) and RGBA color (4b)                                     |
+    //------------------------------------------------------------------------------------------------------|
+    const std::uint32_t Magic = 0x53434d55; // UMCS
+    const std::uint32_t Version = 1;
+    const std::string ImportPrefix = "@import url(\"";
+
+    template <typename T>
+    void writeValue(std::ostream& stream, T value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeString(std::ostream& stream, const std::string& str)
+    {
+        writeValue(stream, static_cast<std::uint32_t>(str.size()));
+        stream.write(str.data(), str.size());
+    }
+
+    template <typename T>
+    bool readValue(std::istream& stream, T& value)
+    {
+        return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    bool readString(std::istream& stream, std::string& str)
+    {
+        std::uint32_t size;
+        if (!readValue(stream, size))
+            return false;
+        str.resize(size);
+        return size == 0 || static_cast<bool>(stream.read(&str[0], size));
+    }
+
+    // Appends content of the file and its imports in the order they are met.
+    void readSources(const std::string& filePath, const std::string& directory,
+                     std::unordered_set<std::string>& visited, std::string& sources)
+    {
+        if (!visited.insert(filePath).second)
+            return;
+
+        std::ifstream file(filePath);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        sources += content;
+
+        for (auto start = content.find(ImportPrefix); start != std::string::npos;
+                  start = content.find(ImportPrefix, start)) {
+            start += ImportPrefix.size();
+            auto end = content.find('"', start);
+            if (end == std::string::npos)
+                break;
+            readSources(directory + content.substr(start, end - start), directory, visited, sources);
+        }
+    }
+}
+
+CompiledStyleSheet StyleSheetCompiler::compile(const StyleSheet& stylesheet)
+{
+    CompiledStyleSheet compiled;
+    compiled.stylesheet = stylesheet;
+    for (const Rule& rule : stylesheet.rules) {
+        for (const Declaration& declaration : rule.declarations) {
+            if (declaration.value.empty() ||
+                !GradientUtils::isGradient(declaration.value) ||
+                compiled.gradients.find(declaration.value) != compiled.gradients.end())
+                continue;
+
+            auto gradient = GradientUtils::parseGradient(declaration.value);
+            if (!gradient->empty())
+                compiled.gradients[declaration.value] = gradient;
+        }
+    }
+    return compiled;
+}
+
+std::uint64_t StyleSheetCompiler::hash(const std::string& filePath, const std::string& directory)
+{
+    std::unordered_set<std::string> visited;
+    std::string sources;
+    readSources(filePath, directory, visited, sources);
+
+    std::uint64_t hash[2];
+    MurmurHash3_x64_128(sources.data(), static_cast<int>(sources.size()), Version, hash);
+    return hash[0];
+}
+
+void StyleSheetCompiler::write(std::ostream& stream, const CompiledStyleSheet& compiled, std::uint64_t hash)
+{
+    writeValue(stream, Magic);
+    writeValue(stream, Version);
+    writeValue(stream, hash);
+
+    writeValue(stream, static_cast<std::uint32_t>(compiled.stylesheet.rules.size()));
+    for (const Rule& rule : compiled.stylesheet.rules) {
+        writeValue(stream, static_cast<std::uint32_t>(rule.selectors.size()));
+        for (const Selector& selector : rule.selectors) {
+            writeValue(stream, static_cast<std::uint32_t>(selector.names.size()));
+            for (const std::string& name : selector.names)
+                writeString(stream, name);
+            writeValue(stream, selector.zoom.start);
+            writeValue(stream, selector.zoom.end);
+            writeValue(stream, static_cast<std::uint32_t>(selector.conditions.size()));
+            for (const Condition& condition : selector.conditions) {
+                writeString(stream, condition.key);
+                writeString(stream, condition.operation);
+                writeString(stream, condition.value);
+            }
+        }
+        writeValue(stream, static_cast<std::uint32_t>(rule.declarations.size()));
+        for (const Declaration& declaration : rule.declarations) {
+            writeString(stream, declaration.key);
+            writeString(stream, declaration.value);
+        }
+    }
+
+    writeValue(stream, static_cast<std::uint32_t>(compiled.gradients.size()));
+    for (const auto& pair : compiled.gradients) {
+        writeString(stream, pair.first);
+        const auto& data = pair.second->data();
+        writeValue(stream, static_cast<std::uint32_t>(data.size()));
+        for (const auto& stop : data) {
+            writeValue(stream, stop.first);
+            writeValue(stream, static_cast<std::uint32_t>(stop.second));
+        }
+    }
+}
+
+bool StyleSheetCompiler::read(std::istream& stream, std::uint64_t hash, CompiledStyleSheet& compiled)
+{
+    std::uint32_t magic, version, size;
+    std::uint64_t sourceHash;
+    if (!readValue(stream, magic) || magic != Magic ||
+        !readValue(stream, version) || version != Version ||
+        !readValue(stream, sourceHash) || sourceHash != hash ||
+        !readValue(stream, size))
+        return false;
+
+    CompiledStyleSheet result;
+    result.stylesheet.rules.resize(size);
+    for (Rule& rule : result.stylesheet.rules) {
+        if (!readValue(stream, size)) return false;
+        rule.selectors.resize(size);
+        for (Selector& selector : rule.selectors) {
+            if (!readValue(stream, size)) return false;
+            selector.names.resize(size);
+            for (std::string& name : selector.names)
+                if (!readString(stream, name)) return false;
+            if (!readValue(stream, selector.zoom.start) ||
+                !readValue(stream, selector.zoom.end) ||
+                !readValue(stream, size))
+                return false;
+            selector.conditions.resize(size);
+            for (Condition& condition : selector.conditions) {
+                if (!readString(stream, condition.key) ||
+                    !readString(stream, condition.operation) ||
+                    !readString(stream, condition.value))
+                    return false;
+            }
+        }
+        if (!readValue(stream, size)) return false;
+        rule.declarations.resize(size);
+        for (Declaration& declaration : rule.declarations) {
+            if (!readString(stream, declaration.key) || !readString(stream, declaration.value))
+                return false;
+        }
+    }
+
+    if (!readValue(stream, size)) return false;
+    for (std::uint32_t i = 0; i < size; ++i) {
+        std::string value;
+        std::uint32_t count;
+        if (!readString(stream, value) || !readValue(stream, count))
+            return false;
+
+        ColorGradient::GradientData data(count);
+        for (auto& stop : data) {
+            std::uint32_t color;
+            if (!readValue(stream, stop.first) || !readValue(stream, color))
+                return false;
+            stop.second = Color(static_cast<int>(color));
+        }
+        result.gradients[value] = std::make_shared<const ColorGradient>(data);
+    }
+
+    compiled = std::move(result);
+    return true;
+}
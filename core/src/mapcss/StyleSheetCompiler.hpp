@@ -0,0 +1,45 @@
+#ifndef MAPCSS_STYLESHEETCOMPILER_HPP_DEFINED
+#define MAPCSS_STYLESHEETCOMPILER_HPP_DEFINED
+
+#include "mapcss/ColorGradient.hpp"
+#include "mapcss/StyleSheet.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+namespace utymap { namespace mapcss {
+
+// Represents stylesheet with parsed gradients.
+struct CompiledStyleSheet
+{
+    StyleSheet stylesheet;
+    // key: declaration value, value: parsed gradient.
+    std::unordered_map<std::string, std::shared_ptr<const ColorGradient>> gradients;
+};
+
+// Provides the way to store compiled stylesheet in binary form, so it can be
+// loaded on startup without parsing mapcss.
+class StyleSheetCompiler
+{
+public:
+    // Compiles stylesheet: parses gradients used in declarations.
+    static CompiledStyleSheet compile(const StyleSheet& stylesheet);
+
+    // Computes hash of mapcss file content including all imports which
+    // are looked up in given directory.
+    static std::uint64_t hash(const std::string& filePath, const std::string& directory);
+
+    // Writes compiled stylesheet to binary stream.
+    static void write(std::ostream& stream, const CompiledStyleSheet& compiled, std::uint64_t hash);
+
+    // Reads compiled stylesheet from binary stream. Returns false if stream
+    // has different format version or is built from sources with different hash.
+    static bool read(std::istream& stream, std::uint64_t hash, CompiledStyleSheet& compiled);
+};
+
+}}
+#endif // MAPCSS_STYLESHEETCOMPILER_HPP_DEFINED
@@ -0,0 +1,63 @@
+#include "mapcss/StyleSheetDiff.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+using namespace utymap::mapcss;
+
+namespace {
+    // key: selector name and level of details, value: text of applied rules in declaration order.
+    typedef std::map<std::pair<std::string, int>, std::string> RuleSignatures;
+
+    RuleSignatures getSignatures(const StyleSheet& stylesheet)
+    {
+        RuleSignatures signatures;
+        for (const Rule& rule : stylesheet.rules) {
+            std::stringstream declarations;
+            for (const Declaration& declaration : rule.declarations)
+                declarations << declaration << ";";
+            std::string declarationsStr = declarations.str();
+
+            for (const Selector& selector : rule.selectors) {
+                std::stringstream conditions;
+                for (const Condition& condition : selector.conditions)
+                    conditions << "[" << condition << "]";
+                std::string ruleStr = conditions.str() + "{" + declarationsStr + "}";
+
+                int end = std::min(static_cast<int>(selector.zoom.end), StyleSheetDiff::MaxLevelOfDetails);
+                for (const std::string& name : selector.names) {
+                    for (int lod = selector.zoom.start; lod <= end; ++lod)
+                        signatures[std::make_pair(name, lod)] += ruleStr;
+                }
+            }
+        }
+        return signatures;
+    }
+
+    void markAffected(StyleSheetDiff& diff, const RuleSignatures::key_type& key)
+    {
+        diff.affected[key.first] |= std::uint64_t(1) << key.second;
+    }
+}
+
+const int StyleSheetDiff::MaxLevelOfDetails;
+
+StyleSheetDiff StyleSheetDiff::compare(const StyleSheet& oldStyleSheet, const StyleSheet& newStyleSheet)
+{
+    RuleSignatures oldSignatures = getSignatures(oldStyleSheet);
+    RuleSignatures newSignatures = getSignatures(newStyleSheet);
+
+    StyleSheetDiff diff;
+    for (const auto& pair : oldSignatures) {
+        auto newPair = newSignatures.find(pair.first);
+        if (newPair == newSignatures.end() || newPair->second != pair.second)
+            markAffected(diff, pair.first);
+    }
+    for (const auto& pair : newSignatures) {
+        if (oldSignatures.find(pair.first) == oldSignatures.end())
+            markAffected(diff, pair.first);
+    }
+    return diff;
+}
@@ -0,0 +1,41 @@
+#ifndef MAPCSS_STYLESHEETDIFF_HPP_DEFINED
+#define MAPCSS_STYLESHEETDIFF_HPP_DEFINED
+
+#include "mapcss/StyleSheet.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace utymap { namespace mapcss {
+
+// Represents element types and levels of details which styles are changed
+// between two versions of stylesheet.
+struct StyleSheetDiff
+{
+    // Max level of details tracked by diff.
+    static const int MaxLevelOfDetails = 63;
+
+    // key: selector name (node, way, area, relation, canvas),
+    // value: bit mask of affected levels of details.
+    std::map<std::string, std::uint64_t> affected;
+
+    // Compares stylesheets. Element type is affected on level of details if ordered list
+    // of rules applied to this type on this level is changed.
+    static StyleSheetDiff compare(const StyleSheet& oldStyleSheet, const StyleSheet& newStyleSheet);
+
+    // Returns true if there is no affected element type.
+    inline bool empty() const { return affected.empty(); }
+
+    // Checks whether styles of given element type on given level of details are changed.
+    inline bool isAffected(const std::string& name, int levelOfDetails) const
+    {
+        auto pair = affected.find(name);
+        return pair != affected.end() &&
+               levelOfDetails >= 0 && levelOfDetails <= MaxLevelOfDetails &&
+               (pair->second & (std::uint64_t(1) << levelOfDetails)) != 0;
+    }
+};
+
+}}
+#endif // MAPCSS_STYLESHEETDIFF_HPP_DEFINED
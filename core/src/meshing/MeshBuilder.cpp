@@ -5,6 +5,7 @@
 #include "triangle/triangle.h"
 #include "utils/GradientUtils.hpp"
 
+using namespace utymap;
 using namespace utymap::heightmap;
 using namespace utymap::meshing;
 using namespace utymap::utils;
@@ -13,11 +14,14 @@ class MeshBuilder::MeshBuilderImpl
 {
 public:
 
-    MeshBuilderImpl(const ElevationProvider& eleProvider)
-    : eleProvider_(eleProvider) { }
+    MeshBuilderImpl(const ElevationProvider& eleProvider, const CancellationToken& cancelToken)
+    : eleProvider_(eleProvider), cancelToken_(cancelToken) { }
      
     void addPolygon(Mesh& mesh, Polygon& polygon, const MeshBuilder::Options& options) const
     {
+        if (cancelToken_.isCancelled())
+            return;
+
         triangulateio in, mid;
 
         in.numberofpoints = static_cast<int>(polygon.points.size() / 2);
@@ -45,6 +49,10 @@ public:
             fillMesh(&mid, mesh, options);
             mid.trianglearealist = nullptr;
         }
+        // NOTE refinement is the most expensive step, so check cancellation again.
+        else if (cancelToken_.isCancelled()) {
+            mid.trianglearealist = nullptr;
+        }
         else {
 
             mid.trianglearealist = (REAL *)malloc(mid.numberoftriangles * sizeof(REAL));
@@ -98,7 +106,8 @@ public:
 
     inline void addPlane(Mesh& mesh, const Vector2& p1, const Vector2& p2, double ele1, double ele2, const MeshBuilder::Options& options) const
     {
-        auto color = options.gradient->evaluate((NoiseUtils::perlin2D(p1.x, p1.y, options.colorNoiseFreq) + 1) / 2);
+        // NOTE plane has one color, so there is nothing to batch.
+        int color = GradientUtils::getColor(*options.gradient, p1.x, p1.y, options.colorNoiseFreq);
         int index = static_cast<int>(mesh.vertices.size() / 3);
 
         addVertex(mesh, p1, ele1, color, index);
@@ -113,7 +122,8 @@ public:
 
     inline void addTriangle(Mesh& mesh, const Vector3& v0, const Vector3& v1, const Vector3& v2, const MeshBuilder::Options& options, bool hasBackSide) const
     {
-        auto color = options.gradient->evaluate((NoiseUtils::perlin2D(v0.x, v0.z, options.colorNoiseFreq) + 1) / 2);
+        // NOTE triangle has one color, so there is nothing to batch.
+        int color = GradientUtils::getColor(*options.gradient, v0.x, v0.z, options.colorNoiseFreq);
         int startIndex = static_cast<int>(mesh.vertices.size() / 3);
 
         addVertex(mesh, v0, color, startIndex);
@@ -150,7 +160,6 @@ private:
 
         mesh.vertices.reserve(static_cast<std::size_t>(io->numberofpoints * 3 / 2));
         mesh.triangles.reserve(static_cast<std::size_t>(io->numberoftriangles * 3));
-        mesh.colors.reserve(static_cast<std::size_t>(io->numberofpoints));
 
         for (int i = 0; i < io->numberofpoints; i++) {
             double x = io->pointlist[i * 2 + 0];
@@ -168,11 +177,11 @@ private:
             mesh.vertices.push_back(x);
             mesh.vertices.push_back(y);
             mesh.vertices.push_back(ele);
-
-            int color = GradientUtils::getColor(*options.gradient, x, y, options.colorNoiseFreq);
-            mesh.colors.push_back(color);
         }
 
+        GradientUtils::getColors(*options.gradient, io->pointlist,
+            static_cast<std::size_t>(io->numberofpoints), options.colorNoiseFreq, mesh.colors);
+
         for (std::size_t i = 0; i < io->numberoftriangles; i++) {
             mesh.triangles.push_back(triStartIndex + io->trianglelist[i * io->numberofcorners + 1]);
             mesh.triangles.push_back(triStartIndex + io->trianglelist[i * io->numberofcorners + 0]);
@@ -181,10 +190,11 @@ private:
     }
 
     const ElevationProvider& eleProvider_;
+    const CancellationToken& cancelToken_;
 };
 
-MeshBuilder::MeshBuilder(const ElevationProvider& eleProvider) :
-    pimpl_(new MeshBuilder::MeshBuilderImpl(eleProvider))
+MeshBuilder::MeshBuilder(const ElevationProvider& eleProvider, const CancellationToken& cancelToken) :
+    pimpl_(new MeshBuilder::MeshBuilderImpl(eleProvider, cancelToken))
 {
 }
 
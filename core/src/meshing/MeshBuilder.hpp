@@ -1,6 +1,7 @@
 #ifndef MESHING_MESHBUILDER_HPP_DEFINED
 #define MESHING_MESHBUILDER_HPP_DEFINED
 
+#include "CancellationToken.hpp"
 #include "heightmap/ElevationProvider.hpp"
 #include "mapcss/Color.hpp"
 #include "mapcss/ColorGradient.hpp"
@@ -55,8 +56,9 @@ public:
         }
     };
 
-    // Creates builder with given elevation provider.
-    MeshBuilder(const utymap::heightmap::ElevationProvider& eleProvider);
+    // Creates builder with given elevation provider. Polygons are not added once token is cancelled.
+    MeshBuilder(const utymap::heightmap::ElevationProvider& eleProvider,
+                const utymap::CancellationToken& cancelToken = utymap::CancellationToken::none());
     ~MeshBuilder();
 
     // Adds polygon to existing mesh using options provided.
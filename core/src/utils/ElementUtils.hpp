@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <stdexcept>
 
 namespace utymap { namespace utils {
 
@@ -59,23 +60,45 @@ inline bool hasTag(std::uint32_t key,
     return false;
 }
 
-inline std::string getTagValue(std::uint32_t key, 
-                               const std::vector<utymap::entities::Tag>& tags,
-                               utymap::index::StringTable& stringTable)
+// Finds tag with given key using binary search. Returns nullptr if there is no such tag.
+inline const utymap::entities::Tag* findTag(std::uint32_t key,
+                                           const std::vector<utymap::entities::Tag>& tags)
 {
     auto begin = tags.begin();
     auto end = tags.end();
     while (begin < end) {
         const auto middle = begin + (std::distance(begin, end) / 2);
-        if (middle->key == key) 
-            return stringTable.getString(middle->value);
+        if (middle->key == key)
+            return &*middle;
         else if (middle->key > key)
             end = middle;
         else
             begin = middle + 1;
     }
+    return nullptr;
+}
+
+inline std::string getTagValue(std::uint32_t key, 
+                               const std::vector<utymap::entities::Tag>& tags,
+                               utymap::index::StringTable& stringTable)
+{
+    const auto tag = findTag(key, tags);
+    if (tag == nullptr)
+        throw std::domain_error("Cannot find tag:" + stringTable.getString(key));
+
+    return stringTable.getString(tag->value);
+}
+
+// Gets tag value parsed as double. Does not read string if it was already parsed.
+inline double getTagNumber(std::uint32_t key,
+                           const std::vector<utymap::entities::Tag>& tags,
+                           utymap::index::StringTable& stringTable)
+{
+    const auto tag = findTag(key, tags);
+    if (tag == nullptr)
+        throw std::domain_error("Cannot find tag:" + stringTable.getString(key));
 
-    throw std::domain_error("Cannot find tag:" + stringTable.getString(key));
+    return stringTable.getDouble(tag->value);
 }
 
 // Gets mesh name
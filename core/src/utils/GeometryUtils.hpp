@@ -6,6 +6,8 @@
 #include "meshing/Polygon.hpp"
 
 #include <algorithm>
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 namespace utymap { namespace utils {
@@ -96,6 +98,151 @@ namespace utymap { namespace utils {
             visitor(rectangle);
         }
     }
+
+    // Gets squared distance from point to segment using coordinates as cartesian ones.
+    inline double getSquaredSegmentDistance(const utymap::GeoCoordinate& p,
+                                            const utymap::GeoCoordinate& a,
+                                            const utymap::GeoCoordinate& b)
+    {
+        double x = a.longitude, y = a.latitude;
+        double dx = b.longitude - x, dy = b.latitude - y;
+
+        if (dx != 0 || dy != 0) {
+            double t = ((p.longitude - x) * dx + (p.latitude - y) * dy) / (dx * dx + dy * dy);
+            if (t > 1) {
+                x = b.longitude;
+                y = b.latitude;
+            }
+            else if (t > 0) {
+                x += dx * t;
+                y += dy * t;
+            }
+        }
+
+        dx = p.longitude - x;
+        dy = p.latitude - y;
+        return dx * dx + dy * dy;
+    }
+
+    // Simplifies polyline using Douglas-Peucker algorithm. First and last points are always kept.
+    inline std::vector<utymap::GeoCoordinate> simplify(const std::vector<utymap::GeoCoordinate>& coordinates, double tolerance)
+    {
+        if (coordinates.size() < 3 || tolerance <= 0)
+            return coordinates;
+
+        double sqTolerance = tolerance * tolerance;
+        std::vector<bool> markers(coordinates.size(), false);
+        markers.front() = markers.back() = true;
+
+        std::vector<std::pair<std::size_t, std::size_t>> stack;
+        stack.push_back(std::make_pair(0, coordinates.size() - 1));
+        while (!stack.empty()) {
+            auto range = stack.back();
+            stack.pop_back();
+
+            double maxSqDistance = 0;
+            std::size_t index = range.first;
+            for (std::size_t i = range.first + 1; i < range.second; ++i) {
+                double sqDistance = getSquaredSegmentDistance(coordinates[i], coordinates[range.first], coordinates[range.second]);
+                if (sqDistance > maxSqDistance) {
+                    index = i;
+                    maxSqDistance = sqDistance;
+                }
+            }
+
+            if (maxSqDistance > sqTolerance) {
+                markers[index] = true;
+                stack.push_back(std::make_pair(range.first, index));
+                stack.push_back(std::make_pair(index, range.second));
+            }
+        }
+
+        std::vector<utymap::GeoCoordinate> result;
+        for (std::size_t i = 0; i < coordinates.size(); ++i) {
+            if (markers[i])
+                result.push_back(coordinates[i]);
+        }
+        return result;
+    }
+
+    // Simplifies ring which does not repeat first point at the end.
+    // Ring is split at the farthest point from the first one and both parts are simplified.
+    inline std::vector<utymap::GeoCoordinate> simplifyRing(const std::vector<utymap::GeoCoordinate>& coordinates, double tolerance)
+    {
+        if (coordinates.size() < 4 || tolerance <= 0)
+            return coordinates;
+
+        std::size_t split = 0;
+        double maxSqDistance = 0;
+        for (std::size_t i = 1; i < coordinates.size(); ++i) {
+            double sqDistance = getSquaredSegmentDistance(coordinates[i], coordinates[0], coordinates[0]);
+            if (sqDistance > maxSqDistance) {
+                split = i;
+                maxSqDistance = sqDistance;
+            }
+        }
+
+        std::vector<utymap::GeoCoordinate> first(coordinates.begin(), coordinates.begin() + split + 1);
+        std::vector<utymap::GeoCoordinate> second(coordinates.begin() + split, coordinates.end());
+        second.push_back(coordinates[0]);
+
+        auto result = simplify(first, tolerance);
+        auto secondResult = simplify(second, tolerance);
+        // NOTE skip split point and repeated first point.
+        result.insert(result.end(), secondResult.begin() + 1, secondResult.end() - 1);
+        return result;
+    }
+
+    // Checks whether ring which does not repeat first point at the end has self intersections.
+    // NOTE segments are swept by longitude, so only ones with overlapping bounding boxes are tested.
+    inline bool hasSelfIntersections(const std::vector<utymap::GeoCoordinate>& coordinates)
+    {
+        auto orientation = [](const utymap::GeoCoordinate& a, const utymap::GeoCoordinate& b, const utymap::GeoCoordinate& c) {
+            double value = (b.longitude - a.longitude) * (c.latitude - a.latitude) -
+                           (b.latitude - a.latitude) * (c.longitude - a.longitude);
+            return value > 0 ? 1 : (value < 0 ? -1 : 0);
+        };
+
+        std::size_t size = coordinates.size();
+        auto start = [&](std::size_t i) -> const utymap::GeoCoordinate& { return coordinates[i]; };
+        auto end = [&](std::size_t i) -> const utymap::GeoCoordinate& { return coordinates[(i + 1) % size]; };
+        auto minLon = [&](std::size_t i) { return std::min(start(i).longitude, end(i).longitude); };
+        auto maxLon = [&](std::size_t i) { return std::max(start(i).longitude, end(i).longitude); };
+
+        std::vector<std::size_t> segments(size);
+        for (std::size_t i = 0; i < size; ++i)
+            segments[i] = i;
+        std::sort(segments.begin(), segments.end(),
+            [&](std::size_t lhs, std::size_t rhs) { return minLon(lhs) < minLon(rhs); });
+
+        std::vector<std::size_t> active;
+        for (std::size_t i : segments) {
+            double lon = minLon(i);
+            active.erase(std::remove_if(active.begin(), active.end(),
+                [&](std::size_t j) { return maxLon(j) < lon; }), active.end());
+
+            const auto& a = start(i);
+            const auto& b = end(i);
+            for (std::size_t j : active) {
+                // NOTE adjacent segments share a point, so they are skipped.
+                std::size_t distance = i > j ? i - j : j - i;
+                if (distance == 1 || distance == size - 1)
+                    continue;
+
+                const auto& c = start(j);
+                const auto& d = end(j);
+                if (std::max(a.latitude, b.latitude) < std::min(c.latitude, d.latitude) ||
+                    std::max(c.latitude, d.latitude) < std::min(a.latitude, b.latitude))
+                    continue;
+
+                if (orientation(a, b, c) * orientation(a, b, d) < 0 &&
+                    orientation(c, d, a) * orientation(c, d, b) < 0)
+                    return true;
+            }
+            active.push_back(i);
+        }
+        return false;
+    }
 }}
 
 #endif // UTILS_GEOMETRYUTILS_HPP_DEFINED
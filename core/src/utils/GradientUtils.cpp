@@ -291,13 +291,40 @@ Color GradientUtils::parseColor(const std::string& colorStr)
     return colorStr[0] == '#' ? fromHex(colorStr) : fromName(colorStr);
 }
 
+void GradientUtils::getColors(const ColorGradient& gradient,
+                              const double* points, std::size_t count,
+                              double noise, std::vector<int>& colors)
+{
+    std::size_t start = colors.size();
+    // NOTE noise does not change color of single color gradient, so it is not computed.
+    if (gradient.data().size() == 1) {
+        colors.resize(start + count, static_cast<int>(gradient.evaluate(0)));
+        return;
+    }
+
+    colors.resize(start + count);
+    for (std::size_t i = 0; i < count; ++i)
+        colors[start + i] = getColor(gradient, points[i * 2], points[i * 2 + 1], noise);
+}
+
 std::shared_ptr<const ColorGradient> GradientUtils::evaluateGradient(const StyleProvider& styleProvider,
                                                                      const Style &style,
                                                                      const std::string &key)
 {
+    return evaluateGradient(styleProvider, style, style.stringTable().getId(key));
+}
+
+std::shared_ptr<const ColorGradient> GradientUtils::evaluateGradient(const StyleProvider& styleProvider,
+                                                                     const Style &style,
+                                                                     std::uint32_t keyId)
+{
+    auto gradient = style.getGradient(keyId);
+    if (gradient != nullptr)
+        return gradient;
+
     // TODO evaluate gradient using tags
-    auto gradient = style.getString(key);
-    return styleProvider.getGradient(*gradient);
+    auto value = style.getString(keyId);
+    return styleProvider.getGradient(*value);
 }
 
 
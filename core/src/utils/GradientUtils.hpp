@@ -12,6 +12,7 @@
 #include <regex>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace utymap { namespace utils {
 
@@ -34,6 +35,11 @@ public:
                                                                                  const utymap::mapcss::Style& style,
                                                                                  const std::string& key);
 
+    // Gets gradient using interned key.
+    static std::shared_ptr<const utymap::mapcss::ColorGradient> evaluateGradient(const utymap::mapcss::StyleProvider& styleProvider,
+                                                                                 const utymap::mapcss::Style& style,
+                                                                                 std::uint32_t keyId);
+
     // Gets color for specific coordinate using coherent noise function
     static inline utymap::mapcss::Color getColor(const utymap::mapcss::ColorGradient& gradient,
                                                  double x, double y, double noise)
@@ -42,6 +48,11 @@ public:
         return gradient.evaluate(colorTime);
     }
 
+    // Appends colors for points given as array of x, y pairs using coherent noise function.
+    static void getColors(const utymap::mapcss::ColorGradient& gradient,
+                          const double* points, std::size_t count,
+                          double noise, std::vector<int>& colors);
+
 private:
     static const std::regex gradientRegEx;
 };
@@ -5,6 +5,16 @@
 
 #include "test_utils/ElementUtils.hpp"
 
+#include <boost/filesystem/operations.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 using namespace utymap::entities;
 using namespace utymap::utils;
 
@@ -13,6 +23,15 @@ namespace {
 
     // Use global variable as it is used inside lambda which is passed as function.
     bool isCalled;
+    std::atomic<int> loadedCount;
+    std::atomic<int> lastGeneration;
+    std::vector<std::pair<std::string, int>> changedStyles;
+
+    void writeFile(const std::string& path, const std::string& content)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        file << content;
+    }
 
     struct ExportLibFixture {
         ExportLibFixture()
@@ -53,6 +72,8 @@ namespace {
 
         ~ExportLibFixture()
         {
+            if (applicationPtr != nullptr)
+                std::remove(applicationPtr->getCompiledStylePath(TEST_MAPCSS_DEFAULT).c_str());
             ::cleanup();
             std::remove((std::string(TEST_ASSETS_PATH) + "string.idx").c_str());
             std::remove((std::string(TEST_ASSETS_PATH) + "string.dat").c_str());
@@ -120,4 +141,212 @@ BOOST_AUTO_TEST_CASE(GivenElement_WhenAddInMemory_ThenItIsAdded)
     BOOST_CHECK(::hasData(1, 0, 1));
 }
 
+BOOST_AUTO_TEST_CASE(GivenLoadedQuadKey_WhenLoadAgain_ThenSameMeshesAreRestored)
+{
+    ::addToStoreInRange(InMemoryStoreKey, TEST_MAPCSS_DEFAULT, TEST_SHAPE_NE_110M_LAND, 1, 1, callback);
+    auto meshCallback = [](const char* name, const double* vertices, int vertexCount,
+        const int* triangles, int triCount, const int* colors, int colorCount) { loadedCount += vertexCount; };
+    auto elementCallback = [](uint64_t id, const char** tags, int size, const double* vertices,
+        int vertexCount, const char** style, int styleSize) {};
+    auto errorCallback = [](const char* message) { BOOST_FAIL(message); };
+    loadedCount = 0;
+    ::loadQuadKey(TEST_MAPCSS_DEFAULT, 1, 0, 1, meshCallback, elementCallback, errorCallback);
+    int vertexCount = loadedCount;
+    loadedCount = 0;
+
+    ::loadQuadKey(TEST_MAPCSS_DEFAULT, 1, 0, 1, meshCallback, elementCallback, errorCallback);
+
+    BOOST_CHECK_GT(vertexCount, 0);
+    BOOST_CHECK_EQUAL(loadedCount.load(), vertexCount);
+}
+
+BOOST_AUTO_TEST_CASE(GivenTestData_WhenQuadKeysAreLoadedAsync_ThenAllAreLoaded)
+{
+    ::addToStoreInRange(InMemoryStoreKey, TEST_MAPCSS_DEFAULT, TEST_SHAPE_NE_110M_LAND, 1, 1, callback);
+    const std::vector<int> quadKeys = { 0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1 };
+    const std::vector<int> priorities = { 3, 1, 2, 0 };
+    isCalled = false;
+    loadedCount = 0;
+
+    ::loadQuadKeysAsync(TEST_MAPCSS_DEFAULT, quadKeys.data(), priorities.data(), 4,
+        [](const char* name, const double* vertices, int vertexCount,
+           const int* triangles, int triCount, const int* colors, int colorCount) {
+            isCalled = true;
+            BOOST_CHECK_GT(vertexCount, 0);
+        },
+        [](uint64_t id, const char** tags, int size, const double* vertices,
+           int vertexCount, const char** style, int styleSize) {},
+        [](int tileX, int tileY, int levelOfDetail) { ++loadedCount; },
+        [](const char* message) { BOOST_FAIL(message); });
+
+    for (int i = 0; i < 600 && loadedCount < 4; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    BOOST_CHECK_EQUAL(loadedCount.load(), 4);
+    BOOST_CHECK(isCalled);
+}
+
+BOOST_AUTO_TEST_CASE(GivenNegativeCount_WhenQuadKeysAreLoadedAsync_ThenErrorIsReported)
+{
+    const std::vector<int> quadKeys = { 0, 0, 1 };
+    const std::vector<int> priorities = { 0 };
+    isCalled = false;
+
+    ::loadQuadKeysAsync(TEST_MAPCSS_DEFAULT, quadKeys.data(), priorities.data(), -1,
+        [](const char* name, const double* vertices, int vertexCount,
+           const int* triangles, int triCount, const int* colors, int colorCount) {
+            BOOST_FAIL("Unexpected mesh.");
+        },
+        [](uint64_t id, const char** tags, int size, const double* vertices,
+           int vertexCount, const char** style, int styleSize) {},
+        [](int tileX, int tileY, int levelOfDetail) { BOOST_FAIL("Unexpected quadkey."); },
+        [](const char* message) { isCalled = true; });
+
+    BOOST_CHECK(isCalled);
+}
+
+BOOST_AUTO_TEST_CASE(GivenPrefetchedQuadKeys_WhenLoadOne_ThenItIsLoaded)
+{
+    ::addToStoreInRange(InMemoryStoreKey, TEST_MAPCSS_DEFAULT, TEST_SHAPE_NE_110M_LAND, 1, 1, callback);
+    auto errorCallback = [](const char* message) { BOOST_FAIL(message); };
+    isCalled = false;
+
+    ::prefetchQuadKeys(TEST_MAPCSS_DEFAULT, 45, -90, 0, 10, 1, 3, errorCallback);
+    ::loadQuadKey(TEST_MAPCSS_DEFAULT, 1, 0, 1,
+        [](const char* name, const double* vertices, int vertexCount,
+           const int* triangles, int triCount, const int* colors, int colorCount) { isCalled = true; },
+        [](uint64_t id, const char** tags, int size, const double* vertices,
+           int vertexCount, const char** style, int styleSize) {},
+        errorCallback);
+
+    BOOST_CHECK(isCalled);
+}
+
+BOOST_AUTO_TEST_CASE(GivenTestData_WhenQuadKeysAreLoadedProgressive_ThenDetailedGenerationIsLast)
+{
+    ::addToStoreInRange(InMemoryStoreKey, TEST_MAPCSS_DEFAULT, TEST_SHAPE_NE_110M_LAND, 1, 1, callback);
+    const std::vector<int> quadKeys = { 0, 0, 1, 1, 0, 1 };
+    const std::vector<int> priorities = { 1, 0 };
+    loadedCount = 0;
+    lastGeneration = -1;
+
+    ::loadQuadKeysProgressive(TEST_MAPCSS_DEFAULT, quadKeys.data(), priorities.data(), 2,
+        [](int tileX, int tileY, int levelOfDetail, int generation, const char* name,
+           const double* vertices, int vertexCount, const int* triangles, int triCount, const int* colors, int colorCount) {
+            BOOST_CHECK_GT(vertexCount, 0);
+        },
+        [](uint64_t id, const char** tags, int size, const double* vertices,
+           int vertexCount, const char** style, int styleSize) {},
+        [](int tileX, int tileY, int levelOfDetail, int generation) {
+            // NOTE placeholder can be skipped, but never delivered after detailed output.
+            if (tileX == 1) {
+                BOOST_CHECK_GT(generation, lastGeneration.load());
+                lastGeneration = generation;
+            }
+            if (generation == 1)
+                ++loadedCount;
+        },
+        [](const char* message) { BOOST_FAIL(message); });
+
+    for (int i = 0; i < 600 && loadedCount < 2; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    BOOST_CHECK_EQUAL(loadedCount.load(), 2);
+    BOOST_CHECK_EQUAL(lastGeneration.load(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(GivenTestData_WhenQuadKeyIsLoadedCompact_ThenMeshesAreRelativeToQuadKey)
+{
+    ::addToStoreInRange(InMemoryStoreKey, TEST_MAPCSS_DEFAULT, TEST_SHAPE_NE_110M_LAND, 1, 1, callback);
+    auto elementCallback = [](uint64_t id, const char** tags, int size, const double* vertices,
+        int vertexCount, const char** style, int styleSize) {};
+    auto errorCallback = [](const char* message) { BOOST_FAIL(message); };
+    loadedCount = 0;
+    ::loadQuadKey(TEST_MAPCSS_DEFAULT, 1, 0, 1,
+        [](const char* name, const double* vertices, int vertexCount,
+           const int* triangles, int triCount, const int* colors, int colorCount) { loadedCount += vertexCount; },
+        elementCallback, errorCallback);
+    int vertexCount = loadedCount;
+    loadedCount = 0;
+
+    ::loadQuadKeyCompact(TEST_MAPCSS_DEFAULT, 1, 0, 1,
+        [](const char* name, const float* vertices, int vertexCount,
+           const void* triangles, int triCount, int indexSize, const std::uint8_t* colors, int colorCount) {
+            loadedCount += vertexCount;
+            BOOST_CHECK_EQUAL(indexSize, 2);
+            BOOST_CHECK_EQUAL(colorCount * 3, vertexCount);
+            // NOTE quadkey (1, 0, 1) is 180 degrees wide and about 85 degrees high.
+            for (int i = 0; i < vertexCount; i += 3) {
+                BOOST_CHECK(vertices[i] >= 0 && vertices[i] <= 180);
+                BOOST_CHECK(vertices[i + 1] >= 0 && vertices[i + 1] <= 86);
+            }
+        },
+        elementCallback, errorCallback);
+
+    BOOST_CHECK_GT(vertexCount, 0);
+    BOOST_CHECK_EQUAL(loadedCount.load(), vertexCount);
+}
+
+BOOST_AUTO_TEST_CASE(GivenPersistentStoreWithSortBuffer_WhenDataIsAdded_ThenQuadKeyIsLoaded)
+{
+    const char* PersistentStoreKey = "Persistent";
+    boost::filesystem::create_directory("1");
+    ::registerPersistentStore(PersistentStoreKey, "", 1024);
+    ::addToStoreInRange(PersistentStoreKey, TEST_MAPCSS_DEFAULT, TEST_SHAPE_NE_110M_LAND, 1, 1, callback);
+
+    loadQuadKeys(1, 0, 1, 0, 1);
+
+    BOOST_CHECK(::hasData(1, 0, 1));
+    BOOST_CHECK(isCalled);
+    std::remove(applicationPtr->getCompiledStylePath(TEST_MAPCSS_DEFAULT).c_str());
+    ::cleanup();
+    applicationPtr = nullptr;
+    boost::filesystem::remove_all("1");
+}
+
+BOOST_AUTO_TEST_CASE(GivenChangedRule_WhenReloadStylesheet_ThenOnlyItsTypeAndLodsAreReported)
+{
+    std::string stylePath = std::string(TEST_ASSETS_PATH) + "reload.mapcss";
+    writeFile(stylePath, "way|z10-12[highway] { width: 2m; }\n"
+                         "area|z12[building] { height: 10; }");
+    ::registerStylesheet(stylePath.c_str());
+    changedStyles.clear();
+
+    // broken stylesheet should keep old one, so diff below is against initial version.
+    writeFile(stylePath, "way|z10-12[highway] { width: 2m;");
+    isCalled = false;
+    ::reloadStylesheet(stylePath.c_str(),
+        [](const char* type, int lod) { changedStyles.push_back(std::make_pair(type, lod)); },
+        [](const char* message) { isCalled = message != nullptr; });
+    BOOST_CHECK(isCalled);
+    BOOST_CHECK(changedStyles.empty());
+
+    writeFile(stylePath, "way|z10-12[highway] { width: 3m; }\n"
+                         "area|z12[building] { height: 10; }");
+    ::reloadStylesheet(stylePath.c_str(),
+        [](const char* type, int lod) { changedStyles.push_back(std::make_pair(type, lod)); },
+        [](const char* message) { BOOST_CHECK(message == nullptr); });
+
+    std::vector<std::pair<std::string, int>> expected = { { "way", 10 }, { "way", 11 }, { "way", 12 } };
+    BOOST_CHECK(changedStyles == expected);
+    std::remove(applicationPtr->getCompiledStylePath(stylePath).c_str());
+    std::remove(stylePath.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(GivenEmptyInMemoryStores_WhenGetQuadKeyHashInDifferentApplications_ThenHashesAreEqual)
+{
+    const std::string dataPath = "application/";
+    boost::filesystem::create_directory(dataPath);
+    utymap::QuadKey quadKey(16, 35205, 21489);
+    std::uint64_t hashes[2];
+
+    for (int i = 0; i < 2; ++i) {
+        Application application(dataPath.c_str(), TEST_ELEVATION_DIRECTORY, callback);
+        application.registerInMemoryStore(InMemoryStoreKey);
+        application.registerStylesheet(TEST_MAPCSS_DEFAULT);
+        hashes[i] = application.getQuadKeyHash(quadKey, TEST_MAPCSS_DEFAULT);
+    }
+
+    BOOST_CHECK_EQUAL(hashes[0], hashes[1]);
+    boost::filesystem::remove_all(dataPath);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
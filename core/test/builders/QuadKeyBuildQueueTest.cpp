@@ -0,0 +1,69 @@
+#include "QuadKey.hpp"
+#include "builders/QuadKeyBuildQueue.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using namespace utymap;
+using namespace utymap::builders;
+
+BOOST_AUTO_TEST_SUITE(Builders_QuadKeyBuildQueue)
+
+BOOST_AUTO_TEST_CASE(GivenSingleWorker_WhenEnqueueWithPriorities_ThenBuildsInPriorityOrder)
+{
+    std::mutex lock;
+    std::condition_variable condition;
+    bool isReleased = false;
+    std::vector<int> order;
+    QuadKeyBuildQueue queue(1);
+    // blocks worker until all other quadkeys are enqueued.
+    queue.enqueue(QuadKey(16, 0, 0), 0, [&](const QuadKey&) {
+        std::unique_lock<std::mutex> guard(lock);
+        condition.wait(guard, [&]() { return isReleased; });
+    });
+
+    queue.enqueue(QuadKey(16, 3, 0), 3, [&](const QuadKey& quadKey) { order.push_back(quadKey.tileX); });
+    queue.enqueue(QuadKey(16, 1, 0), 1, [&](const QuadKey& quadKey) { order.push_back(quadKey.tileX); });
+    queue.enqueue(QuadKey(16, 4, 0), 3, [&](const QuadKey& quadKey) { order.push_back(quadKey.tileX); });
+    queue.enqueue(QuadKey(16, 2, 0), 2, [&](const QuadKey& quadKey) { order.push_back(quadKey.tileX); });
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        isReleased = true;
+    }
+    condition.notify_all();
+    queue.wait();
+
+    BOOST_CHECK((order == std::vector<int>{ 1, 2, 3, 4 }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenManyWorkers_WhenEnqueueMany_ThenAllAreBuilt)
+{
+    std::atomic<int> count(0);
+    QuadKeyBuildQueue queue(4);
+
+    for (int i = 0; i < 100; ++i)
+        queue.enqueue(QuadKey(16, i, 0), i % 7, [&](const QuadKey&) { ++count; });
+    queue.wait();
+
+    BOOST_CHECK_EQUAL(count.load(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(GivenFailingTask_WhenWait_ThenRethrowsErrorAndRunsOthers)
+{
+    std::atomic<int> count(0);
+    QuadKeyBuildQueue queue(2);
+
+    queue.enqueue(QuadKey(16, 0, 0), 0, [](const QuadKey&) { throw std::domain_error("failed"); });
+    for (int i = 1; i < 10; ++i)
+        queue.enqueue(QuadKey(16, i, 0), 1, [&](const QuadKey&) { ++count; });
+
+    BOOST_CHECK_THROW(queue.wait(), std::domain_error);
+    BOOST_CHECK_EQUAL(count.load(), 9);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,81 @@
+#include "QuadKey.hpp"
+#include "builders/QuadKeyBuilder.hpp"
+#include "entities/Node.hpp"
+#include "index/GeoStore.hpp"
+#include "index/InMemoryElementStore.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_utils/DependencyProvider.hpp"
+#include "test_utils/ElementUtils.hpp"
+
+#include <memory>
+
+using namespace utymap;
+using namespace utymap::builders;
+using namespace utymap::entities;
+using namespace utymap::index;
+using namespace utymap::meshing;
+
+namespace {
+    const std::string StoreKey = "InMemory";
+    const std::string stylesheet = "node|z1[amenity] { builders: counter,unknown; }";
+
+    // Counts visited nodes.
+    struct CounterBuilder : public ElementBuilder
+    {
+        CounterBuilder(const BuilderContext& context, int& times) :
+            ElementBuilder(context), times(times) { }
+
+        void visitNode(const Node&) { ++times; }
+        void visitWay(const Way&) { }
+        void visitArea(const Area&) { }
+        void visitRelation(const Relation&) { }
+        void complete() { }
+
+        int& times;
+    };
+
+    struct Builders_QuadKeyBuilderFixture
+    {
+        Builders_QuadKeyBuilderFixture() :
+            dependencyProvider(),
+            geoStore(*dependencyProvider.getStringTable()),
+            quadKeyBuilder(geoStore, *dependencyProvider.getStringTable())
+        {
+            geoStore.registerStore(StoreKey, std::make_shared<InMemoryElementStore>(*dependencyProvider.getStringTable()));
+
+            Node node = ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(), 1,
+                { { "amenity", "bench" } });
+            node.coordinate = { 5, 5 };
+            geoStore.add(StoreKey, node, LodRange(1, 1), *dependencyProvider.getStyleProvider(stylesheet));
+        }
+
+        DependencyProvider dependencyProvider;
+        GeoStore geoStore;
+        QuadKeyBuilder quadKeyBuilder;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(Builders_QuadKeyBuilder, Builders_QuadKeyBuilderFixture)
+
+BOOST_AUTO_TEST_CASE(GivenMultipleBuilders_WhenBuild_ThenKnownAndExternalBuildersAreUsed)
+{
+    int counterTimes = 0, externalTimes = 0;
+    quadKeyBuilder.registerElementBuilder("counter", [&](const BuilderContext& context) {
+        return std::make_shared<CounterBuilder>(context, counterTimes);
+    });
+
+    quadKeyBuilder.build(QuadKey(1, 1, 0), *dependencyProvider.getStyleProvider(stylesheet),
+        *dependencyProvider.getElevationProvider(),
+        [](const Mesh&) {},
+        [&](const Element& element) {
+            BOOST_CHECK_EQUAL(element.id, 1);
+            ++externalTimes;
+        });
+
+    BOOST_CHECK_EQUAL(counterTimes, 1);
+    BOOST_CHECK_EQUAL(externalTimes, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
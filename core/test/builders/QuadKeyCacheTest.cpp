@@ -0,0 +1,106 @@
+#include "QuadKey.hpp"
+#include "builders/QuadKeyCache.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <string>
+
+using namespace utymap;
+using namespace utymap::builders;
+
+namespace {
+    // NOTE cache file path is built from level of detail and quadkey code.
+    const std::string CacheFiles[] = { "2-00.cache", "2-01.cache", "2-02.cache", "2-03.cache" };
+    // NOTE cache file has header of 20 bytes.
+    const std::size_t FileSize = 24;
+
+    struct Builders_QuadKeyCacheFixture
+    {
+        ~Builders_QuadKeyCacheFixture()
+        {
+            for (const auto& cacheFile : CacheFiles)
+                std::remove(cacheFile.c_str());
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(Builders_QuadKeyCache, Builders_QuadKeyCacheFixture)
+
+BOOST_AUTO_TEST_CASE(GivenStoredData_WhenGetWithSameHash_ThenReturnsData)
+{
+    QuadKeyCache cache("", 1024);
+    std::string data;
+
+    cache.put(QuadKey(2, 1, 1), 42, "mesh");
+
+    BOOST_CHECK(cache.get(QuadKey(2, 1, 1), 42, data));
+    BOOST_CHECK_EQUAL(data, "mesh");
+}
+
+BOOST_AUTO_TEST_CASE(GivenStoredData_WhenGetWithAnotherHashOrQuadKey_ThenReturnsFalse)
+{
+    QuadKeyCache cache("", 1024);
+    std::string data;
+
+    cache.put(QuadKey(2, 1, 1), 42, "mesh");
+
+    BOOST_CHECK(!cache.get(QuadKey(2, 1, 1), 43, data));
+    BOOST_CHECK(!cache.get(QuadKey(2, 1, 0), 42, data));
+}
+
+BOOST_AUTO_TEST_CASE(GivenFullMemory_WhenPut_ThenLeastRecentlyUsedIsEvicted)
+{
+    QuadKeyCache cache("", 8);
+    std::string data;
+
+    cache.put(QuadKey(2, 0, 0), 1, "1111");
+    cache.put(QuadKey(2, 1, 0), 1, "2222");
+    cache.get(QuadKey(2, 0, 0), 1, data);
+    cache.put(QuadKey(2, 0, 1), 1, "3333");
+
+    BOOST_CHECK(cache.get(QuadKey(2, 0, 0), 1, data));
+    BOOST_CHECK(!cache.get(QuadKey(2, 1, 0), 1, data));
+    BOOST_CHECK(cache.get(QuadKey(2, 0, 1), 1, data));
+}
+
+BOOST_AUTO_TEST_CASE(GivenDataOnDisk_WhenGetFromAnotherCache_ThenReturnsData)
+{
+    std::string data;
+    QuadKeyCache("./", 1024).put(QuadKey(2, 1, 1), 42, "mesh");
+
+    QuadKeyCache cache("./", 1024);
+
+    BOOST_CHECK(cache.get(QuadKey(2, 1, 1), 42, data));
+    BOOST_CHECK_EQUAL(data, "mesh");
+    BOOST_CHECK(!cache.get(QuadKey(2, 1, 1), 43, data));
+}
+
+BOOST_AUTO_TEST_CASE(GivenFullDisk_WhenPut_ThenLeastRecentlyUsedFileIsEvicted)
+{
+    std::string data;
+    {
+        // NOTE memory tier is disabled, so all reads are made from disk.
+        QuadKeyCache cache("./", 0, 2 * FileSize);
+        cache.put(QuadKey(2, 0, 0), 1, "1111");
+        cache.put(QuadKey(2, 1, 0), 1, "2222");
+        cache.get(QuadKey(2, 0, 0), 1, data);
+        cache.put(QuadKey(2, 0, 1), 1, "3333");
+    }
+
+    QuadKeyCache cache("./", 0);
+
+    BOOST_CHECK(cache.get(QuadKey(2, 0, 0), 1, data));
+    BOOST_CHECK(!cache.get(QuadKey(2, 1, 0), 1, data));
+    BOOST_CHECK(cache.get(QuadKey(2, 0, 1), 1, data));
+}
+
+BOOST_AUTO_TEST_CASE(GivenTooBigData_WhenPut_ThenItIsNotKeptOnDisk)
+{
+    std::string data;
+    QuadKeyCache("./", 0, FileSize).put(QuadKey(2, 1, 1), 42, "too big mesh");
+
+    BOOST_CHECK(!QuadKeyCache("./", 0).get(QuadKey(2, 1, 1), 42, data));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,63 @@
+#include "QuadKey.hpp"
+#include "builders/QuadKeyPredictor.hpp"
+#include "utils/GeoUtils.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <limits>
+
+using namespace utymap;
+using namespace utymap::builders;
+using namespace utymap::utils;
+
+namespace {
+    const int LevelOfDetail = 16;
+    const GeoCoordinate Position(52.53, 13.38);
+}
+
+BOOST_AUTO_TEST_SUITE(Builders_QuadKeyPredictor)
+
+BOOST_AUTO_TEST_CASE(GivenMovementToEast_WhenPredict_ThenEastNeighbourIsFirst)
+{
+    QuadKey current = GeoUtils::latLonToQuadKey(Position, LevelOfDetail);
+
+    auto quadKeys = QuadKeyPredictor::predict(Position, 0, 0.001, LevelOfDetail, 4);
+
+    BOOST_REQUIRE_EQUAL(quadKeys.size(), 4);
+    BOOST_CHECK(quadKeys[0] == QuadKey(LevelOfDetail, current.tileX + 1, current.tileY));
+    BOOST_CHECK(quadKeys[1] == QuadKey(LevelOfDetail, current.tileX + 2, current.tileY));
+}
+
+BOOST_AUTO_TEST_CASE(GivenNoMovement_WhenPredict_ThenReturnsNeighbours)
+{
+    QuadKey current = GeoUtils::latLonToQuadKey(Position, LevelOfDetail);
+
+    auto quadKeys = QuadKeyPredictor::predict(Position, 0, 0, LevelOfDetail, 100);
+
+    BOOST_CHECK_EQUAL(quadKeys.size(), 8);
+    BOOST_CHECK(std::find(quadKeys.begin(), quadKeys.end(), current) == quadKeys.end());
+}
+
+BOOST_AUTO_TEST_CASE(GivenBudget_WhenPredict_ThenReturnsNoMoreQuadKeys)
+{
+    auto quadKeys = QuadKeyPredictor::predict(Position, 0.01, 0.01, LevelOfDetail, 3);
+
+    BOOST_CHECK_EQUAL(quadKeys.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(GivenInfiniteSpeed_WhenPredict_ThenReturnsNeighbours)
+{
+    auto quadKeys = QuadKeyPredictor::predict(Position, 0, std::numeric_limits<double>::infinity(), LevelOfDetail, 100);
+
+    BOOST_CHECK_EQUAL(quadKeys.size(), 8);
+}
+
+BOOST_AUTO_TEST_CASE(GivenHugeSpeed_WhenPredict_ThenPredictionEnds)
+{
+    auto quadKeys = QuadKeyPredictor::predict(Position, 1e150, 1e150, LevelOfDetail, 100);
+
+    BOOST_CHECK_LE(quadKeys.size(), 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
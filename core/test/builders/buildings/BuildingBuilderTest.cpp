@@ -90,4 +90,24 @@ BOOST_AUTO_TEST_CASE(GivenRelationWithHole_WhenVisitRelation_ThenMeshIsBuilt)
     BOOST_CHECK(isCalled);
 }
 
+BOOST_AUTO_TEST_CASE(GivenFootprintOnly_WhenVisitArea_ThenMeshHasNoRoof)
+{
+    QuadKey quadKey(1, 1, 0);
+    std::size_t detailedSize = 0, footprintSize = 0;
+    Area building = ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), 0, { { "building", "yes" } },
+        { { 10, 0 }, { 10, 10 }, { 0, 10 }, { 0, 0 } });
+    auto detailedContext = dependencyProvider.createBuilderContext(quadKey, stylesheet,
+        [&](const Mesh& mesh) { detailedSize = mesh.triangles.size(); });
+    auto footprintContext = dependencyProvider.createBuilderContext(quadKey, stylesheet,
+        [&](const Mesh& mesh) { footprintSize = mesh.triangles.size(); });
+    BuildingBuilder detailedBuilder(*detailedContext);
+    BuildingBuilder footprintBuilder(*footprintContext, true);
+
+    detailedBuilder.visitArea(building);
+    footprintBuilder.visitArea(building);
+
+    BOOST_CHECK_GT(footprintSize, 0);
+    BOOST_CHECK_LT(footprintSize, detailedSize);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
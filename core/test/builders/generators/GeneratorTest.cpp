@@ -29,8 +29,8 @@ namespace {
         Builders_Generators_GeneratorFixture() :
             dependencyProvider(),
             mesh(""),
-            style(dependencyProvider.getStyleProvider(stylesheet)
-            ->forElement(ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(), 0, { { "natural", "tree" } }), 1)),
+            node(ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(), 0, { { "natural", "tree" } })),
+            style(dependencyProvider.getStyleProvider(stylesheet)->forElement(node, 1)),
             builderContext(
             QuadKey{ 1, 1, 1 },
             *dependencyProvider.getStyleProvider(stylesheet),
@@ -44,6 +44,7 @@ namespace {
 
         DependencyProvider dependencyProvider;
         Mesh mesh;
+        Node node;
         Style style;
         BuilderContext builderContext;
         MeshContext meshContext;
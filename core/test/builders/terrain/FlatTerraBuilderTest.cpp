@@ -0,0 +1,42 @@
+#include "QuadKey.hpp"
+#include "builders/BuilderContext.hpp"
+#include "builders/terrain/FlatTerraBuilder.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_utils/DependencyProvider.hpp"
+
+using namespace utymap;
+using namespace utymap::builders;
+using namespace utymap::meshing;
+
+namespace {
+    const std::string stylesheet = "canvas|z1 { color:gradient(red); }";
+
+    struct Builders_Terrain_FlatTerraBuilderFixture
+    {
+        DependencyProvider dependencyProvider;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(Builders_Terrain_FlatTerraBuilder, Builders_Terrain_FlatTerraBuilderFixture)
+
+BOOST_AUTO_TEST_CASE(GivenQuadKey_WhenComplete_ThenTerrainPlaneIsBuilt)
+{
+    bool isCalled = false;
+    auto context = dependencyProvider.createBuilderContext(QuadKey(1, 0, 0), stylesheet,
+        [&](const Mesh& mesh) {
+            isCalled = true;
+            BOOST_CHECK_EQUAL(mesh.name, "terrain");
+            BOOST_CHECK_EQUAL(mesh.vertices.size(), 4 * 3);
+            BOOST_CHECK_EQUAL(mesh.triangles.size(), 2 * 3);
+            BOOST_CHECK_EQUAL(mesh.colors.size(), 4);
+        });
+    FlatTerraBuilder builder(*context);
+
+    builder.complete();
+
+    BOOST_CHECK(isCalled);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -24,6 +24,7 @@ namespace {
     {
         Builders_Terrain_TerraExtrasFixture():
             dependencyProvider(),
+            area(),
             builderContext(
                 QuadKey(16, 0, 0),
                 *dependencyProvider.getStyleProvider(stylesheet),
@@ -47,7 +48,7 @@ namespace {
 
         Style generateStyle()
         {
-            Area area = ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), 0, 
+            area = ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), 0, 
                 { { "amenity", "forest" } },
                 { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } });
             return dependencyProvider.getStyleProvider(stylesheet)->forElement(area, 16);
@@ -66,6 +67,7 @@ namespace {
         }
 
         DependencyProvider dependencyProvider;
+        Area area;
         BuilderContext builderContext;
         bool isVerified;
     };   
@@ -1,4 +1,4 @@
-#define TEST_ASSETS_PATH "_TEST_ASSETS_PATH_"
+#define TEST_ASSETS_PATH "/root/repo/core/test/test_assets/"
 
 #define TEST_EXTERNAL_ASSETS_PATH TEST_ASSETS_PATH "../../../unity/demo/Assets/Resources/"
 
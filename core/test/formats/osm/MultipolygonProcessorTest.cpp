@@ -268,6 +268,31 @@ BOOST_AUTO_TEST_CASE(GivenMultiplyOuterAndMultiplyInner_WhenProcess_ThenReturnCo
     BOOST_CHECK_EQUAL(7, relation->elements.size());
 }
 
+BOOST_AUTO_TEST_CASE(GivenIslandInsideInner_WhenProcess_ThenIslandIsOuter)
+{
+    RelationMembers relationMembers = createRelationMembers({
+        std::make_tuple(1, "w", "outer"),
+        std::make_tuple(2, "w", "inner"),
+        std::make_tuple(3, "w", "outer")
+    });
+    context.areaMap[1] = createElement<Area>({ { 0, 0 }, { 0, 10 }, { 10, 10 }, { 10, 0 }, { 0, 0 } });
+    context.areaMap[2] = createElement<Area>({ { 2, 2 }, { 2, 8 }, { 8, 8 }, { 8, 2 }, { 2, 2 } });
+    context.areaMap[3] = createElement<Area>({ { 4, 4 }, { 4, 6 }, { 6, 6 }, { 6, 4 }, { 4, 4 } });
+    MultipolygonProcessor processor(*createRelation(), relationMembers, context,
+        std::bind(&Formats_Osm_MultipolygonProcessorFixture::resolve, this, std::placeholders::_1));
+
+    processor.process();
+
+    auto relation = context.relationMap[0];
+    BOOST_CHECK_EQUAL(3, relation->elements.size());
+    BOOST_CHECK(ensureExpectedOrientation(context.areaMap[1]->coordinates) ==
+        reinterpret_cast<const Area&>(*relation->elements[0]).coordinates);
+    BOOST_CHECK(ensureExpectedOrientation(context.areaMap[2]->coordinates, false) ==
+        reinterpret_cast<const Area&>(*relation->elements[1]).coordinates);
+    BOOST_CHECK(ensureExpectedOrientation(context.areaMap[3]->coordinates) ==
+        reinterpret_cast<const Area&>(*relation->elements[2]).coordinates);
+}
+
 // Reproducing crash.
 BOOST_AUTO_TEST_CASE(GivenSpecificFourOuter_WhenProcess_ThenDoesNotCrash)
 {
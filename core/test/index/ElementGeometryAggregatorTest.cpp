@@ -0,0 +1,80 @@
+#include "QuadKey.hpp"
+#include "entities/Area.hpp"
+#include "index/ElementGeometryAggregator.hpp"
+#include "utils/GeometryUtils.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_utils/DependencyProvider.hpp"
+#include "test_utils/ElementUtils.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace utymap;
+using namespace utymap::entities;
+using namespace utymap::index;
+
+namespace {
+    struct Index_ElementGeometryAggregatorFixture
+    {
+        DependencyProvider dependencyProvider;
+
+        // Aggregates the same areas in two quadkeys and returns areas of blocks.
+        std::vector<double> aggregate(ElementGeometryAggregator& aggregator)
+        {
+            auto& stringTable = *dependencyProvider.getStringTable();
+            for (int i = 0; i < 10; ++i) {
+                double offset = i * 0.6;
+                Area area = ElementUtils::createElement<Area>(stringTable, i, { { "test", "Foo" } },
+                    { { 10, 10 + offset }, { 10.5, 10 + offset }, { 10.5, 10.5 + offset }, { 10, 10.5 + offset } });
+                aggregator.add(area, QuadKey(1, 1, 0), "block", 0.2);
+                aggregator.add(area, QuadKey(2, 2, 1), "block", 0.2);
+            }
+
+            std::vector<double> areas;
+            aggregator.flush([&](const Element& element, const QuadKey&) {
+                areas.push_back(utymap::utils::getArea(static_cast<const Area&>(element).coordinates));
+            });
+            return areas;
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(Index_ElementGeometryAggregator, Index_ElementGeometryAggregatorFixture)
+
+BOOST_AUTO_TEST_CASE(GivenNoMemoryBudget_WhenFlush_ThenResultIsTheSameAsInMemory)
+{
+    ElementGeometryAggregator inMemory;
+    ElementGeometryAggregator spilled(0);
+
+    auto expected = aggregate(inMemory);
+    auto actual = aggregate(spilled);
+
+    BOOST_CHECK_EQUAL(expected.size(), 2);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(GivenSeparateClusters_WhenFlush_ThenEachBlockHasTagsOfItsLargestPart)
+{
+    auto& stringTable = *dependencyProvider.getStringTable();
+    ElementGeometryAggregator aggregator;
+    aggregator.add(ElementUtils::createElement<Area>(stringTable, 1, { { "color", "red" } },
+        { { 10, 10 }, { 13, 10 }, { 13, 13 }, { 10, 13 } }), QuadKey(1, 1, 0), "block", 0.2);
+    aggregator.add(ElementUtils::createElement<Area>(stringTable, 2, { { "color", "blue" } },
+        { { 20, 20 }, { 21.5, 20 }, { 21.5, 21.5 }, { 20, 21.5 } }), QuadKey(1, 1, 0), "block", 0.2);
+
+    std::vector<std::pair<double, std::uint32_t>> blocks;
+    aggregator.flush([&](const Element& element, const QuadKey&) {
+        blocks.push_back(std::make_pair(static_cast<const Area&>(element).coordinates[0].latitude,
+                                        element.tags[0].value));
+    });
+
+    BOOST_REQUIRE_EQUAL(blocks.size(), 2);
+    std::sort(blocks.begin(), blocks.end());
+    BOOST_CHECK_EQUAL(blocks[0].second, stringTable.getId("red"));
+    BOOST_CHECK_EQUAL(blocks[1].second, stringTable.getId("blue"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
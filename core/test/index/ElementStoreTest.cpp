@@ -5,12 +5,17 @@
 #include "entities/Area.hpp"
 #include "entities/Relation.hpp"
 #include "index/ElementStore.hpp"
+#include "utils/GeometryUtils.hpp"
 
 #include <boost/test/unit_test.hpp>
 
 #include "test_utils/DependencyProvider.hpp"
 #include "test_utils/ElementUtils.hpp"
 
+#include <cmath>
+#include <map>
+#include <string>
+
 using namespace utymap;
 using namespace utymap::entities;
 using namespace utymap::index;
@@ -35,10 +40,10 @@ namespace {
 
         bool hasData(const QuadKey& quadKey) const { return true; }
 
-        void commit() {}
-
     protected:
 
+        void commitImpl() {}
+
         void storeImpl(const Element& element, const QuadKey& quadKey)
         {
             times++;
@@ -83,10 +88,10 @@ BOOST_AUTO_TEST_CASE(GivenWayIntersectsTwoTilesOnce_WhenStore_GeometryIsClipped)
     TestElementStore elementStore(*dependencyProvider.getStringTable(),
         [&](const Element& element, const QuadKey& quadKey) {
         if (checkQuadKey(quadKey, 1, 0, 0)) {
-            checkGeometry<Way>(reinterpret_cast<const Way&>(element), { { 10, -10 }, { 10, 0 } });
+            checkGeometry<Way>(reinterpret_cast<const Way&>(element), { { 10, 0 }, { 10, -10 } });
         }
         else if (checkQuadKey(quadKey, 1, 1, 0)) {
-            checkGeometry<Way>(reinterpret_cast<const Way&>(element), { { 10, 0 }, { 10, 10 } });
+            checkGeometry<Way>(reinterpret_cast<const Way&>(element), { { 10, 10 }, { 10, 0 } });
         }
         else {
             BOOST_FAIL("Unexpected quadKey!");
@@ -107,13 +112,13 @@ BOOST_AUTO_TEST_CASE(GivenWayIntersectsTwoTilesTwice_WhenStore_GeometryIsClipped
     TestElementStore elementStore(*dependencyProvider.getStringTable(),
         [&](const Element& element, const QuadKey& quadKey) {
         if (checkQuadKey(quadKey, 1, 0, 0)) {
-            checkGeometry<Way>(reinterpret_cast<const Way&>(element), { { 20, 0 }, { 20, -10 }, { 10, -10 }, {10, 0} });
+            checkGeometry<Way>(reinterpret_cast<const Way&>(element), { { 10, 0 }, { 10, -10 }, { 20, -10 }, { 20, 0 } });
         }
         else if (checkQuadKey(quadKey, 1, 1, 0)) {
             const Relation& relation = reinterpret_cast<const Relation&>(element);
             BOOST_CHECK_EQUAL(relation.elements.size(), 2);
-            checkGeometry<Way>(reinterpret_cast<const Way&>(*relation.elements[0]), { { 20, 10 }, { 20, 0 } });
-            checkGeometry<Way>(reinterpret_cast<const Way&>(*relation.elements[1]), { { 10, 0 }, { 10, 10 } });
+            checkGeometry<Way>(reinterpret_cast<const Way&>(*relation.elements[0]), { { 10, 10 }, { 10, 0 } });
+            checkGeometry<Way>(reinterpret_cast<const Way&>(*relation.elements[1]), { { 20, 0 }, { 20, 10 } });
         }
         else {
             BOOST_FAIL("Unexpected quadKey!");
@@ -163,7 +168,7 @@ BOOST_AUTO_TEST_CASE(GivenAreaIntersectsTwoTilesOnce_WhenStore_GeometryIsClipped
             checkGeometry<Area>(reinterpret_cast<const Area&>(element), { { 20, 0 }, { 20, -10 }, {10, -10}, {10, 0} });
         }
         else if (checkQuadKey(quadKey, 1, 1, 0)) {
-            checkGeometry<Area>(reinterpret_cast<const Area&>(element), { { 20, 10 }, { 20, 0 }, { 10, 0 }, { 10, 10 } });
+            checkGeometry<Area>(reinterpret_cast<const Area&>(element), { { 10, 0 }, { 10, 10 }, { 20, 10 }, { 20, 0 } });
         }
         else {
             BOOST_FAIL("Unexpected quadKey!");
@@ -185,13 +190,13 @@ BOOST_AUTO_TEST_CASE(GivenAreaIntersectsTwoTilesTwice_WhenStore_GeometryIsClippe
         [&](const Element& element, const QuadKey& quadKey) {
         if (checkQuadKey(quadKey, 1, 0, 0)) {
             checkGeometry<Area>(reinterpret_cast<const Area&>(element), 
-            { { 10, 0 }, { 10, -5 }, { 15, -5 }, { 15, 0 }, { 20, 0 }, { 20, -10 }, { 5, -10 }, { 5, 0 } });
+            { { 20, 0 }, { 20, -10 }, { 5, -10 }, { 5, 0 }, { 10, 0 }, { 10, -5 }, { 15, -5 }, { 15, 0 } });
         }
         else if (checkQuadKey(quadKey, 1, 1, 0)) {
             const Relation& relation = reinterpret_cast<const Relation&>(element);
             BOOST_CHECK_EQUAL(relation.elements.size(), 2);
-            checkGeometry<Area>(reinterpret_cast<const Area&>(*relation.elements[0]), { { 15, 10 }, { 20, 10 }, { 20, 0 }, {15, 0} });
-            checkGeometry<Area>(reinterpret_cast<const Area&>(*relation.elements[1]), { { 10, 10 }, { 10, 0 }, { 5, 0 }, { 5, 10 } });
+            checkGeometry<Area>(reinterpret_cast<const Area&>(*relation.elements[0]), { { 5, 0 }, { 5, 10 }, { 10, 10 }, { 10, 0 } });
+            checkGeometry<Area>(reinterpret_cast<const Area&>(*relation.elements[1]), { { 15, 0 }, { 15, 10 }, { 20, 10 }, { 20, 0 } });
         }
         else {
             BOOST_FAIL("Unexpected quadKey!");
@@ -204,6 +209,97 @@ BOOST_AUTO_TEST_CASE(GivenAreaIntersectsTwoTilesTwice_WhenStore_GeometryIsClippe
     BOOST_CHECK_EQUAL(elementStore.times, 2);
 }
 
+BOOST_AUTO_TEST_CASE(GivenWayCrossingTileWithoutPointsInside_WhenStore_GeometryIsClipped)
+{
+    Way way = ElementUtils::createElement<Way>(*dependencyProvider.getStringTable(), 0,
+    { { "test", "Foo" } },
+    { { 10, -10 }, { 20, 10 } });
+    TestElementStore elementStore(*dependencyProvider.getStringTable(),
+        [&](const Element& element, const QuadKey& quadKey) {
+        if (checkQuadKey(quadKey, 1, 0, 0)) {
+            checkGeometry<Way>(reinterpret_cast<const Way&>(element), { { 10, -10 }, { 15, 0 } });
+        }
+        else if (checkQuadKey(quadKey, 1, 1, 0)) {
+            checkGeometry<Way>(reinterpret_cast<const Way&>(element), { { 15, 0 }, { 20, 10 } });
+        }
+        else {
+            BOOST_FAIL("Unexpected quadKey!");
+        }
+    });
+
+    elementStore.store(way, LodRange(1, 1),
+        *dependencyProvider.getStyleProvider("way|z1[test=Foo] { key:val; clip: true;}"));
+
+    BOOST_CHECK_EQUAL(elementStore.times, 2);
+}
+
+BOOST_AUTO_TEST_CASE(GivenAreaWithPointsOnTileBorder_WhenStore_GeometryIsClipped)
+{
+    Area area = ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), 0,
+    { { "test", "Foo" } },
+    { { 10, 0 }, { 20, 0 }, { 20, 10 }, { 10, 10 } });
+    TestElementStore elementStore(*dependencyProvider.getStringTable(),
+        [&](const Element& element, const QuadKey& quadKey) {
+        if (checkQuadKey(quadKey, 1, 1, 0)) {
+            checkGeometry<Area>(reinterpret_cast<const Area&>(element), { { 10, 0 }, { 10, 10 }, { 20, 10 }, { 20, 0 } });
+        }
+        else if (!checkQuadKey(quadKey, 1, 0, 0)) {
+            BOOST_FAIL("Unexpected quadKey!");
+        }
+    });
+
+    elementStore.store(area, LodRange(1, 1),
+        *dependencyProvider.getStyleProvider("area|z1[test=Foo] { key:val; clip: true;}"));
+
+    BOOST_CHECK_EQUAL(elementStore.times, 1);
+}
+
+BOOST_AUTO_TEST_CASE(GivenAreaOverSeveralLods_WhenStoreWithClip_ThenGeometryIsTheSameAsForSingleLod)
+{
+    Area area = ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), 0,
+    { { "test", "Foo" } },
+    { { 10, 10 }, { 60, 30 }, { 20, 100 }, { -30, 60 }, { -50, -20 }, { 0, -40 } });
+    auto styleProvider = dependencyProvider.getStyleProvider("area|z1-3[test=Foo] { key:val; clip: true;}");
+    std::map<std::string, double> hierarchical, direct;
+    auto collect = [](std::map<std::string, double>& areas) {
+        return [&](const Element& element, const QuadKey& quadKey) {
+            if (quadKey.levelOfDetail == 3)
+                areas[std::to_string(quadKey.tileX) + "/" + std::to_string(quadKey.tileY)] +=
+                    utymap::utils::getArea(reinterpret_cast<const Area&>(element).coordinates);
+        };
+    };
+    TestElementStore hierarchicalStore(*dependencyProvider.getStringTable(), collect(hierarchical));
+    TestElementStore directStore(*dependencyProvider.getStringTable(), collect(direct));
+
+    hierarchicalStore.store(area, LodRange(1, 3), *styleProvider);
+    directStore.store(area, LodRange(3, 3), *styleProvider);
+
+    BOOST_CHECK_EQUAL(hierarchicalStore.times, directStore.times + 9);
+    BOOST_CHECK_EQUAL(hierarchical.size(), direct.size());
+    for (const auto& pair : direct)
+        BOOST_CHECK_CLOSE(hierarchical[pair.first], pair.second, 1E-3);
+}
+
+BOOST_AUTO_TEST_CASE(GivenAreaWithManyPointsOverManyTiles_WhenStoreWithClip_ThenClippedAreasCoverArea)
+{
+    Area area = ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), 0, { { "test", "Foo" } }, {});
+    for (int i = 0; i < 200; ++i) {
+        double angle = -2 * std::acos(-1.) * i / 200;
+        area.coordinates.push_back(GeoCoordinate(70 * std::sin(angle), 70 * std::cos(angle)));
+    }
+    double clippedArea = 0;
+    TestElementStore elementStore(*dependencyProvider.getStringTable(),
+        [&](const Element& element, const QuadKey& quadKey) {
+        clippedArea += std::abs(utymap::utils::getArea(reinterpret_cast<const Area&>(element).coordinates));
+    });
+
+    elementStore.store(area, LodRange(3, 3),
+        *dependencyProvider.getStyleProvider("area|z3[test=Foo] { key:val; clip: true;}"));
+
+    BOOST_CHECK_EQUAL(elementStore.times, 20);
+    BOOST_CHECK_CLOSE(clippedArea, std::abs(utymap::utils::getArea(area.coordinates)), 1E-3);
+}
+
 BOOST_AUTO_TEST_CASE(GivenAreaBiggerThanTile_WhenStore_GeometryIsTheSameAsForTile)
 {
     Area area = ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), 0,
@@ -238,8 +334,8 @@ BOOST_AUTO_TEST_CASE(GivenRelationOfPolygonWithHole_WhenStore_RelationIsReturned
         [&](const Element& element, const QuadKey& quadKey) {
         auto result = reinterpret_cast<const Relation&>(element);
         if (checkQuadKey(quadKey, 1, 1, 0)) {
-            checkGeometry<Area>(reinterpret_cast<const Area&>(*result.elements[0]), { { 15, 5 }, { 15, 0 }, { 10, 0 }, { 10, 5 } });
-            checkGeometry<Area>(reinterpret_cast<const Area&>(*result.elements[1]), { { 20, 10 }, { 20, 0 }, { 5, 0 }, { 5, 10 } });
+            checkGeometry<Area>(reinterpret_cast<const Area&>(*result.elements[0]), { { 10, 0 }, { 10, 5 }, { 15, 5 }, { 15, 0 } });
+            checkGeometry<Area>(reinterpret_cast<const Area&>(*result.elements[1]), { { 5, 0 }, { 5, 10 }, { 20, 10 }, { 20, 0 } });
         } else if(checkQuadKey(quadKey, 1, 0, 0)) {
             checkGeometry<Area>(reinterpret_cast<const Area&>(*result.elements[0]), { { 15, 0 }, { 15, -5 }, { 10, -5 }, { 10, 0 } });
             checkGeometry<Area>(reinterpret_cast<const Area&>(*result.elements[1]), { { 20, 0 }, { 20, -10 }, { 5, -10 }, { 5, 0 } });
@@ -270,7 +366,7 @@ BOOST_AUTO_TEST_CASE(GivenRelationOfPolygonWithHole_WhenStore_RelationAndAreaRet
             const Relation& result = reinterpret_cast<const Relation&>(element);
             BOOST_CHECK_EQUAL(result.elements.size(), 2);
             checkGeometry<Area>(reinterpret_cast<const Area&>(*result.elements[0]), { { 10, 8 }, { 15, 8 }, { 15, 2 }, { 10, 2 } });
-            checkGeometry<Area>(reinterpret_cast<const Area&>(*result.elements[1]), { { 20, 10 }, { 20, 0 }, { 5, 0 }, { 5, 10 } });
+            checkGeometry<Area>(reinterpret_cast<const Area&>(*result.elements[1]), { { 5, 0 }, { 5, 10 }, { 20, 10 }, { 20, 0 } });
         }
         else if (checkQuadKey(quadKey, 1, 0, 0)) {
             checkGeometry<Area>(reinterpret_cast<const Area&>(element), { { 20, 0 }, { 20, -10 }, { 5, -10 }, { 5, 0 } });
@@ -331,4 +427,78 @@ BOOST_AUTO_TEST_CASE(GivenWayWithLargeSize_WhenStore_IsStored)
     BOOST_CHECK_EQUAL(elementStore.times, 1);
 }
 
+BOOST_AUTO_TEST_CASE(GivenWayWithSubPixelDetails_WhenStoreWithSimplify_ThenGeometryIsSimplified)
+{
+    Way way = ElementUtils::createElement<Way>(*dependencyProvider.getStringTable(), 0,
+    { { "test", "Foo" } },
+    { { 10, 10 }, { 10.01, 20 }, { 9.99, 30 }, { 10, 40 } });
+    TestElementStore elementStore(*dependencyProvider.getStringTable(),
+        [&](const Element& element, const QuadKey& quadKey) {
+        checkGeometry<Way>(reinterpret_cast<const Way&>(element), { { 10, 10 }, { 10, 40 } });
+    });
+
+    elementStore.store(way, LodRange(1, 1),
+        *dependencyProvider.getStyleProvider("way|z1[test=Foo] { key:val; simplify: 2px;}"));
+
+    BOOST_CHECK_EQUAL(elementStore.times, 1);
+}
+
+BOOST_AUTO_TEST_CASE(GivenAreaSmallerThanTolerance_WhenStoreWithSimplify_ThenAreaIsSkipped)
+{
+    Area area = ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), 0,
+    { { "test", "Foo" } },
+    { { 10, 10 }, { 10, 10.1 }, { 10.1, 10.1 }, { 10.1, 10 } });
+    TestElementStore elementStore(*dependencyProvider.getStringTable(),
+        [&](const Element& element, const QuadKey& quadKey) {
+        BOOST_FAIL("Area should be skipped!");
+    });
+
+    bool wasStored = elementStore.store(area, LodRange(1, 1),
+        *dependencyProvider.getStyleProvider("area|z1[test=Foo] { key:val; simplify: 2px;}"));
+
+    BOOST_CHECK(!wasStored);
+    BOOST_CHECK_EQUAL(elementStore.times, 0);
+}
+
+BOOST_AUTO_TEST_CASE(GivenNearbyAreas_WhenStoreWithAggregate_ThenSingleAreaIsStoredOnCommit)
+{
+    auto& stringTable = *dependencyProvider.getStringTable();
+    Area area1 = ElementUtils::createElement<Area>(stringTable, 1, { { "test", "Foo" } },
+    { { 10, 10 }, { 10.5, 10 }, { 10.5, 10.5 }, { 10, 10.5 } });
+    Area area2 = ElementUtils::createElement<Area>(stringTable, 2, { { "test", "Bar" } },
+    { { 10, 10.8 }, { 10.5, 10.8 }, { 10.5, 11.5 }, { 10, 11.5 } });
+    TestElementStore elementStore(stringTable,
+        [&](const Element& element, const QuadKey& quadKey) {
+        const Area& area = reinterpret_cast<const Area&>(element);
+        BOOST_CHECK(checkQuadKey(quadKey, 1, 1, 0));
+        BOOST_CHECK_EQUAL(area.tags[0].value, stringTable.getId("Bar"));
+        BOOST_CHECK_CLOSE(utymap::utils::getArea(area.coordinates), -1.5, 1);
+    });
+    auto styleProvider = dependencyProvider.getStyleProvider("area|z1[test] { aggregate: block; }");
+
+    elementStore.store(area1, LodRange(1, 1), *styleProvider);
+    elementStore.store(area2, LodRange(1, 1), *styleProvider);
+    BOOST_CHECK_EQUAL(elementStore.times, 0);
+    elementStore.commit();
+
+    BOOST_CHECK_EQUAL(elementStore.times, 1);
+}
+
+BOOST_AUTO_TEST_CASE(GivenSubPixelArea_WhenStoreWithAggregate_ThenAreaIsDroppedOnCommit)
+{
+    Area area = ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), 0,
+    { { "test", "Foo" } },
+    { { 10, 10 }, { 10, 10.1 }, { 10.1, 10.1 }, { 10.1, 10 } });
+    TestElementStore elementStore(*dependencyProvider.getStringTable(),
+        [&](const Element& element, const QuadKey& quadKey) {
+        BOOST_FAIL("Area should be dropped!");
+    });
+
+    elementStore.store(area, LodRange(1, 1),
+        *dependencyProvider.getStyleProvider("area|z1[test=Foo] { aggregate: block; }"));
+    elementStore.commit();
+
+    BOOST_CHECK_EQUAL(elementStore.times, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
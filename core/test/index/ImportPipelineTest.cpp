@@ -0,0 +1,146 @@
+#include "QuadKey.hpp"
+#include "entities/Element.hpp"
+#include "entities/Node.hpp"
+#include "entities/Way.hpp"
+#include "entities/Area.hpp"
+#include "entities/Relation.hpp"
+#include "index/ElementStore.hpp"
+#include "index/ImportPipeline.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_utils/DependencyProvider.hpp"
+#include "test_utils/ElementUtils.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace utymap;
+using namespace utymap::entities;
+using namespace utymap::index;
+using namespace utymap::mapcss;
+
+namespace {
+    const std::string stylesheet = "area|z1-2[any],way|z1-2[any],node|z1-2[any] { clip: true; }";
+
+    // Records element ids, coordinate count and quadkeys in order of writing.
+    class RecordingElementStore : public ElementStore
+    {
+    public:
+        std::vector<std::string> records;
+
+        RecordingElementStore(StringTable& stringTable) : ElementStore(stringTable)
+        {
+        }
+
+        void search(const QuadKey& quadKey, ElementVisitor& visitor) { }
+
+        bool hasData(const QuadKey& quadKey) const { return true; }
+
+    protected:
+
+        void commitImpl() {}
+
+        void storeImpl(const Element& element, const QuadKey& quadKey)
+        {
+            records.push_back(std::to_string(element.id) + ":" +
+                              std::to_string(quadKey.levelOfDetail) + "/" +
+                              std::to_string(quadKey.tileX) + "/" +
+                              std::to_string(quadKey.tileY));
+        }
+    };
+
+    struct Index_ImportPipelineFixture
+    {
+        Index_ImportPipelineFixture() :
+            dependencyProvider(),
+            styleProvider(dependencyProvider.getStyleProvider(stylesheet))
+        {
+        }
+
+        std::vector<std::shared_ptr<Element>> createElements(int count)
+        {
+            auto& stringTable = *dependencyProvider.getStringTable();
+            std::vector<std::shared_ptr<Element>> elements;
+            for (int i = 0; i < count; ++i) {
+                double offset = (i % 40) - 20;
+                if (i % 3 == 0) {
+                    auto node = std::make_shared<Node>(ElementUtils::createElement<Node>(stringTable, i, { { "any", "true" } }));
+                    node->coordinate = GeoCoordinate(offset, offset);
+                    elements.push_back(node);
+                }
+                else if (i % 3 == 1) {
+                    elements.push_back(std::make_shared<Way>(ElementUtils::createElement<Way>(stringTable, i,
+                        { { "any", "true" } }, { { offset, -offset }, { offset + 1, offset } })));
+                }
+                else {
+                    elements.push_back(std::make_shared<Area>(ElementUtils::createElement<Area>(stringTable, i,
+                        { { "any", "true" } }, { { offset, offset }, { offset + 5, offset }, { offset, offset + 50 } })));
+                }
+            }
+            return elements;
+        }
+
+        void import(ElementStore& elementStore, const std::vector<std::shared_ptr<Element>>& elements, std::size_t workers)
+        {
+            ImportPipeline pipeline(elementStore, [&](const Element& element, const ElementStore::StoreCallback& callback) {
+                return elementStore.prepare(element, LodRange(1, 2), *styleProvider, callback);
+            }, workers, 3, 2);
+
+            for (const auto& element : elements)
+                pipeline.add(*element);
+
+            pipeline.complete();
+        }
+
+        DependencyProvider dependencyProvider;
+        std::shared_ptr<StyleProvider> styleProvider;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(Index_ImportPipeline, Index_ImportPipelineFixture)
+
+BOOST_AUTO_TEST_CASE(GivenElements_WhenImportWithWorkers_ThenResultIsTheSameAsSequential)
+{
+    auto elements = createElements(200);
+    RecordingElementStore sequentialStore(*dependencyProvider.getStringTable());
+    RecordingElementStore pipelineStore(*dependencyProvider.getStringTable());
+    for (const auto& element : elements)
+        sequentialStore.store(*element, LodRange(1, 2), *styleProvider);
+
+    import(pipelineStore, elements, 4);
+
+    BOOST_CHECK(!sequentialStore.records.empty());
+    BOOST_CHECK(sequentialStore.records == pipelineStore.records);
+}
+
+BOOST_AUTO_TEST_CASE(GivenElements_WhenImportWithoutWorkers_ThenResultIsTheSameAsSequential)
+{
+    auto elements = createElements(20);
+    RecordingElementStore sequentialStore(*dependencyProvider.getStringTable());
+    RecordingElementStore pipelineStore(*dependencyProvider.getStringTable());
+    for (const auto& element : elements)
+        sequentialStore.store(*element, LodRange(1, 2), *styleProvider);
+
+    import(pipelineStore, elements, 0);
+
+    BOOST_CHECK(sequentialStore.records == pipelineStore.records);
+}
+
+BOOST_AUTO_TEST_CASE(GivenFailingProcessor_WhenComplete_ThenErrorIsRethrown)
+{
+    auto elements = createElements(20);
+    RecordingElementStore elementStore(*dependencyProvider.getStringTable());
+    ImportPipeline pipeline(elementStore, [](const Element&, const ElementStore::StoreCallback&) -> bool {
+        throw std::domain_error("Test");
+    }, 2, 3, 2);
+
+    BOOST_CHECK_THROW({
+        for (const auto& element : elements)
+            pipeline.add(*element);
+        pipeline.complete();
+    }, std::domain_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
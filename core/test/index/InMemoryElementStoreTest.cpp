@@ -76,4 +76,22 @@ BOOST_AUTO_TEST_CASE(GivenNodeWayArea_WhenSearch_ThenAllSkipped)
     BOOST_CHECK_EQUAL(counter.times, 0);
 }
 
+BOOST_AUTO_TEST_CASE(GivenStoredElements_WhenGetRevision_ThenItDependsOnWrittenElementsOnly)
+{
+    QuadKey quadKey(1, 0, 0);
+    std::uint64_t revision = elementStore.getRevision(quadKey);
+    InMemoryElementStore emptyStore(*dependencyProvider.getStringTable());
+
+    BOOST_CHECK_NE(revision, 0);
+    BOOST_CHECK_EQUAL(emptyStore.getRevision(quadKey), 0);
+    BOOST_CHECK_EQUAL(elementStore.getRevision(QuadKey(2, 0, 0)), 0);
+
+    Node node = ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(), 1,
+    { { "any", "true" } });
+    node.coordinate = { 5, -5 };
+    elementStore.store(node, LodRange(1, 1), *dependencyProvider.getStyleProvider(stylesheet));
+
+    BOOST_CHECK_NE(elementStore.getRevision(quadKey), revision);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -198,4 +198,51 @@ BOOST_AUTO_TEST_CASE(GivenTwoAreas_WhenStoreAndSearchOnce_ThenTheyStoredTwiceAnd
     assertWayOrArea(area2, *std::dynamic_pointer_cast<Area>(counter.element));
 }
 
+BOOST_AUTO_TEST_CASE(GivenAreasInDifferentQuadKeys_WhenStoreWithExternalSort_ThenTheyStoredInInputOrder)
+{
+    LodRange range(1, 1);
+    auto styleProvider = dependencyProvider.getStyleProvider(stylesheet);
+    auto& stringTable = *dependencyProvider.getStringTable();
+    Area area1 = ElementUtils::createElement<Area>(stringTable, 1, { { "any", "true" } }, { { 4, -4 }, { 5, -5 }, { 6, -6 } });
+    Area area2 = ElementUtils::createElement<Area>(stringTable, 2, { { "any", "true" } }, { { 4, 4 }, { 5, 5 }, { 6, 6 } });
+    Area area3 = ElementUtils::createElement<Area>(stringTable, 3, { { "any", "true" } }, { { 1, -1 }, { 2, -2 }, { 3, -3 } });
+    // NOTE tiny buffer forces spilling of each element to separate run file.
+    PersistentElementStore sortedStore("", stringTable, 1);
+    ElementCounter westCounter, eastCounter;
+
+    sortedStore.store(area1, range, *styleProvider);
+    sortedStore.store(area2, range, *styleProvider);
+    sortedStore.store(area3, range, *styleProvider);
+    BOOST_CHECK(boost::filesystem::exists("sort-0.run"));
+    sortedStore.commit();
+    sortedStore.search(QuadKey(1, 0, 0), westCounter);
+    sortedStore.search(QuadKey(1, 1, 0), eastCounter);
+
+    BOOST_CHECK(!boost::filesystem::exists("sort-0.run"));
+    BOOST_CHECK_EQUAL(westCounter.times, 2);
+    assertWayOrArea(area3, *std::dynamic_pointer_cast<Area>(westCounter.element));
+    BOOST_CHECK_EQUAL(eastCounter.times, 1);
+    assertWayOrArea(area2, *std::dynamic_pointer_cast<Area>(eastCounter.element));
+}
+
+BOOST_AUTO_TEST_CASE(GivenStoredArea_WhenGetRevisionFromAnotherInstance_ThenItIsTheSameAndChangedByNextStore)
+{
+    LodRange range(1, 1);
+    QuadKey quadKey(1, 0, 0);
+    auto styleProvider = dependencyProvider.getStyleProvider(stylesheet);
+    auto& stringTable = *dependencyProvider.getStringTable();
+    Area area1 = ElementUtils::createElement<Area>(stringTable, 1, { { "any", "true" } }, { { 4, -4 }, { 5, -5 }, { 6, -6 } });
+    Area area2 = ElementUtils::createElement<Area>(stringTable, 2, { { "any", "true" } }, { { 1, -1 }, { 2, -2 }, { 3, -3 } });
+    PersistentElementStore anotherStore("", stringTable);
+
+    elementStore.store(area1, range, *styleProvider);
+    elementStore.commit();
+    std::uint64_t revision = elementStore.getRevision(quadKey);
+    BOOST_CHECK_EQUAL(anotherStore.getRevision(quadKey), revision);
+
+    elementStore.store(area2, range, *styleProvider);
+    elementStore.commit();
+    BOOST_CHECK_NE(elementStore.getRevision(quadKey), revision);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
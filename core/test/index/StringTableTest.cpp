@@ -56,4 +56,15 @@ BOOST_AUTO_TEST_CASE(GivenThreeStrings_WhenGetStringOfSecond_ThenReturnValidStri
     BOOST_CHECK_EQUAL( str, "string2" );
 }
 
+BOOST_AUTO_TEST_CASE(GivenNumericAndTextStrings_WhenGetDouble_ThenReturnParsedValues)
+{
+    auto& stringTable = *depedencyProvider.getStringTable();
+    std::uint32_t numberId = stringTable.getId("12.5");
+    std::uint32_t textId = stringTable.getId("yes");
+
+    BOOST_CHECK_EQUAL(stringTable.getDouble(numberId), 12.5);
+    BOOST_CHECK_EQUAL(stringTable.getDouble(numberId), 12.5);
+    BOOST_CHECK_EQUAL(stringTable.getDouble(textId), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
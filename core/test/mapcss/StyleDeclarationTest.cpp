@@ -23,7 +23,7 @@ BOOST_FIXTURE_TEST_SUITE(MapCss_StyleDeclaration, MapCss_StyleDeclarationFixture
 
 BOOST_AUTO_TEST_CASE(GivenOnlySingleTag_WhenDoubleEvaluate_ThenReturnValue)
 {
-    StyleDeclaration styleDeclaration(0, "eval(\"tag('height')\")");
+    StyleDeclaration styleDeclaration(0, "eval(\"tag('height')\")", *dependencyProvider.getStringTable());
 
     double result = styleDeclaration.evaluate<double>(
         ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(), 0, { { "height", "2.5" } }).tags,
@@ -34,7 +34,7 @@ BOOST_AUTO_TEST_CASE(GivenOnlySingleTag_WhenDoubleEvaluate_ThenReturnValue)
 
 BOOST_AUTO_TEST_CASE(GiveTwoTags_WhenDoubleEvaluate_ThenReturnValue)
 {
-    StyleDeclaration styleDeclaration(0, "eval(\"tag('building:height') - tag('roof:height')\")");
+    StyleDeclaration styleDeclaration(0, "eval(\"tag('building:height') - tag('roof:height')\")", *dependencyProvider.getStringTable());
 
     double result = styleDeclaration.evaluate<double>(ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(),
         0, { { "building:height", "10" }, { "roof:height", "2.5" } }).tags,
@@ -45,7 +45,7 @@ BOOST_AUTO_TEST_CASE(GiveTwoTags_WhenDoubleEvaluate_ThenReturnValue)
 
 BOOST_AUTO_TEST_CASE(GiveOneTagOneNumber_WhenDoubleEvaluate_ThenReturnValue)
 {
-    StyleDeclaration styleDeclaration(0, "eval(\"tag('building:levels') * 3\")");
+    StyleDeclaration styleDeclaration(0, "eval(\"tag('building:levels') * 3\")", *dependencyProvider.getStringTable());
 
     double result = styleDeclaration.evaluate<double>(ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(), 
         0, { { "building:levels", "5" } }).tags,
@@ -56,7 +56,7 @@ BOOST_AUTO_TEST_CASE(GiveOneTagOneNumber_WhenDoubleEvaluate_ThenReturnValue)
 
 BOOST_AUTO_TEST_CASE(GiveRawValue_WhenDoubleEvaluate_ThenThrowsException)
 {
-    StyleDeclaration styleDeclaration(0, "13");
+    StyleDeclaration styleDeclaration(0, "13", *dependencyProvider.getStringTable());
 
     BOOST_CHECK_THROW(styleDeclaration.evaluate<double>(ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(),
         0, { { "building:levels", "5" } }).tags, *dependencyProvider.getStringTable()),
@@ -65,7 +65,7 @@ BOOST_AUTO_TEST_CASE(GiveRawValue_WhenDoubleEvaluate_ThenThrowsException)
 
 BOOST_AUTO_TEST_CASE(GiveOneTagOneNumber_WhenStringEvaluate_ThenReturnValue)
 {
-    StyleDeclaration styleDeclaration(0, "eval(\"tag('color')\")");
+    StyleDeclaration styleDeclaration(0, "eval(\"tag('color')\")", *dependencyProvider.getStringTable());
 
     std::string result = styleDeclaration.evaluate<std::string>(ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(),
         0, { { "color", "red" } }).tags,
@@ -74,4 +74,45 @@ BOOST_AUTO_TEST_CASE(GiveOneTagOneNumber_WhenStringEvaluate_ThenReturnValue)
     BOOST_CHECK_EQUAL(result, "red");
 }
 
+BOOST_AUTO_TEST_CASE(GivenExpressionWithSignAndPrecedence_WhenDoubleEvaluate_ThenReturnValue)
+{
+    StyleDeclaration styleDeclaration(0, "eval(\"1 - -tag('height') * 3 / tag('levels')\")", *dependencyProvider.getStringTable());
+
+    double result = styleDeclaration.evaluate<double>(ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(),
+        0, { { "height", "4" }, { "levels", "2" } }).tags,
+    *dependencyProvider.getStringTable());
+
+    BOOST_CHECK_EQUAL(result, 7);
+}
+
+BOOST_AUTO_TEST_CASE(GivenValuesWithDimension_WhenCreate_ThenNumberIsParsedOnce)
+{
+    StyleDeclaration meters(0, "2.5m", *dependencyProvider.getStringTable());
+    StyleDeclaration percent(0, "50%", *dependencyProvider.getStringTable());
+    StyleDeclaration number(0, "-3", *dependencyProvider.getStringTable());
+    StyleDeclaration string(0, "platform", *dependencyProvider.getStringTable());
+
+    BOOST_CHECK_EQUAL(meters.type(), StyleDeclaration::Meters);
+    BOOST_CHECK_EQUAL(meters.number(), 2.5);
+    BOOST_CHECK_EQUAL(percent.type(), StyleDeclaration::Percent);
+    BOOST_CHECK_EQUAL(percent.number(), 50);
+    BOOST_CHECK_EQUAL(number.type(), StyleDeclaration::Number);
+    BOOST_CHECK_EQUAL(number.number(), -3);
+    BOOST_CHECK_EQUAL(string.type(), StyleDeclaration::String);
+    BOOST_CHECK_EQUAL(string.number(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(GivenGradientAndList_WhenCreate_ThenValuesAreParsedOnce)
+{
+    StyleDeclaration gradient(0, "gradient(#0fffff, #099999 50%, #033333)", *dependencyProvider.getStringTable());
+    StyleDeclaration list(0, "terrain,building", *dependencyProvider.getStringTable());
+
+    BOOST_CHECK_EQUAL(gradient.type(), StyleDeclaration::Gradient);
+    BOOST_CHECK(gradient.gradient() != nullptr);
+    BOOST_CHECK_EQUAL(list.type(), StyleDeclaration::String);
+    BOOST_CHECK_EQUAL(list.values().size(), 2);
+    BOOST_CHECK_EQUAL(list.values()[0], "terrain");
+    BOOST_CHECK_EQUAL(list.values()[1], "building");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,16 +2,31 @@
 #include "entities/Node.hpp"
 #include "entities/Way.hpp"
 #include "entities/Relation.hpp"
+#include "mapcss/MapCssParser.hpp"
 #include "mapcss/StyleProvider.hpp"
 #include "test_utils/ElementUtils.hpp"
 
 #include <boost/test/unit_test.hpp>
 #include "test_utils/DependencyProvider.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
 using namespace utymap::entities;
 using namespace utymap::mapcss;
 
 namespace {
+    struct TestKeys
+    {
+        std::uint32_t color;
+        TestKeys(utymap::index::StringTable& stringTable, const std::string& prefix) :
+            color(stringTable.getId(prefix + "color"))
+        {
+        }
+    };
+
     struct Index_StyleProviderFixture
     {
         Index_StyleProviderFixture() :
@@ -142,4 +157,111 @@ BOOST_AUTO_TEST_CASE(GivenTwoNotEqualsConditions_WhenHasStyle_ThenReturnFalse)
     BOOST_CHECK(!styleProvider->hasStyle(node, zoomLevel));
 }
 
+BOOST_AUTO_TEST_CASE(GivenManyRules_WhenForElement_ThenDeclarationsOfMatchedRulesAreMergedInOrder)
+{
+    std::string stylesheetStr;
+    for (int i = 0; i < 200; ++i)
+        stylesheetStr += "node|z1[amenity=type" + std::to_string(i) + "] { key" + std::to_string(i) + ": value; order: " + std::to_string(i) + "; }\n";
+    stylesheetStr += "node|z1[amenity=type5][name] { named: yes; }\n";
+    stylesheetStr += "node|z1[amenity][level>0] { upper: yes; }\n";
+    stylesheetStr += "node|z1[name!=bar] { order: last; }\n";
+    auto& stringTable = *dependencyProvider.getStringTable();
+    StyleProvider provider(MapCssParser().parse(stylesheetStr), stringTable);
+    Node node = ElementUtils::createElement<Node>(stringTable, 0, { { "amenity", "type5" }, { "name", "foo" }, { "level", "1" } });
+    std::sort(node.tags.begin(), node.tags.end(), [](const Tag& lhs, const Tag& rhs) { return lhs.key < rhs.key; });
+
+    Style style = provider.forElement(node, 1);
+
+    BOOST_CHECK_EQUAL(style.declarations().size(), 4);
+    BOOST_CHECK(style.has(stringTable.getId("key5")));
+    BOOST_CHECK(style.has(stringTable.getId("named")));
+    BOOST_CHECK(style.has(stringTable.getId("upper")));
+    BOOST_CHECK_EQUAL(*style.getString("order"), "last");
+    BOOST_CHECK(!provider.hasStyle(ElementUtils::createElement<Node>(stringTable, 0, { { "amenity", "unknown" } }), 1));
+}
+
+// NOTE measures filter matching, run explicitly:
+// Test --run_test=Index_StyleProvider/GivenManyRules_WhenMatchManyElements_ThenTimeIsReported --log_level=message
+BOOST_AUTO_TEST_CASE(GivenManyRules_WhenMatchManyElements_ThenTimeIsReported, * boost::unit_test::disabled())
+{
+    const int RuleCount = 500, CallCount = 100000;
+    std::string stylesheetStr;
+    for (int i = 0; i < RuleCount; ++i)
+        stylesheetStr += "node|z1[amenity=type" + std::to_string(i) + "] { key" + std::to_string(i) + ": value; }\n";
+    stylesheetStr += "node|z1[amenity][level>0] { upper: yes; }\n";
+    stylesheetStr += "node|z1[name!=bar] { named: yes; }\n";
+    auto& stringTable = *dependencyProvider.getStringTable();
+    // NOTE style cache is disabled as it hides matching cost.
+    StyleProvider provider(MapCssParser().parse(stylesheetStr), stringTable, 0);
+    std::vector<Node> nodes;
+    for (int i = 0; i < 1000; ++i) {
+        std::string amenity = "type" + std::to_string(i % (RuleCount + 100));
+        std::string level = std::to_string(i % 3);
+        nodes.push_back(ElementUtils::createElement<Node>(stringTable, i,
+            { { "amenity", amenity.c_str() }, { "level", level.c_str() }, { "name", "foo" } }));
+        std::sort(nodes.back().tags.begin(), nodes.back().tags.end(), [](const Tag& lhs, const Tag& rhs) { return lhs.key < rhs.key; });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t declarations = 0;
+    for (int i = 0; i < CallCount; ++i) {
+        const Node& node = nodes[i % nodes.size()];
+        if (provider.hasStyle(node, 1))
+            declarations += provider.forElement(node, 1).declarations().size();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    BOOST_CHECK_GT(declarations, 0);
+    BOOST_TEST_MESSAGE("Matched " << CallCount << " elements against " << RuleCount << " rules in " << elapsed.count() << "ms");
+}
+
+BOOST_AUTO_TEST_CASE(GivenElementsWithSameTags_WhenForElement_ThenCachedDeclarationsAreReturned)
+{
+    auto& stringTable = *dependencyProvider.getStringTable();
+    StyleProvider provider(MapCssParser().parse("node|z1[amenity=biergarten] { key: value; }"), stringTable);
+    Node node1 = ElementUtils::createElement<Node>(stringTable, 1, { { "amenity", "biergarten" } });
+    Node node2 = ElementUtils::createElement<Node>(stringTable, 2, { { "amenity", "biergarten" } });
+    Way way = ElementUtils::createElement<Way>(stringTable, 3, { { "amenity", "biergarten" } });
+
+    Style style1 = provider.forElement(node1, 1);
+    Style style2 = provider.forElement(node2, 1);
+
+    BOOST_CHECK(!style1.empty());
+    BOOST_CHECK(&style1.declarations() == &style2.declarations());
+    BOOST_CHECK(provider.forElement(way, 1).empty());
+    auto statistics = provider.getCacheStatistics();
+    BOOST_CHECK_EQUAL(statistics.hits, 1);
+    BOOST_CHECK_EQUAL(statistics.misses, 2);
+    BOOST_CHECK_EQUAL(statistics.size, 2);
+}
+
+BOOST_AUTO_TEST_CASE(GivenDisabledCache_WhenForElement_ThenStyleIsBuiltEachTime)
+{
+    auto& stringTable = *dependencyProvider.getStringTable();
+    StyleProvider provider(MapCssParser().parse("node|z1[amenity=biergarten] { key: value; }"), stringTable, 0);
+    Node node = ElementUtils::createElement<Node>(stringTable, 1, { { "amenity", "biergarten" } });
+
+    Style style1 = provider.forElement(node, 1);
+    Style style2 = provider.forElement(node, 1);
+
+    BOOST_CHECK(&style1.declarations() != &style2.declarations());
+    BOOST_CHECK(style2.has(stringTable.getId("key")));
+    BOOST_CHECK_EQUAL(provider.getCacheStatistics().misses, 2);
+    BOOST_CHECK_EQUAL(provider.getCacheStatistics().size, 0);
+}
+
+BOOST_AUTO_TEST_CASE(GivenKeysType_WhenGetKeys_ThenKeysAreInternedOncePerPrefix)
+{
+    auto& stringTable = *dependencyProvider.getStringTable();
+    StyleProvider provider(MapCssParser().parse("node|z1[amenity=biergarten] { water-color: red; }"), stringTable);
+
+    const TestKeys& keys = provider.getKeys<TestKeys>();
+    const TestKeys& waterKeys = provider.getKeys<TestKeys>("water-");
+
+    BOOST_CHECK(&keys == &provider.getKeys<TestKeys>());
+    BOOST_CHECK(&waterKeys == &provider.getKeys<TestKeys>("water-"));
+    BOOST_CHECK_EQUAL(keys.color, stringTable.getId("color"));
+    BOOST_CHECK_EQUAL(waterKeys.color, stringTable.getId("water-color"));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,87 @@
+#include "entities/Node.hpp"
+#include "mapcss/MapCssParser.hpp"
+#include "mapcss/StyleProvider.hpp"
+#include "mapcss/StyleSheetCompiler.hpp"
+#include "utils/CoreUtils.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include "config.hpp"
+#include "test_utils/DependencyProvider.hpp"
+#include "test_utils/ElementUtils.hpp"
+
+#include <sstream>
+#include <string>
+
+using namespace utymap::entities;
+using namespace utymap::mapcss;
+
+namespace {
+    const std::string StyleStr = "node|z1-16[amenity=bench] { color: gradient(#ff0000, #00ff00 50%, #0000ff); width: 2m; }\n"
+                                 "way|z10[highway], area|z12[building!=no] { builders: terrain,building; }";
+
+    struct MapCss_StyleSheetCompilerFixture
+    {
+        DependencyProvider dependencyProvider;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(MapCss_StyleSheetCompiler, MapCss_StyleSheetCompilerFixture)
+
+BOOST_AUTO_TEST_CASE(GivenImportFile_WhenHash_ThenImportsAreIncluded)
+{
+    std::uint64_t rootHash = StyleSheetCompiler::hash(TEST_MAPCSS_PATH "import.mapcss", TEST_MAPCSS_PATH);
+    std::uint64_t importHash = StyleSheetCompiler::hash(TEST_MAPCSS_PATH "import/import1.mapcss", TEST_MAPCSS_PATH);
+
+    BOOST_CHECK_EQUAL(rootHash, StyleSheetCompiler::hash(TEST_MAPCSS_PATH "import.mapcss", TEST_MAPCSS_PATH));
+    BOOST_CHECK_NE(rootHash, importHash);
+}
+
+BOOST_AUTO_TEST_CASE(GivenCompiledStyleSheet_WhenWriteAndRead_ThenRulesAndGradientsAreRestored)
+{
+    CompiledStyleSheet compiled = StyleSheetCompiler::compile(MapCssParser().parse(StyleStr));
+    std::stringstream stream;
+    StyleSheetCompiler::write(stream, compiled, 42);
+
+    CompiledStyleSheet result;
+    bool success = StyleSheetCompiler::read(stream, 42, result);
+
+    BOOST_CHECK(success);
+    BOOST_CHECK_EQUAL(result.stylesheet.rules.size(), 2);
+    for (std::size_t i = 0; i < compiled.stylesheet.rules.size(); ++i)
+        BOOST_CHECK_EQUAL(utymap::utils::toString(result.stylesheet.rules[i]),
+                          utymap::utils::toString(compiled.stylesheet.rules[i]));
+    BOOST_CHECK_EQUAL(result.gradients.size(), 1);
+    const auto& gradient = *result.gradients.begin()->second;
+    const auto& expected = *compiled.gradients.begin()->second;
+    BOOST_CHECK_EQUAL(static_cast<std::uint32_t>(gradient.evaluate(0.3)), static_cast<std::uint32_t>(expected.evaluate(0.3)));
+}
+
+BOOST_AUTO_TEST_CASE(GivenCompiledStyleSheetWithOtherHash_WhenRead_ThenReturnFalse)
+{
+    CompiledStyleSheet compiled = StyleSheetCompiler::compile(MapCssParser().parse(StyleStr));
+    std::stringstream stream;
+    StyleSheetCompiler::write(stream, compiled, 42);
+
+    CompiledStyleSheet result;
+    bool success = StyleSheetCompiler::read(stream, 43, result);
+
+    BOOST_CHECK(!success);
+    BOOST_CHECK(result.stylesheet.rules.empty());
+}
+
+BOOST_AUTO_TEST_CASE(GivenCompiledStyleSheet_WhenForElement_ThenReturnSameStyleAsFromStyleSheet)
+{
+    auto& stringTable = *dependencyProvider.getStringTable();
+    CompiledStyleSheet compiled = StyleSheetCompiler::compile(MapCssParser().parse(StyleStr));
+    StyleProvider styleProvider(compiled, stringTable);
+    Node node = ElementUtils::createElement<Node>(stringTable, 1, { { "amenity", "bench" } });
+
+    Style style = styleProvider.forElement(node, 12);
+
+    BOOST_CHECK_EQUAL(style.declarations().size(), 2);
+    BOOST_CHECK(style.getGradient("color") == compiled.gradients.begin()->second);
+    BOOST_CHECK_EQUAL(style.getValue("width"), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,75 @@
+#include "mapcss/MapCssParser.hpp"
+#include "mapcss/StyleSheetDiff.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+using namespace utymap::mapcss;
+
+namespace {
+    const std::string StyleStr = "node|z1-16[amenity=bench] { color: red; }\n"
+                                 "way|z10-12[highway] { width: 2m; }\n"
+                                 "area|z12[building] { height: 10; }";
+
+    struct MapCss_StyleSheetDiffFixture
+    {
+        StyleSheetDiff compare(const std::string& oldStr, const std::string& newStr)
+        {
+            return StyleSheetDiff::compare(parser.parse(oldStr), parser.parse(newStr));
+        }
+
+        MapCssParser parser;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(MapCss_StyleSheetDiff, MapCss_StyleSheetDiffFixture)
+
+BOOST_AUTO_TEST_CASE(GivenSameStyleSheets_WhenCompare_ThenDiffIsEmpty)
+{
+    BOOST_CHECK(compare(StyleStr, StyleStr).empty());
+}
+
+BOOST_AUTO_TEST_CASE(GivenChangedDeclaration_WhenCompare_ThenOnlyItsTypeAndLodsAreAffected)
+{
+    std::string newStr = "node|z1-16[amenity=bench] { color: red; }\n"
+                         "way|z10-12[highway] { width: 3m; }\n"
+                         "area|z12[building] { height: 10; }";
+
+    auto diff = compare(StyleStr, newStr);
+
+    BOOST_CHECK_EQUAL(diff.affected.size(), 1);
+    BOOST_CHECK(!diff.isAffected("way", 9));
+    BOOST_CHECK(diff.isAffected("way", 10));
+    BOOST_CHECK(diff.isAffected("way", 12));
+    BOOST_CHECK(!diff.isAffected("way", 13));
+    BOOST_CHECK(!diff.isAffected("node", 10));
+}
+
+BOOST_AUTO_TEST_CASE(GivenChangedZoomRange_WhenCompare_ThenOnlyChangedLodsAreAffected)
+{
+    std::string newStr = "node|z1-18[amenity=bench] { color: red; }\n"
+                         "way|z10-12[highway] { width: 2m; }\n"
+                         "area|z12[building] { height: 10; }";
+
+    auto diff = compare(StyleStr, newStr);
+
+    BOOST_CHECK(!diff.isAffected("node", 16));
+    BOOST_CHECK(diff.isAffected("node", 17));
+    BOOST_CHECK(diff.isAffected("node", 18));
+}
+
+BOOST_AUTO_TEST_CASE(GivenReorderedRules_WhenCompare_ThenSharedLodsAreAffected)
+{
+    std::string oldStr = "area|z12-14[building] { height: 10; }\n"
+                         "area|z14[building=house] { height: 5; }";
+    std::string newStr = "area|z14[building=house] { height: 5; }\n"
+                         "area|z12-14[building] { height: 10; }";
+
+    auto diff = compare(oldStr, newStr);
+
+    BOOST_CHECK(!diff.isAffected("area", 12));
+    BOOST_CHECK(diff.isAffected("area", 14));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,3 +1,4 @@
+#include "CancellationToken.hpp"
 #include "heightmap/FlatElevationProvider.hpp"
 #include "builders/terrain/LineGridSplitter.hpp"
 #include "mapcss/ColorGradient.hpp"
@@ -56,6 +57,27 @@ BOOST_AUTO_TEST_CASE(GivenPolygon_WhenAddPolygon_ThenRefinesCorrectly)
     BOOST_CHECK_EQUAL(mesh.triangles.size() / 3, 34);
 }
 
+BOOST_AUTO_TEST_CASE(GivenCancelledToken_WhenAddPolygon_ThenMeshIsEmpty)
+{
+    utymap::CancellationToken cancelToken;
+    MeshBuilder cancellableBuilder(eleProvider, cancelToken);
+    Mesh mesh("");
+    Polygon polygon(4, 0);
+    polygon.addContour(std::vector<DPoint>
+    {
+        DPoint(0, 0),
+        DPoint(10, 0),
+        DPoint(10, 10),
+        DPoint(0, 10)
+    });
+    cancelToken.cancel();
+
+    cancellableBuilder.addPolygon(mesh, polygon, MeshBuilder::Options(5, 0, 0, 0, colorGradient));
+
+    BOOST_CHECK(mesh.vertices.empty());
+    BOOST_CHECK(mesh.triangles.empty());
+}
+
 BOOST_AUTO_TEST_CASE(GivenPolygonWithHole_WhenAddPolygon_ThenRefinesCorrectly)
 {
     Mesh mesh("");
@@ -3,6 +3,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <cmath>
+
 using namespace utymap;
 using namespace utymap::meshing;
 using namespace utymap::utils;
@@ -39,4 +41,52 @@ BOOST_AUTO_TEST_CASE(GivenRectangle_WhenGetCircle_ThenReturnsCorrectCircle)
     BOOST_CHECK_EQUAL(2, radius);
 }
 
+BOOST_AUTO_TEST_CASE(GivenPolylineWithSmallDeviations_WhenSimplify_ThenOnlySignificantPointsAreKept)
+{
+    std::vector<GeoCoordinate> coordinates =
+    {
+        { 0, 0 }, { 0.01, 1 }, { -0.01, 2 }, { 0, 3 }, { 2, 4 }, { 0, 5 }
+    };
+
+    auto result = simplify(coordinates, 0.1);
+
+    BOOST_CHECK_EQUAL(4, result.size());
+    BOOST_CHECK(result[0] == coordinates[0]);
+    BOOST_CHECK(result[1] == coordinates[3]);
+    BOOST_CHECK(result[2] == coordinates[4]);
+    BOOST_CHECK(result[3] == coordinates[5]);
+}
+
+BOOST_AUTO_TEST_CASE(GivenRingWithSmallDeviations_WhenSimplifyRing_ThenCornersAreKept)
+{
+    std::vector<GeoCoordinate> coordinates =
+    {
+        { 0, 0 }, { 0, 2 }, { 0.01, 4 }, { 4, 4 }, { 4, 2 }, { 4.01, 0 }, { 2, 0.01 }
+    };
+
+    auto result = simplifyRing(coordinates, 0.1);
+
+    BOOST_CHECK_EQUAL(4, result.size());
+}
+
+BOOST_AUTO_TEST_CASE(GivenBowTieRing_WhenHasSelfIntersections_ThenReturnsTrue)
+{
+    BOOST_CHECK(hasSelfIntersections({ { 0, 0 }, { 4, 4 }, { 4, 0 }, { 0, 4 } }));
+    BOOST_CHECK(!hasSelfIntersections({ { 0, 0 }, { 0, 4 }, { 4, 4 }, { 4, 0 } }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenLargeRing_WhenHasSelfIntersections_ThenOnlyCrossedOneReturnsTrue)
+{
+    std::vector<GeoCoordinate> ring;
+    for (int i = 0; i < 10000; ++i) {
+        double angle = 2 * M_PI * i / 10000;
+        ring.push_back(GeoCoordinate(std::sin(angle), std::cos(angle)));
+    }
+    BOOST_CHECK(!hasSelfIntersections(ring));
+
+    std::swap(ring[100], ring[5000]);
+
+    BOOST_CHECK(hasSelfIntersections(ring));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
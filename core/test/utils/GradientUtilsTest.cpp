@@ -58,4 +58,41 @@ BOOST_AUTO_TEST_CASE(GivenColorString_WhenParseGradient_ThenReturnValid)
     BOOST_CHECK_EQUAL(gradient->evaluate(0), 0xEC8859FF);
 }
 
+BOOST_AUTO_TEST_CASE(GivenGradient_WhenEvaluateBetweenStops_ThenLookupIsCloseToInterpolation)
+{
+    auto gradient = GradientUtils::parseGradient("gradient(#000000, #ffffff 30%, #00ff00)");
+
+    Color color = gradient->evaluate(0.15);
+
+    BOOST_CHECK_CLOSE(static_cast<double>(color.r), 127, 1);
+    BOOST_CHECK_GE(static_cast<int>(gradient->evaluate(0.3).g), 254);
+}
+
+BOOST_AUTO_TEST_CASE(GivenPoints_WhenGetColors_ThenColorsAreAppended)
+{
+    auto gradient = GradientUtils::parseGradient("gradient(#0fffff, #099999 50%, #000000)");
+    double points[] = { 0.1, 0.2, 10.5, 20.25, -3, 4 };
+    std::vector<int> colors = { 1 };
+
+    GradientUtils::getColors(*gradient, points, 3, 0.1, colors);
+
+    BOOST_CHECK_EQUAL(colors.size(), 4);
+    BOOST_CHECK_EQUAL(colors[0], 1);
+    for (std::size_t i = 0; i < 3; ++i)
+        BOOST_CHECK_EQUAL(colors[i + 1], static_cast<int>(GradientUtils::getColor(*gradient, points[i * 2], points[i * 2 + 1], 0.1)));
+}
+
+BOOST_AUTO_TEST_CASE(GivenSingleColorGradient_WhenGetColors_ThenAllColorsAreTheSame)
+{
+    auto gradient = GradientUtils::parseGradient("gradient(#0fffff)");
+    double points[] = { 0.1, 0.2, 10.5, 20.25 };
+    std::vector<int> colors;
+
+    GradientUtils::getColors(*gradient, points, 2, 0.1, colors);
+
+    BOOST_CHECK_EQUAL(colors.size(), 2);
+    for (std::size_t i = 0; i < 2; ++i)
+        BOOST_CHECK_EQUAL(colors[i], static_cast<int>(GradientUtils::getColor(*gradient, points[i * 2], points[i * 2 + 1], 0.1)));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -26,7 +26,7 @@ namespace UtyMap.Unity.Maps
             // NOTE actually, it is possible to have multiple in-memory and persistent 
             // storages at the same time.
             registerInMemoryStore(InMemoryStoreKey);
-            registerPersistentStore(PersistentStoreKey, mapDataPath);
+            registerPersistentStore(PersistentStoreKey, mapDataPath, 0);
 
             // NOTE core library can't create directories so far
             for (int i = 1; i <= 16; ++i)
@@ -150,7 +150,7 @@ namespace UtyMap.Unity.Maps
         private static extern void registerInMemoryStore(string key);
 
         [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
-        private static extern void registerPersistentStore(string key, string path);
+        private static extern void registerPersistentStore(string key, string path, int sortBufferSize);
 
         [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
         private static extern void addToStoreInRange(string key, string stylePath, string path, int startLod, int endLod, OnError errorHandler);